@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "blobcrc.hpp"
+
+#include "digest.hpp"
+
+#include <algorithm>
+#include <optional>
+
+namespace blobs
+{
+
+void BlobCrc::insert(uint64_t offset, uint64_t length, uint32_t crc)
+{
+    if (length == 0 || lost)
+    {
+        return;
+    }
+
+    uint64_t end = offset + length;
+
+    /* The first run that reaches offset, which is the one the bytes follow
+     * on from, the one holding the run they retry, or the first past them.
+     */
+    auto it = std::partition_point(
+        runs.begin(), runs.end(),
+        [offset](const Run& run) { return run.end < offset; });
+
+    /* A crc is linear in the bytes, so swapping some for others of the same
+     * length changes the crc by the difference, shifted past the bytes that
+     * follow.
+     */
+    if (it != runs.end() && it->lastOffset == offset &&
+        it->lastLength == length)
+    {
+        it->crc ^= crc32cCombine(it->lastCrc ^ crc, 0, it->end - end);
+        it->lastCrc = crc;
+        return;
+    }
+
+    auto next = it;
+    if (it != runs.end() && it->end == offset)
+    {
+        ++next;
+    }
+    if (next != runs.end() && next->begin < end)
+    {
+        /* Other bytes were written over, and their crc isn't known to be
+         * taken back out.
+         */
+        lost = true;
+        runs.clear();
+        return;
+    }
+
+    if (next != it)
+    {
+        it->crc = crc32cCombine(it->crc, crc, length);
+        it->end = end;
+    }
+    else
+    {
+        it = runs.insert(it, Run{.begin = offset, .end = end, .crc = crc});
+        next = it + 1;
+    }
+    it->lastOffset = offset;
+    it->lastLength = length;
+    it->lastCrc = crc;
+
+    if (next != runs.end() && next->begin == end)
+    {
+        it->crc = crc32cCombine(it->crc, next->crc, next->end - next->begin);
+        it->end = next->end;
+        runs.erase(next);
+    }
+}
+
+std::optional<uint32_t> BlobCrc::crcOf(uint64_t length) const
+{
+    if (lost)
+    {
+        return std::nullopt;
+    }
+    if (length == 0 && runs.empty())
+    {
+        return crc32c({});
+    }
+    if (runs.size() != 1 || runs[0].begin != 0 || runs[0].end != length)
+    {
+        return std::nullopt;
+    }
+    return runs[0].crc;
+}
+
+} // namespace blobs
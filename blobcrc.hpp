@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace blobs
+{
+
+/**
+ * The CRC-32C of a blob, put together from the CRC-32Cs of the runs of bytes
+ * written to it in whatever order they arrive.  Runs that touch are merged as
+ * they arrive, so a blob written in full is one run however it was sent.
+ */
+class BlobCrc
+{
+  public:
+    /**
+     * Add a run of bytes written to the blob.  Writing the same bytes as the
+     * last run added to a range again, as a retry does, replaces its crc.
+     * Any other overlap loses track of the blob's crc.
+     *
+     * @param[in] offset - the first byte.
+     * @param[in] length - the number of bytes, may be zero.
+     * @param[in] crc - the crc32c of the bytes.
+     */
+    void insert(uint64_t offset, uint64_t length, uint32_t crc);
+
+    /**
+     * @param[in] length - the length of the blob.
+     * @return the crc32c of the blob, or nullopt if the runs added aren't
+     *         exactly bytes 0 to length.
+     */
+    std::optional<uint32_t> crcOf(uint64_t length) const;
+
+  private:
+    struct Run
+    {
+        /* Start to end, exclusive. */
+        uint64_t begin;
+        uint64_t end;
+        uint32_t crc;
+        /* The last run of bytes added to this one, so a retry can swap its
+         * crc for the new one.
+         */
+        uint64_t lastOffset = 0;
+        uint64_t lastLength = 0;
+        uint32_t lastCrc = 0;
+    };
+
+    /* Sorted, and neither overlapping nor touching. */
+    std::vector<Run> runs;
+    bool lost = false;
+};
+
+} // namespace blobs
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -21,13 +26,45 @@ enum class BlobOEMCommands : std::uint8_t
     bmcBlobStat = 8,
     bmcBlobSessionStat = 9,
     bmcBlobWriteMeta = 10,
+    bmcBlobGetCaps = 11,
+    bmcBlobBatch = 12,
+    bmcBlobEnumerateRange = 13,
+    bmcBlobEnumerateStat = 14,
+    bmcBlobOpenHandle = 15,
+    bmcBlobStatHandle = 16,
+    bmcBlobDeleteHandle = 17,
+    bmcBlobWriteAppend = 18,
+    bmcBlobWriteWindowed = 19,
+    bmcBlobWriteAck = 20,
+    bmcBlobGetMissing = 21,
+    bmcBlobFill = 22,
+    bmcBlobWriteVectored = 23,
+    bmcBlobRead64 = 24,
+    bmcBlobWrite64 = 25,
+    bmcBlobStat64 = 26,
+    bmcBlobSessionStat64 = 27,
+    bmcBlobDigest = 28,
+    bmcBlobSourceChunks = 29,
 };
 
 enum OpenFlags
 {
     read = (1 << 0),
     write = (1 << 1),
-    /* bits 3-7 reserved. */
+    /* Writes carry an LZ stream, expanded by the manager before the handler
+     * sees them.  Handlers are never passed this flag.
+     */
+    compressedWrite = (1 << 2),
+    /* Read replies carry an LZ stream, compressed by the ipmi layer after
+     * the handler's read.  Handlers are never passed this flag.
+     */
+    compressedRead = (1 << 3),
+    /* Requests and replies on the session skip their crc16, and the blob is
+     * checked against a CRC32C at commit instead.  Handlers are never passed
+     * this flag.
+     */
+    noCrc = (1 << 4),
+    /* bits 5-7 reserved. */
     /* bits 8-15 given blob-specific definitions */
 };
 
@@ -45,14 +82,58 @@ struct BlobMeta
     uint16_t blobState;
     uint32_t size;
     std::vector<uint8_t> metadata;
+    /* The size of a blob past 4GiB, which size can't hold.  It comes last so
+     * that handlers built before it still fill in the fields above, and leave
+     * this one zero.
+     */
+    uint64_t size64 = 0;
+
+    /* The blob's size, from whichever of the two fields the handler set. */
+    uint64_t fullSize() const
+    {
+        return std::max<uint64_t>(size, size64);
+    }
 
     bool operator==(const BlobMeta& rhs) const
     {
         return (this->blobState == rhs.blobState && this->size == rhs.size &&
-                this->metadata == rhs.metadata);
+                this->metadata == rhs.metadata && this->size64 == rhs.size64);
     }
 };
 
+/* Digests a session can be asked for over part of its blob. */
+enum class DigestAlgorithm : std::uint8_t
+{
+    crc32c = 0, /* 4 bytes, little-endian. */
+    sha256 = 1, /* 32 bytes. */
+};
+
+/* One run of bytes in a vectored write. */
+struct WriteSegment
+{
+    uint64_t offset;
+    std::span<const uint8_t> data;
+};
+
+/* Chunks offered by hash are named by their SHA-256. */
+constexpr size_t chunkHashSize = 32;
+
+/* A run of the blob the host offers by hash rather than sending. */
+struct ChunkHash
+{
+    uint64_t offset;
+    uint32_t length;
+    std::span<const uint8_t, chunkHashSize> hash;
+};
+
+/* The most bytes the default fill() passes to writeBytes64() at once. */
+constexpr uint32_t fillChunkSize = 4096;
+
+/* The most bytes one fill() covers, so a single request can't hold ipmid
+ * while the handler writes terabytes.
+ */
+constexpr uint64_t maxFillLength = 1024 * 1024;
+
 /*
  * All blob specific objects implement this interface.
  */
@@ -173,6 +254,230 @@ class GenericBlobInterface
      * @return bool - whether the session was able to be closed.
      */
     virtual bool expire(uint16_t session) = 0;
+
+    /* The methods below were added later and have defaults.  Adding them
+     * changed the class, so handler modules must be rebuilt against this
+     * header.
+     */
+
+    /**
+     * Return metadata about several blobs in one call.  The default stats
+     * each path in turn; a handler that can answer them together should
+     * override it.
+     *
+     * @param[in] paths - the blobIds for metadata.
+     * @param[out] metas - one entry per path, empty where stat failed.
+     */
+    virtual void statBlobs(std::span<const std::string> paths,
+                           std::span<std::optional<BlobMeta>> metas)
+    {
+        for (size_t i = 0; i < paths.size() && i < metas.size(); ++i)
+        {
+            BlobMeta meta{};
+            if (stat(paths[i], &meta))
+            {
+                metas[i] = std::move(meta);
+            }
+            else
+            {
+                metas[i].reset();
+            }
+        }
+    }
+
+    /**
+     * Attempt to read from a blob at an offset that may be past 4GiB.
+     *
+     * The blob manager calls this rather than read().  The default calls
+     * read() for offsets that fit in 32 bits and reads nothing past them; a
+     * handler for blobs that large should override it.
+     *
+     * @param[in] session - the session id.
+     * @param[in] offset - offset into the blob.
+     * @param[in] requestedSize - number of bytes to read.
+     * @return Bytes read back (0 length on error).
+     */
+    virtual std::vector<uint8_t> read64(uint16_t session, uint64_t offset,
+                                        uint32_t requestedSize)
+    {
+        if (offset > std::numeric_limits<uint32_t>::max())
+        {
+            return {};
+        }
+        return read(session, static_cast<uint32_t>(offset), requestedSize);
+    }
+
+    /**
+     * Attempt to write to a blob straight from the request buffer.  The bytes
+     * are only valid for the duration of the call.
+     *
+     * The blob manager calls this, through writeBytes64(), rather than
+     * write().  The default copies the bytes into a vector and calls
+     * write(); a handler with its own storage can override it to copy the
+     * bytes in once.
+     *
+     * @param[in] session - the session id.
+     * @param[in] offset - offset into the blob.
+     * @param[in] data - the data to write.
+     * @return bool - was able to write.
+     */
+    virtual bool writeBytes(uint16_t session, uint32_t offset,
+                            std::span<const uint8_t> data)
+    {
+        return write(session, offset,
+                     std::vector<uint8_t>(data.begin(), data.end()));
+    }
+
+    /**
+     * Attempt to write to a blob straight from the request buffer, at an
+     * offset that may be past 4GiB.
+     *
+     * The blob manager calls this rather than writeBytes().  The default
+     * calls writeBytes() for offsets that fit in 32 bits and fails past
+     * them; a handler for blobs that large should override it.
+     *
+     * @param[in] session - the session id.
+     * @param[in] offset - offset into the blob.
+     * @param[in] data - the data to write.
+     * @return bool - was able to write.
+     */
+    virtual bool writeBytes64(uint16_t session, uint64_t offset,
+                              std::span<const uint8_t> data)
+    {
+        if (offset > std::numeric_limits<uint32_t>::max())
+        {
+            return false;
+        }
+        return writeBytes(session, static_cast<uint32_t>(offset), data);
+    }
+
+    /**
+     * Attempt to write metadata to a blob straight from the request buffer.
+     * As with writeBytes(), the default copies into a vector and calls
+     * writeMeta().
+     *
+     * @param[in] session - the session id.
+     * @param[in] offset - offset into the blob.
+     * @param[in] data - the data to write.
+     * @return bool - was able to write.
+     */
+    virtual bool writeMetaBytes(uint16_t session, uint32_t offset,
+                                std::span<const uint8_t> data)
+    {
+        return writeMeta(session, offset,
+                         std::vector<uint8_t>(data.begin(), data.end()));
+    }
+
+    /**
+     * Attempt to write several runs of bytes in one call, straight from the
+     * request buffer.  The bytes are only valid for the duration of the call.
+     *
+     * The default writes each segment in order with writeBytes64() and
+     * stops at the first that fails; a handler that can apply them together
+     * should override it.
+     *
+     * @param[in] session - the session id.
+     * @param[in] segments - the offsets and bytes to write.
+     * @return bool - was able to write every segment.
+     */
+    virtual bool writeVectored(uint16_t session,
+                               std::span<const WriteSegment> segments)
+    {
+        for (const WriteSegment& segment : segments)
+        {
+            if (!writeBytes64(session, segment.offset, segment.data))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Attempt to write the same byte over a span of the blob, such as the
+     * padding in a flash image.
+     *
+     * The default writes the pattern through writeBytes64() in chunks of
+     * fillChunkSize; a handler that can fill its storage directly should
+     * override it.  Neither the default nor the manager takes a length past
+     * maxFillLength.
+     *
+     * @param[in] session - the session id.
+     * @param[in] offset - offset into the blob.
+     * @param[in] length - the number of bytes to write.
+     * @param[in] pattern - the byte to write.
+     * @return bool - was able to write.
+     */
+    virtual bool fill(uint16_t session, uint64_t offset, uint64_t length,
+                      uint8_t pattern)
+    {
+        if (length > maxFillLength ||
+            length > std::numeric_limits<uint64_t>::max() - offset)
+        {
+            return false;
+        }
+
+        std::array<uint8_t, fillChunkSize> chunk;
+        chunk.fill(pattern);
+        while (length > 0)
+        {
+            uint32_t count = static_cast<uint32_t>(
+                std::min<uint64_t>(length, fillChunkSize));
+            if (!writeBytes64(session, offset, std::span(chunk).first(count)))
+            {
+                return false;
+            }
+            offset += count;
+            length -= count;
+        }
+        return true;
+    }
+
+    /**
+     * Return a digest of part of the session's view of the blob, for a
+     * handler that can produce one without reading the bytes back, say from
+     * a hash it keeps as the blob is written.
+     *
+     * The default returns nullopt, and the blob manager then computes the
+     * digest from read64().
+     *
+     * @param[in] session - the session id.
+     * @param[in] algorithm - the digest to compute.
+     * @param[in] offset - offset into the blob.
+     * @param[in] length - the number of bytes to cover.
+     * @return the digest, or nullopt to have the blob manager compute it.
+     */
+    virtual std::optional<std::vector<uint8_t>> digest(
+        [[maybe_unused]] uint16_t session,
+        [[maybe_unused]] DigestAlgorithm algorithm,
+        [[maybe_unused]] uint64_t offset, [[maybe_unused]] uint64_t length)
+    {
+        return std::nullopt;
+    }
+
+    /**
+     * Attempt to write a run of the blob from bytes the handler already
+     * holds, such as the image staged or installed before this one, so the
+     * host needn't send them.  A handler should only return true once it
+     * has written bytes whose SHA-256 is the given hash.
+     *
+     * The default returns false, and the host then writes the run itself.
+     *
+     * @param[in] session - the session id.
+     * @param[in] offset - offset into the blob.
+     * @param[in] length - the number of bytes in the run.
+     * @param[in] hash - the SHA-256 of the run's bytes.
+     * @return bool - was able to write the run from local bytes.
+     */
+    virtual bool sourceChunk([[maybe_unused]] uint16_t session,
+                             [[maybe_unused]] uint64_t offset,
+                             [[maybe_unused]] uint32_t length,
+                             [[maybe_unused]] std::span<const uint8_t,
+                                                        chunkHashSize>
+                                 hash)
+    {
+        return false;
+    }
 };
 } // namespace blobs
 
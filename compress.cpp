@@ -0,0 +1,230 @@
+/*
+ * Copyright 2026 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compress.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace blobs
+{
+
+namespace
+{
+
+constexpr size_t minMatch = 3;
+constexpr size_t maxLiteralRun = 128;
+
+uint32_t hash3(const uint8_t* p)
+{
+    uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+    return (v * 2654435761u) >> (32 - lzHashBits);
+}
+
+} // namespace
+
+bool LzDecoder::decode(std::span<const uint8_t> data,
+                       std::vector<uint8_t>& out)
+{
+    if (failed)
+    {
+        return false;
+    }
+
+    size_t i = 0;
+    while (i < data.size())
+    {
+        switch (state)
+        {
+            case State::control:
+            {
+                uint8_t control = data[i++];
+                if (control < 0x80)
+                {
+                    remaining = control + 1;
+                    state = State::literal;
+                }
+                else
+                {
+                    remaining = (control & 0x7f) + minMatch;
+                    state = State::distanceLow;
+                }
+                break;
+            }
+            case State::literal:
+            {
+                size_t count = std::min(remaining, data.size() - i);
+                for (size_t j = 0; j < count; ++j)
+                {
+                    emit(data[i + j], out);
+                }
+                i += count;
+                remaining -= count;
+                if (remaining == 0)
+                {
+                    state = State::control;
+                }
+                break;
+            }
+            case State::distanceLow:
+                distance = data[i++];
+                state = State::distanceHigh;
+                break;
+            case State::distanceHigh:
+            {
+                distance |= data[i++] << 8;
+                distance++;
+                if (distance > lzWindowSize || distance > position)
+                {
+                    failed = true;
+                    return false;
+                }
+
+                /* A match may overlap the bytes it produces, so copy one at
+                 * a time.
+                 */
+                for (; remaining > 0; --remaining)
+                {
+                    emit(history[(position - distance) % lzWindowSize], out);
+                }
+                state = State::control;
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* Literal runs are cut short to whatever still fits, so the stream always
+ * ends on a token boundary.
+ */
+bool LzEncoder::flushLiterals(std::span<const uint8_t> data, size_t end)
+{
+    while (literalStart < end)
+    {
+        if (out.size() - used < 2)
+        {
+            return false;
+        }
+        size_t count = std::min(
+            {end - literalStart, maxLiteralRun, out.size() - used - 1});
+        out[used++] = static_cast<uint8_t>(count - 1);
+        std::copy_n(data.begin() + literalStart, count, out.begin() + used);
+        used += count;
+        literalStart += count;
+    }
+    return true;
+}
+
+/* Positions too near the end of the data to hash yet are left for the next
+ * encode() to add.
+ */
+void LzEncoder::remember(std::span<const uint8_t> data, size_t end)
+{
+    for (; hashed < end && hashed + minMatch <= data.size(); ++hashed)
+    {
+        head[hash3(&data[hashed])] = hashed + 1;
+    }
+}
+
+size_t LzEncoder::encode(std::span<const uint8_t> data)
+{
+    if (full)
+    {
+        return literalStart;
+    }
+
+    /* The last call sent its tail as literals, so the search picks up after
+     * them, with every position before there hashed.
+     */
+    position = std::max(position, literalStart);
+    remember(data, position);
+
+    size_t i = position;
+    while (i + minMatch <= data.size())
+    {
+        uint32_t h = hash3(&data[i]);
+        size_t candidate = head[h];
+        head[h] = i + 1;
+        hashed = i + 1;
+
+        if (candidate == 0 || i - (candidate - 1) > lzWindowSize)
+        {
+            i++;
+            continue;
+        }
+        candidate--;
+
+        size_t length = 0;
+        size_t limit = std::min(lzMaxMatch, data.size() - i);
+        while (length < limit && data[candidate + length] == data[i + length])
+        {
+            length++;
+        }
+        /* A shortest match costs as much as the bytes it covers, so it only
+         * pays when it doesn't also split a literal run.  That keeps the
+         * stream within the bound lzCompress() promises.
+         */
+        if (length < minMatch || (length == minMatch && literalStart < i))
+        {
+            i++;
+            continue;
+        }
+
+        if (!flushLiterals(data, i) || out.size() - used < 3)
+        {
+            full = true;
+            return literalStart;
+        }
+        size_t field = i - candidate - 1;
+        out[used++] = static_cast<uint8_t>(0x80 | (length - minMatch));
+        out[used++] = static_cast<uint8_t>(field & 0xff);
+        out[used++] = static_cast<uint8_t>(field >> 8);
+
+        /* Remember the positions the match covers so later data can refer
+         * back into it.
+         */
+        i += length;
+        remember(data, i);
+        literalStart = i;
+    }
+    position = i;
+
+    full = !flushLiterals(data, data.size());
+    return literalStart;
+}
+
+size_t lzCompressInto(std::span<const uint8_t> data, std::span<uint8_t> out,
+                      size_t* written)
+{
+    LzEncoder encoder(out);
+    size_t length = encoder.encode(data);
+    *written = encoder.written();
+    return length;
+}
+
+std::vector<uint8_t> lzCompress(std::span<const uint8_t> data)
+{
+    std::vector<uint8_t> out(data.size() + data.size() / maxLiteralRun + 1);
+    size_t written = 0;
+    lzCompressInto(data, out, &written);
+    out.resize(written);
+    return out;
+}
+
+} // namespace blobs
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace blobs
+{
+
+/* How far back a match may reach. */
+constexpr size_t lzWindowSize = 4096;
+
+/* The longest match one token can carry. */
+constexpr size_t lzMaxMatch = 130;
+
+/**
+ * Decodes the blob protocol's LZ stream, which is a run of tokens, each led
+ * by a control byte:
+ *
+ *   0x00-0x7f: a run of (control + 1) literal bytes follows.
+ *   0x80-0xff: a match of ((control & 0x7f) + 3) bytes, copied from the
+ *              distance given by the little-endian uint16 that follows,
+ *              plus one.
+ *
+ * The stream may be split anywhere, including inside a token, and the
+ * history carries over from one decode() to the next.
+ */
+class LzDecoder
+{
+  public:
+    /**
+     * Decode the next part of the stream, appending what it expands to.
+     *
+     * @param[in] data - the next bytes of the stream.
+     * @param[in,out] out - the decoded bytes are appended here.
+     * @return bool - false if the stream is malformed.  The decoder then
+     *         refuses everything after it.
+     */
+    bool decode(std::span<const uint8_t> data, std::vector<uint8_t>& out);
+
+    /**
+     * Refuse everything after this point, for when the caller couldn't use
+     * what was decoded and the stream can't be resumed.
+     */
+    void abandon()
+    {
+        failed = true;
+    }
+
+  private:
+    enum class State
+    {
+        control,
+        literal,
+        distanceLow,
+        distanceHigh,
+    };
+
+    void emit(uint8_t byte, std::vector<uint8_t>& out)
+    {
+        out.push_back(byte);
+        history[position % lzWindowSize] = byte;
+        position++;
+    }
+
+    State state = State::control;
+    /* Bytes left in the literal run or match being decoded. */
+    size_t remaining = 0;
+    size_t distance = 0;
+    /* How many bytes have been decoded. */
+    size_t position = 0;
+    bool failed = false;
+    std::array<uint8_t, lzWindowSize> history{};
+};
+
+/* The encoder's hash table has 1 << lzHashBits entries. */
+constexpr size_t lzHashBits = 12;
+
+/**
+ * Encodes a stream LzDecoder expands back to the input, into a fixed buffer.
+ * The input may be given a part at a time, and each encode() only looks at
+ * the bytes added since the last, while matches still reach back into the
+ * earlier ones.
+ */
+class LzEncoder
+{
+  public:
+    explicit LzEncoder(std::span<uint8_t> out) : out(out) {}
+
+    /**
+     * Encode the bytes of data past those given before, or as much of them
+     * as still fits.
+     *
+     * @param[in] data - everything given so far, starting with the bytes
+     *            passed to every earlier call.
+     * @return the number of bytes of data the stream covers.
+     */
+    size_t encode(std::span<const uint8_t> data);
+
+    /* The length of the stream so far. */
+    size_t written() const
+    {
+        return used;
+    }
+
+  private:
+    bool flushLiterals(std::span<const uint8_t> data, size_t end);
+    void remember(std::span<const uint8_t> data, size_t end);
+
+    std::span<uint8_t> out;
+    size_t used = 0;
+    /* Where the bytes not yet in the stream start. */
+    size_t literalStart = 0;
+    /* Where the search for the next match resumes. */
+    size_t position = 0;
+    /* How many positions are in the hash table. */
+    size_t hashed = 0;
+    bool full = false;
+    /* The last position each 3-byte hash was seen at, plus one. */
+    std::array<uint32_t, 1 << lzHashBits> head{};
+};
+
+/**
+ * Encode data as one LZ stream that LzDecoder expands back to it.
+ *
+ * @param[in] data - the bytes to encode.
+ * @return the stream, at most data.size() / 128 + 1 bytes larger.
+ */
+std::vector<uint8_t> lzCompress(std::span<const uint8_t> data);
+
+/**
+ * Encode as much of data as fits in out, as a stream LzDecoder expands back
+ * to the bytes encoded.
+ *
+ * @param[in] data - the bytes to encode.
+ * @param[out] out - where the stream is written.
+ * @param[out] written - the length of the stream.
+ * @return the number of bytes of data the stream covers.
+ */
+size_t lzCompressInto(std::span<const uint8_t> data, std::span<uint8_t> out,
+                      size_t* written);
+
+} // namespace blobs
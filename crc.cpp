@@ -0,0 +1,340 @@
+/*
+ * Copyright 2026 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "crc.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BLOBS_CRC_PCLMUL 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#define BLOBS_CRC_PMULL 1
+#endif
+
+namespace blobs
+{
+
+namespace
+{
+
+constexpr uint16_t crcPoly = 0x1021;
+
+/* ipmiblob seeds the register with 0xffff and then shifts two zero bytes
+ * through it after the data (the "augmented" form).  Running the seed through
+ * those 16 bits up front yields the seed for the equivalent direct form.
+ */
+constexpr uint16_t directSeed(uint16_t augmentedSeed)
+{
+    uint16_t crc = augmentedSeed;
+    for (int i = 0; i < 16; ++i)
+    {
+        crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ crcPoly)
+                             : static_cast<uint16_t>(crc << 1);
+    }
+    return crc;
+}
+
+constexpr uint16_t crcSeed = directSeed(0xffff);
+static_assert(crcSeed == 0x1d0f);
+
+using CrcTable = std::array<uint16_t, 256>;
+
+constexpr CrcTable makeCrcTable()
+{
+    CrcTable table{};
+    for (unsigned int i = 0; i < table.size(); ++i)
+    {
+        uint16_t crc = static_cast<uint16_t>(i << 8);
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ crcPoly)
+                                 : static_cast<uint16_t>(crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+/* sliceTables[k][v] is the remainder of v shifted k further bytes along, so
+ * eight table lookups retire eight input bytes at once.
+ */
+constexpr std::array<CrcTable, 8> makeSliceTables()
+{
+    std::array<CrcTable, 8> tables{};
+    tables[0] = makeCrcTable();
+    for (size_t k = 1; k < tables.size(); ++k)
+    {
+        for (size_t v = 0; v < tables[k].size(); ++v)
+        {
+            uint16_t prev = tables[k - 1][v];
+            tables[k][v] =
+                static_cast<uint16_t>(prev << 8) ^ tables[0][prev >> 8];
+        }
+    }
+    return tables;
+}
+
+constexpr std::array<CrcTable, 8> sliceTables = makeSliceTables();
+constexpr const CrcTable& crcTable = sliceTables[0];
+
+uint16_t updateBytewise(uint16_t crc, std::span<const uint8_t> data)
+{
+    for (uint8_t byte : data)
+    {
+        crc = static_cast<uint16_t>(crc << 8) ^ crcTable[(crc >> 8) ^ byte];
+    }
+    return crc;
+}
+
+uint16_t updateSliceBy8(uint16_t crc, std::span<const uint8_t> data)
+{
+    const uint8_t* p = data.data();
+    size_t remaining = data.size();
+
+    while (remaining >= 8)
+    {
+        crc = sliceTables[7][p[0] ^ (crc >> 8)] ^
+              sliceTables[6][p[1] ^ (crc & 0xff)] ^ sliceTables[5][p[2]] ^
+              sliceTables[4][p[3]] ^ sliceTables[3][p[4]] ^
+              sliceTables[2][p[5]] ^ sliceTables[1][p[6]] ^
+              sliceTables[0][p[7]];
+        p += 8;
+        remaining -= 8;
+    }
+
+    return updateBytewise(crc, {p, remaining});
+}
+
+uint16_t crcBytewise(std::span<const uint8_t> data)
+{
+    return updateBytewise(crcSeed, data);
+}
+
+uint16_t crcSliceBy8(std::span<const uint8_t> data)
+{
+    return updateSliceBy8(crcSeed, data);
+}
+
+#if defined(BLOBS_CRC_PCLMUL) || defined(BLOBS_CRC_PMULL)
+/* The carry-less kernels treat each 16-byte block as a polynomial and fold
+ * the running state forward by 128 bits per block:
+ *
+ *   state' = state.hi * (x^192 mod P) + state.lo * (x^128 mod P) + block
+ *
+ * which stays congruent to the message so far.  The seed is folded into the
+ * first two bytes, and the final 128-bit state plus any tail is reduced with
+ * the byte table.
+ */
+constexpr uint64_t xPowMod(unsigned int n)
+{
+    uint32_t r = 1;
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        r <<= 1;
+        if (r & 0x10000)
+        {
+            r ^= 0x10000 | crcPoly;
+        }
+    }
+    return r;
+}
+
+constexpr uint64_t foldLo = xPowMod(128);
+constexpr uint64_t foldHi = xPowMod(192);
+constexpr size_t foldBlock = 16;
+
+/* Short buffers are cheaper through the tables than setting up a fold. */
+constexpr size_t foldMinimum = 2 * foldBlock;
+
+uint16_t reduceFolded(const uint8_t (&state)[foldBlock],
+                      std::span<const uint8_t> tail)
+{
+    return updateSliceBy8(updateSliceBy8(0, state), tail);
+}
+#endif
+
+#if defined(BLOBS_CRC_PCLMUL)
+__attribute__((target("pclmul,ssse3"))) uint16_t crcPclmul(
+    std::span<const uint8_t> data)
+{
+    if (data.size() < foldMinimum)
+    {
+        return crcSliceBy8(data);
+    }
+
+    /* Blocks are consumed most significant byte first. */
+    const __m128i reverse =
+        _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i constants = _mm_set_epi64x(foldHi, foldLo);
+
+    const uint8_t* p = data.data();
+    size_t remaining = data.size();
+
+    const __m128i seed = _mm_set_epi64x(uint64_t{crcSeed} << 48, 0);
+
+    __m128i state = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), reverse);
+    state = _mm_xor_si128(state, seed);
+    p += foldBlock;
+    remaining -= foldBlock;
+
+    while (remaining >= foldBlock)
+    {
+        __m128i block = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), reverse);
+        state = _mm_xor_si128(
+            _mm_xor_si128(_mm_clmulepi64_si128(state, constants, 0x11),
+                          _mm_clmulepi64_si128(state, constants, 0x00)),
+            block);
+        p += foldBlock;
+        remaining -= foldBlock;
+    }
+
+    uint8_t folded[foldBlock];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(folded),
+                     _mm_shuffle_epi8(state, reverse));
+    return reduceFolded(folded, {p, remaining});
+}
+
+bool havePclmul()
+{
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+}
+#endif
+
+#if defined(BLOBS_CRC_PMULL)
+#if defined(__clang__)
+#define BLOBS_CRC_PMULL_TARGET __attribute__((target("aes")))
+#else
+#define BLOBS_CRC_PMULL_TARGET __attribute__((target("+crypto")))
+#endif
+
+BLOBS_CRC_PMULL_TARGET uint8x16_t reverseBytes(uint8x16_t v)
+{
+    v = vrev64q_u8(v);
+    return vextq_u8(v, v, 8);
+}
+
+BLOBS_CRC_PMULL_TARGET uint16_t crcPmull(std::span<const uint8_t> data)
+{
+    if (data.size() < foldMinimum)
+    {
+        return crcSliceBy8(data);
+    }
+
+    const uint8_t* p = data.data();
+    size_t remaining = data.size();
+
+    const uint64x2_t seed =
+        vcombine_u64(vcreate_u64(0), vcreate_u64(uint64_t{crcSeed} << 48));
+
+    uint64x2_t state = vreinterpretq_u64_u8(reverseBytes(vld1q_u8(p)));
+    state = veorq_u64(state, seed);
+    p += foldBlock;
+    remaining -= foldBlock;
+
+    while (remaining >= foldBlock)
+    {
+        uint64x2_t block = vreinterpretq_u64_u8(reverseBytes(vld1q_u8(p)));
+        uint64x2_t hi = vreinterpretq_u64_p128(
+            vmull_p64(vgetq_lane_u64(state, 1), foldHi));
+        uint64x2_t lo = vreinterpretq_u64_p128(
+            vmull_p64(vgetq_lane_u64(state, 0), foldLo));
+        state = veorq_u64(veorq_u64(hi, lo), block);
+        p += foldBlock;
+        remaining -= foldBlock;
+    }
+
+    uint8_t folded[foldBlock];
+    vst1q_u8(folded, reverseBytes(vreinterpretq_u8_u64(state)));
+    return reduceFolded(folded, {p, remaining});
+}
+
+bool havePmull()
+{
+    return getauxval(AT_HWCAP) & HWCAP_PMULL;
+}
+#endif
+
+std::vector<CrcKernel> detectCrcKernels()
+{
+    std::vector<CrcKernel> kernels = {
+        {"bytewise", crcBytewise},
+        {"slice-by-8", crcSliceBy8},
+    };
+
+#if defined(BLOBS_CRC_PCLMUL)
+    if (havePclmul())
+    {
+        kernels.push_back({"pclmul", crcPclmul});
+    }
+#endif
+#if defined(BLOBS_CRC_PMULL)
+    if (havePmull())
+    {
+        kernels.push_back({"pmull", crcPmull});
+    }
+#endif
+
+    return kernels;
+}
+
+} // namespace
+
+std::span<const CrcKernel> getCrcKernels()
+{
+    static const std::vector<CrcKernel> kernels = detectCrcKernels();
+    return kernels;
+}
+
+uint16_t generateCrc(std::span<const uint8_t> data)
+{
+    static const auto generate = getCrcKernels().back().generate;
+    return generate(data);
+}
+
+bool verifyCrc(std::span<const uint8_t> body)
+{
+    if (body.size() < sizeof(uint16_t))
+    {
+        return false;
+    }
+
+    uint16_t crc = static_cast<uint16_t>(body[0] | (body[1] << 8));
+    return crc == generateCrc(body.subspan(sizeof(uint16_t)));
+}
+
+bool stampCrc(std::span<uint8_t> body)
+{
+    if (body.size() < sizeof(uint16_t))
+    {
+        return false;
+    }
+
+    uint16_t crc = generateCrc(body.subspan(sizeof(uint16_t)));
+    body[0] = static_cast<uint8_t>(crc & 0xff);
+    body[1] = static_cast<uint8_t>(crc >> 8);
+    return true;
+}
+
+} // namespace blobs
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace blobs
+{
+
+/**
+ * One implementation of the blob protocol CRC.  Every kernel produces the
+ * same result as generateCrc; they only differ in speed.
+ */
+struct CrcKernel
+{
+    const char* name;
+    uint16_t (*generate)(std::span<const uint8_t> data);
+};
+
+/**
+ * List the CRC kernels that can run on this CPU, ordered from the portable
+ * reference implementation to the fastest.  generateCrc dispatches to the
+ * last entry, chosen once on first use.
+ *
+ * @return the usable kernels, never empty.
+ */
+std::span<const CrcKernel> getCrcKernels();
+
+/**
+ * Compute the CRC-16-CCITT (poly 0x1021) used throughout the blob protocol.
+ *
+ * The result is bit-for-bit identical to ipmiblob::generateCrc, but works on
+ * a view of the caller's buffer so no copy is needed.
+ *
+ * @param[in] data - the bytes to checksum.
+ * @return the crc16 over data.
+ */
+uint16_t generateCrc(std::span<const uint8_t> data);
+
+/**
+ * Verify a body that leads with a little-endian crc16 over the bytes that
+ * follow it.
+ *
+ * @param[in] body - the crc followed by the bytes it covers.
+ * @return bool - true if the body holds a crc and it matches.
+ */
+bool verifyCrc(std::span<const uint8_t> body);
+
+/**
+ * Compute the crc16 over everything after the leading two bytes of body and
+ * store it, little-endian, in those two bytes.
+ *
+ * @param[in,out] body - the reply, with the first two bytes reserved.
+ * @return bool - false if the body is too short to hold a crc.
+ */
+bool stampCrc(std::span<uint8_t> body);
+
+} // namespace blobs
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2026 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "digest.hpp"
+
+#include <array>
+#include <span>
+
+namespace blobs
+{
+
+namespace
+{
+
+constexpr std::array<uint32_t, 256> crc32cTable = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < table.size(); ++i)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0x82f63b78 : 0);
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+/* Multiply two polynomials modulo the CRC-32C polynomial, both reflected as
+ * crc32cTable is.  a must not be zero.
+ */
+constexpr uint32_t crc32cMultiply(uint32_t a, uint32_t b)
+{
+    uint32_t product = 0;
+    for (uint32_t bit = 1u << 31;; bit >>= 1)
+    {
+        if (a & bit)
+        {
+            product ^= b;
+            if ((a & (bit - 1)) == 0)
+            {
+                return product;
+            }
+        }
+        b = (b >> 1) ^ ((b & 1) ? 0x82f63b78 : 0);
+    }
+}
+
+/* Entry k is x^(2^k) modulo the CRC-32C polynomial, for every bit of a
+ * 64-bit byte count times eight.
+ */
+constexpr std::array<uint32_t, 67> crc32cPowers = [] {
+    std::array<uint32_t, 67> powers{};
+    uint32_t power = 1u << 30;
+    for (uint32_t& entry : powers)
+    {
+        entry = power;
+        power = crc32cMultiply(power, power);
+    }
+    return powers;
+}();
+
+} // namespace
+
+uint32_t crc32c(std::span<const uint8_t> data, uint32_t crc)
+{
+    crc = ~crc;
+    for (uint8_t byte : data)
+    {
+        crc = crc32cTable[(crc ^ byte) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t crc32cCombine(uint32_t first, uint32_t second, uint64_t secondLength)
+{
+    /* Appending n bytes multiplies the first crc by x^(8n), so build that
+     * from the powers for each set bit of 8n.
+     */
+    uint32_t shift = 1u << 31;
+    for (size_t k = 3; secondLength > 0; secondLength >>= 1, ++k)
+    {
+        if (secondLength & 1)
+        {
+            shift = crc32cMultiply(crc32cPowers[k], shift);
+        }
+    }
+    return crc32cMultiply(shift, first) ^ second;
+}
+
+uint32_t crc32cRepeat(uint8_t byte, uint64_t count)
+{
+    /* Double a run of the byte, and append it wherever count has a bit. */
+    uint32_t result = 0;
+    uint32_t run = crc32c(std::span(&byte, 1));
+    for (uint64_t runLength = 1; count > 0; count >>= 1, runLength <<= 1)
+    {
+        if (count & 1)
+        {
+            result = crc32cCombine(result, run, runLength);
+        }
+        if (count > 1)
+        {
+            run = crc32cCombine(run, run, runLength);
+        }
+    }
+    return result;
+}
+
+} // namespace blobs
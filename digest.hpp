@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace blobs
+{
+
+/**
+ * Compute the CRC-32C (Castagnoli, reflected poly 0x82f63b78).  Passing the
+ * result back in as crc continues it, so a stream can be checked in pieces.
+ *
+ * @param[in] data - the bytes to checksum.
+ * @param[in] crc - the crc of the bytes before data, zero to start.
+ * @return the crc32c over everything so far.
+ */
+uint32_t crc32c(std::span<const uint8_t> data, uint32_t crc = 0);
+
+/**
+ * Combine the CRC-32Cs of two runs of bytes into that of the first followed
+ * by the second, without the bytes themselves.
+ *
+ * @param[in] first - the crc32c of the first run.
+ * @param[in] second - the crc32c of the second run.
+ * @param[in] secondLength - the number of bytes in the second run.
+ * @return the crc32c of both runs together.
+ */
+uint32_t crc32cCombine(uint32_t first, uint32_t second, uint64_t secondLength);
+
+/**
+ * Compute the CRC-32C of one byte repeated, in time logarithmic in the count.
+ *
+ * @param[in] byte - the byte.
+ * @param[in] count - the number of times it repeats.
+ * @return the crc32c of the repeated byte.
+ */
+uint32_t crc32cRepeat(uint8_t byte, uint64_t count);
+
+} // namespace blobs
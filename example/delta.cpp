@@ -0,0 +1,564 @@
+#include "example/delta.hpp"
+
+#include <phosphor-logging/log.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace blobs
+{
+
+using namespace phosphor::logging;
+
+constexpr char DeltaBlobHandler::deltaBlobPrefix[];
+
+namespace
+{
+
+/* Read a little-endian field from a header and move past it.  The header
+ * is whole, so the field is always there.
+ */
+template <typename T>
+T take(std::span<const uint8_t> header, size_t* cursor)
+{
+    static_assert(std::is_unsigned_v<T>);
+    T result = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        result |= static_cast<T>(header[*cursor + i]) << (8 * i);
+    }
+    *cursor += sizeof(T);
+    return result;
+}
+
+/* The size of the header the session is reading, given its first byte, or
+ * zero if that isn't an operation.
+ */
+size_t stageSize(const DeltaBlob& sess, uint8_t first)
+{
+    if (!sess.headerRead)
+    {
+        return deltaHeaderSize;
+    }
+    switch (static_cast<DeltaOp>(first))
+    {
+        case DeltaOp::copy:
+            return deltaCopySize;
+        case DeltaOp::insert:
+            return deltaInsertSize;
+    }
+    return 0;
+}
+
+std::string partialPath(const DeltaImage& image)
+{
+    return image.targetPath + ".partial";
+}
+
+using Sha256 = std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)>;
+
+/* A new SHA-256, or null if OpenSSL couldn't set one up. */
+Sha256 startSha256()
+{
+    Sha256 sha(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    if (sha && !EVP_DigestInit_ex(sha.get(), EVP_sha256(), nullptr))
+    {
+        sha.reset();
+    }
+    return sha;
+}
+
+/* Hash the next length bytes of a file, which must all be there. */
+bool hashFile(std::istream& file, uint64_t length, EVP_MD_CTX* sha)
+{
+    std::vector<char> buffer(std::min<uint64_t>(length, deltaApplyStep));
+    while (length > 0)
+    {
+        size_t count = std::min<uint64_t>(length, buffer.size());
+        if (!file.read(buffer.data(), count) ||
+            !EVP_DigestUpdate(sha, buffer.data(), count))
+        {
+            return false;
+        }
+        length -= count;
+    }
+    return true;
+}
+
+bool shaMatches(EVP_MD_CTX* sha,
+                const std::array<uint8_t, deltaShaSize>& expected)
+{
+    std::array<uint8_t, EVP_MAX_MD_SIZE> digest{};
+    unsigned int size = 0;
+    return EVP_DigestFinal_ex(sha, digest.data(), &size) &&
+           size == expected.size() &&
+           std::equal(expected.begin(), expected.end(), digest.begin());
+}
+
+} // namespace
+
+DeltaBlob* DeltaBlobHandler::getSession(uint16_t id)
+{
+    auto search = sessions.find(id);
+    if (search == sessions.end())
+    {
+        return nullptr;
+    }
+    return &search->second;
+}
+
+const DeltaImage* DeltaBlobHandler::findImage(const std::string& path) const
+{
+    for (const DeltaImage& image : images)
+    {
+        if (path == deltaBlobPrefix + image.name)
+        {
+            return &image;
+        }
+    }
+    return nullptr;
+}
+
+bool DeltaBlobHandler::canHandleBlob(const std::string& path)
+{
+    return findImage(path) != nullptr;
+}
+
+std::vector<std::string> DeltaBlobHandler::getBlobIds()
+{
+    std::vector<std::string> ids;
+    for (const DeltaImage& image : images)
+    {
+        ids.push_back(deltaBlobPrefix + image.name);
+    }
+    return ids;
+}
+
+bool DeltaBlobHandler::deleteBlob(const std::string&)
+{
+    return false;
+}
+
+bool DeltaBlobHandler::stat(const std::string&, BlobMeta*)
+{
+    return false;
+}
+
+bool DeltaBlobHandler::open(uint16_t session, uint16_t flags,
+                            const std::string& path)
+{
+    const DeltaImage* image = findImage(path);
+    if (!image || !(flags & OpenFlags::write))
+    {
+        return false;
+    }
+
+    /* Two patches can't be applied to one target at once. */
+    for (const auto& [id, sess] : sessions)
+    {
+        if (id == session || sess.image == image)
+        {
+            return false;
+        }
+    }
+
+    sessions.try_emplace(session, session, image);
+    return true;
+}
+
+std::vector<uint8_t> DeltaBlobHandler::read(uint16_t, uint32_t, uint32_t)
+{
+    /* The patch is write-only. */
+    return std::vector<uint8_t>();
+}
+
+bool DeltaBlobHandler::write(uint16_t session, uint32_t offset,
+                             const std::vector<uint8_t>& data)
+{
+    return writeBytes(session, offset, data);
+}
+
+bool DeltaBlobHandler::writeBytes(uint16_t session, uint32_t offset,
+                                  std::span<const uint8_t> data)
+{
+    DeltaBlob* sess = getSession(session);
+    if (!sess || !(sess->state & StateFlags::open_write))
+    {
+        return false;
+    }
+
+    /* The patch is applied as it arrives, so it must arrive in order.  Bytes
+     * already received are a retry, and only what follows them is new.
+     */
+    if (offset > sess->received)
+    {
+        return false;
+    }
+    if (offset + data.size() <= sess->received)
+    {
+        return true;
+    }
+    data = data.subspan(sess->received - offset);
+
+    if (!feed(sess, data) || !applyCopies(sess, deltaApplyStep))
+    {
+        finishApply(sess, false);
+        return false;
+    }
+    return true;
+}
+
+bool DeltaBlobHandler::writeMeta(uint16_t, uint32_t,
+                                 const std::vector<uint8_t>&)
+{
+    /* Not supported. */
+    return false;
+}
+
+bool DeltaBlobHandler::commit(uint16_t session, const std::vector<uint8_t>&)
+{
+    DeltaBlob* sess = getSession(session);
+    if (!sess)
+    {
+        return false;
+    }
+    /* Committing again while the patch applies is fine. */
+    if (sess->state & StateFlags::committing)
+    {
+        return true;
+    }
+    if (!(sess->state & StateFlags::open_write))
+    {
+        return false;
+    }
+
+    /* The operations must all be whole, and make the whole target. */
+    if (!sess->headerRead || sess->staged > 0 || sess->inserting > 0 ||
+        sess->produced != sess->targetSize)
+    {
+        log<level::ERR>("Delta patch ended early");
+        finishApply(sess, false);
+        return false;
+    }
+    sess->state = StateFlags::committing;
+    return true;
+}
+
+bool DeltaBlobHandler::feed(DeltaBlob* sess, std::span<const uint8_t> data)
+{
+    while (!data.empty())
+    {
+        if (sess->inserting > 0)
+        {
+            size_t count = std::min<size_t>(sess->inserting, data.size());
+            sess->target.seekp(sess->insertOffset);
+            sess->target.write(reinterpret_cast<const char*>(data.data()),
+                               count);
+            if (!sess->target)
+            {
+                log<level::ERR>("Delta could not write the target image");
+                return false;
+            }
+            sess->inserting -= count;
+            sess->insertOffset += count;
+            sess->written += count;
+            sess->received += count;
+            data = data.subspan(count);
+            continue;
+        }
+
+        /* Gather the next header, which may arrive over several writes. */
+        size_t need =
+            stageSize(*sess, sess->staged > 0 ? sess->stage[0] : data[0]);
+        if (need == 0)
+        {
+            log<level::ERR>("Delta patch is malformed");
+            return false;
+        }
+        size_t count = std::min(need - sess->staged, data.size());
+        std::copy_n(data.begin(), count, sess->stage.begin() + sess->staged);
+        sess->staged += count;
+        sess->received += count;
+        data = data.subspan(count);
+        if (sess->staged < need)
+        {
+            continue;
+        }
+
+        bool ok = sess->headerRead ? readOp(sess) : readHeader(sess);
+        sess->staged = 0;
+        if (!ok)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DeltaBlobHandler::readHeader(DeltaBlob* sess)
+{
+    std::span<const uint8_t> header(sess->stage.data(), sess->staged);
+    if (std::memcmp(header.data(), deltaMagic, sizeof(deltaMagic)) != 0)
+    {
+        log<level::ERR>("Delta patch has no valid header");
+        return false;
+    }
+    size_t cursor = sizeof(deltaMagic);
+    sess->baseSize = take<uint64_t>(header, &cursor);
+    sess->targetSize = take<uint64_t>(header, &cursor);
+    std::copy_n(header.begin() + cursor, deltaShaSize,
+                sess->baseSha256.begin());
+    cursor += deltaShaSize;
+    std::copy_n(header.begin() + cursor, deltaShaSize,
+                sess->targetSha256.begin());
+
+    /* A patch made against some other base would produce garbage, so the
+     * base is checked before the partial target is even created.  The size
+     * is checked first as it is cheap.
+     */
+    std::error_code ec;
+    auto actualSize = std::filesystem::file_size(sess->image->basePath, ec);
+    sess->base.open(sess->image->basePath, std::ios::binary);
+    Sha256 sha = startSha256();
+    if (ec || actualSize != sess->baseSize || !sess->base || !sha ||
+        !hashFile(sess->base, sess->baseSize, sha.get()) ||
+        !shaMatches(sha.get(), sess->baseSha256))
+    {
+        log<level::ERR>("Delta base image doesn't match the patch",
+                        entry("BASE=%s", sess->image->basePath.c_str()));
+        return false;
+    }
+
+    sess->target.open(partialPath(*sess->image),
+                      std::ios::binary | std::ios::trunc);
+    if (!sess->target)
+    {
+        log<level::ERR>("Delta could not open its images",
+                        entry("TARGET=%s", sess->image->targetPath.c_str()));
+        return false;
+    }
+    sess->headerRead = true;
+    return true;
+}
+
+bool DeltaBlobHandler::readOp(DeltaBlob* sess)
+{
+    std::span<const uint8_t> header(sess->stage.data(), sess->staged);
+    auto op = static_cast<DeltaOp>(header[0]);
+    size_t cursor = 1;
+    uint64_t baseOffset = 0;
+    if (op == DeltaOp::copy)
+    {
+        baseOffset = take<uint64_t>(header, &cursor);
+    }
+    uint32_t length = take<uint32_t>(header, &cursor);
+
+    if (length > sess->targetSize - sess->produced ||
+        (op == DeltaOp::copy && (baseOffset > sess->baseSize ||
+                                 length > sess->baseSize - baseOffset)))
+    {
+        log<level::ERR>("Delta patch is malformed");
+        return false;
+    }
+
+    if (op == DeltaOp::insert)
+    {
+        sess->inserting = length;
+        sess->insertOffset = sess->produced;
+    }
+    else if (length > 0)
+    {
+        /* A patch of many short copies would otherwise queue without
+         * bound, so make room by applying the oldest.
+         */
+        if (sess->copies.size() == deltaMaxQueuedCopies &&
+            !applyCopies(sess, sess->copies.front().length))
+        {
+            return false;
+        }
+        sess->copies.push_back(DeltaCopy{.targetOffset = sess->produced,
+                                         .baseOffset = baseOffset,
+                                         .length = length});
+    }
+    sess->produced += length;
+    return true;
+}
+
+bool DeltaBlobHandler::applyCopies(DeltaBlob* sess, uint64_t budget)
+{
+    std::vector<char> buffer;
+    while (budget > 0 && !sess->copies.empty())
+    {
+        DeltaCopy& copy = sess->copies.front();
+        uint32_t count = std::min<uint64_t>(copy.length, budget);
+        buffer.resize(count);
+        sess->base.seekg(copy.baseOffset);
+        if (!sess->base.read(buffer.data(), count))
+        {
+            log<level::ERR>("Delta could not read the base image");
+            return false;
+        }
+        sess->target.seekp(copy.targetOffset);
+        sess->target.write(buffer.data(), count);
+        if (!sess->target)
+        {
+            log<level::ERR>("Delta could not write the target image");
+            return false;
+        }
+
+        copy.targetOffset += count;
+        copy.baseOffset += count;
+        copy.length -= count;
+        if (copy.length == 0)
+        {
+            sess->copies.pop_front();
+        }
+        sess->written += count;
+        budget -= count;
+    }
+    return true;
+}
+
+bool DeltaBlobHandler::checkTarget(DeltaBlob* sess, uint64_t budget)
+{
+    /* With the copies all applied, the target is whole and can be closed
+     * and read back.
+     */
+    if (!sess->targetHash)
+    {
+        sess->target.close();
+        if (sess->target.fail() || sess->written != sess->targetSize)
+        {
+            log<level::ERR>("Delta could not write the target image");
+            return false;
+        }
+        sess->readBack.open(partialPath(*sess->image), std::ios::binary);
+        sess->targetHash = startSha256();
+        if (!sess->readBack || !sess->targetHash)
+        {
+            log<level::ERR>("Delta could not read back the target image");
+            return false;
+        }
+    }
+
+    uint64_t count = std::min(budget, sess->targetSize - sess->checked);
+    if (!hashFile(sess->readBack, count, sess->targetHash.get()))
+    {
+        log<level::ERR>("Delta could not read back the target image");
+        return false;
+    }
+    sess->checked += count;
+
+    if (sess->checked == sess->targetSize &&
+        !shaMatches(sess->targetHash.get(), sess->targetSha256))
+    {
+        log<level::ERR>("Delta target image doesn't match the patch",
+                        entry("TARGET=%s", sess->image->targetPath.c_str()));
+        return false;
+    }
+    return true;
+}
+
+void DeltaBlobHandler::finishApply(DeltaBlob* sess, bool complete)
+{
+    sess->copies.clear();
+    sess->base.close();
+    sess->readBack.close();
+
+    /* checkTarget has already closed a complete target, and closing it
+     * again would mark it failed.
+     */
+    if (sess->target.is_open())
+    {
+        sess->target.close();
+    }
+
+    std::string partial = partialPath(*sess->image);
+    std::error_code ec;
+    if (complete && !sess->target.fail())
+    {
+        std::filesystem::rename(partial, sess->image->targetPath, ec);
+        if (!ec)
+        {
+            sess->state = StateFlags::committed;
+            return;
+        }
+        log<level::ERR>("Delta could not move the target image into place",
+                        entry("TARGET=%s", sess->image->targetPath.c_str()));
+    }
+
+    std::filesystem::remove(partial, ec);
+    sess->state = StateFlags::commit_error;
+}
+
+bool DeltaBlobHandler::close(uint16_t session)
+{
+    DeltaBlob* sess = getSession(session);
+    if (!sess)
+    {
+        return false;
+    }
+
+    /* Abandon a patch that is still streaming in or being applied. */
+    if (sess->state & (StateFlags::open_write | StateFlags::committing))
+    {
+        finishApply(sess, false);
+    }
+    sessions.erase(session);
+    return true;
+}
+
+bool DeltaBlobHandler::stat(uint16_t session, BlobMeta* meta)
+{
+    DeltaBlob* sess = getSession(session);
+    if (!sess || !meta)
+    {
+        return false;
+    }
+
+    /* The host polls the session's stat until committing is done, as it
+     * must for any blob.  Each poll applies the next of the copies left, or
+     * once they are all applied, checks the next step of the target.
+     */
+    if (sess->state & StateFlags::committing)
+    {
+        bool ok = sess->copies.empty() ? checkTarget(sess, deltaApplyStep)
+                                       : applyCopies(sess, deltaApplyStep);
+        if (!ok)
+        {
+            finishApply(sess, false);
+        }
+        else if (sess->targetHash && sess->checked == sess->targetSize)
+        {
+            finishApply(sess, true);
+        }
+    }
+
+    meta->size64 = sess->received;
+    meta->blobState = sess->state;
+    if (sess->state & StateFlags::committing)
+    {
+        /* Still committing means checked < targetSize, and the division
+         * rounds down, so this is at most 99.
+         */
+        meta->blobState |= ((sess->written + sess->checked) * 50 /
+                            sess->targetSize)
+                           << deltaProgressShift;
+    }
+    return true;
+}
+
+bool DeltaBlobHandler::expire(uint16_t session)
+{
+    return close(session);
+}
+
+} // namespace blobs
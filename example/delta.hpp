@@ -0,0 +1,205 @@
+#pragma once
+
+#include <blobs-ipmid/blobs.hpp>
+#include <openssl/evp.h>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * This method must be declared as extern C for blob manager to lookup the
+ * symbol.
+ */
+std::unique_ptr<blobs::GenericBlobInterface> createHandler();
+
+#ifdef __cplusplus
+}
+#endif
+
+namespace blobs
+{
+
+/*
+ * A patch is a header followed by operations, each producing the next bytes
+ * of the target image.  Every field is little-endian.
+ *
+ *   header:  "BDP1", uint64_t baseSize, uint64_t targetSize,
+ *            uint8_t baseSha256[32], uint8_t targetSha256[32]
+ *   copy:    0x00, uint64_t baseOffset, uint32_t length
+ *   insert:  0x01, uint32_t length, uint8_t data[length]
+ */
+constexpr char deltaMagic[4] = {'B', 'D', 'P', '1'};
+
+enum class DeltaOp : uint8_t
+{
+    copy = 0,
+    insert = 1,
+};
+
+constexpr size_t deltaShaSize = 32;
+constexpr size_t deltaHeaderSize =
+    sizeof(deltaMagic) + 8 + 8 + deltaShaSize + deltaShaSize;
+constexpr size_t deltaCopySize = 1 + 8 + 4;
+constexpr size_t deltaInsertSize = 1 + 4;
+
+/* The most base bytes copied per write() while the patch streams in, and
+ * the most bytes copied or read back per stat() of a committing session.
+ */
+constexpr uint32_t deltaApplyStep = 64 * 1024;
+
+/* The most copy operations a session queues before write() applies them
+ * whatever their length.
+ */
+constexpr size_t deltaMaxQueuedCopies = 256;
+
+/* While committing, bits 8-15 of the state hold the percent done.  Writing
+ * the target and reading it back to check it count for half each.
+ */
+constexpr int deltaProgressShift = 8;
+
+/* A base image on the BMC, and where the image patched from it goes. */
+struct DeltaImage
+{
+    /* The blob id is deltaBlobPrefix followed by the name. */
+    std::string name;
+    std::string basePath;
+    std::string targetPath;
+};
+
+/* A copy operation read from the patch but not yet applied. */
+struct DeltaCopy
+{
+    uint64_t targetOffset;
+    uint64_t baseOffset;
+    uint32_t length;
+};
+
+struct DeltaBlob
+{
+    DeltaBlob() = default;
+    DeltaBlob(uint16_t id, const DeltaImage* image) :
+        sessionId(id), image(image), state(StateFlags::open_write)
+    {}
+
+    /* The blob handler session id. */
+    uint16_t sessionId = 0;
+
+    /* The image the patch applies to. */
+    const DeltaImage* image = nullptr;
+
+    /* The current state, without the progress bits. */
+    uint16_t state = 0;
+
+    /* Patch bytes received so far, which arrive in order. */
+    uint64_t received = 0;
+
+    /* The header, or the operation header, being read.  It may be split
+     * across writes, so its bytes are kept until it is whole.
+     */
+    std::array<uint8_t, deltaHeaderSize> stage{};
+    size_t staged = 0;
+    bool headerRead = false;
+
+    /* Insert bytes still to come, and where in the target they go. */
+    uint32_t inserting = 0;
+    uint64_t insertOffset = 0;
+
+    /* The sizes are from the header.  produced is how much of the target
+     * the operations so far describe, and written how much is on disk.
+     */
+    uint64_t baseSize = 0;
+    uint64_t targetSize = 0;
+    uint64_t produced = 0;
+    uint64_t written = 0;
+
+    /* The digests from the header. */
+    std::array<uint8_t, deltaShaSize> baseSha256{};
+    std::array<uint8_t, deltaShaSize> targetSha256{};
+
+    std::deque<DeltaCopy> copies;
+    std::ifstream base;
+    std::ofstream target;
+
+    /* Once the target is written, it is read back and hashed a step at a
+     * time, and checked is how much of it has been.
+     */
+    std::ifstream readBack;
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> targetHash{
+        nullptr, EVP_MD_CTX_free};
+    uint64_t checked = 0;
+};
+
+/*
+ * Accepts a patch against a base image already on the BMC, rather than a
+ * whole new image.  The patch is applied as it streams in: once its header
+ * checks out, insert data is written straight to the target and copies from
+ * the base are queued, then applied deltaApplyStep bytes at a time by each
+ * write.  Only the header being read is held in memory, never the patch.
+ * commit() checks the patch ended cleanly, and whatever copies remain are
+ * applied as the host polls stat(session), which the protocol already
+ * requires until committing finishes, so no single call blocks the channel
+ * for long.  The same polls then read the target back to check its SHA-256.
+ * A host that stops polling leaves the patch half applied until the session
+ * is closed or expires, which abandons it.  The target is written beside its
+ * final path and only renamed into place once it is complete and checks out.
+ *
+ * The one step done all at once is hashing the base image, by the write that
+ * completes the header, since nothing may be written until the base is known
+ * to be the one the patch was made against.
+ */
+class DeltaBlobHandler : public GenericBlobInterface
+{
+  public:
+    explicit DeltaBlobHandler(std::vector<DeltaImage> images) :
+        images(std::move(images))
+    {}
+
+    bool canHandleBlob(const std::string& path) override;
+    std::vector<std::string> getBlobIds() override;
+    bool deleteBlob(const std::string& path) override;
+    bool stat(const std::string& path, BlobMeta* meta) override;
+    bool open(uint16_t session, uint16_t flags,
+              const std::string& path) override;
+    std::vector<uint8_t> read(uint16_t session, uint32_t offset,
+                              uint32_t requestedSize) override;
+    bool write(uint16_t session, uint32_t offset,
+               const std::vector<uint8_t>& data) override;
+    bool writeBytes(uint16_t session, uint32_t offset,
+                    std::span<const uint8_t> data) override;
+    bool writeMeta(uint16_t session, uint32_t offset,
+                   const std::vector<uint8_t>& data) override;
+    bool commit(uint16_t session, const std::vector<uint8_t>& data) override;
+    bool close(uint16_t session) override;
+    bool stat(uint16_t session, BlobMeta* meta) override;
+    bool expire(uint16_t session) override;
+
+    constexpr static char deltaBlobPrefix[] = "/delta/";
+
+  private:
+    DeltaBlob* getSession(uint16_t id);
+    const DeltaImage* findImage(const std::string& path) const;
+    bool feed(DeltaBlob* sess, std::span<const uint8_t> data);
+    bool readHeader(DeltaBlob* sess);
+    bool readOp(DeltaBlob* sess);
+    bool applyCopies(DeltaBlob* sess, uint64_t budget);
+    bool checkTarget(DeltaBlob* sess, uint64_t budget);
+    void finishApply(DeltaBlob* sess, bool complete);
+
+    std::vector<DeltaImage> images;
+    std::unordered_map<uint16_t, DeltaBlob> sessions;
+};
+
+} // namespace blobs
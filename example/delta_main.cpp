@@ -0,0 +1,21 @@
+#include "delta_config.h"
+#include "example/delta.hpp"
+
+#include <memory>
+#include <vector>
+
+/**
+ * This method is required by the blob manager.
+ *
+ * It is called to grab a handler for registering the blob handler instance.
+ * The image it patches is set when the module is built.
+ */
+std::unique_ptr<blobs::GenericBlobInterface> createHandler()
+{
+    return std::make_unique<blobs::DeltaBlobHandler>(
+        std::vector<blobs::DeltaImage>{{
+            .name = DELTA_IMAGE_NAME,
+            .basePath = DELTA_BASE_PATH,
+            .targetPath = DELTA_TARGET_PATH,
+        }});
+}
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cstring>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -93,6 +94,12 @@ std::vector<uint8_t> ExampleBlobHandler::read(uint16_t session, uint32_t offset,
 
 bool ExampleBlobHandler::write(uint16_t session, uint32_t offset,
                                const std::vector<uint8_t>& data)
+{
+    return writeBytes(session, offset, data);
+}
+
+bool ExampleBlobHandler::writeBytes(uint16_t session, uint32_t offset,
+                                    std::span<const uint8_t> data)
 {
     ExampleBlob* sess = getSession(session);
     if (!sess)
@@ -110,13 +117,32 @@ bool ExampleBlobHandler::write(uint16_t session, uint32_t offset,
     {
         return false;
     }
-    sess->length =
-        std::max(offset + data.size(),
-                 static_cast<std::vector<uint8_t>::size_type>(sess->length));
+    sess->length = std::max(offset + data.size(),
+                            static_cast<size_t>(sess->length));
     std::memcpy(&sess->buffer[offset], data.data(), data.size());
     return true;
 }
 
+bool ExampleBlobHandler::fill(uint16_t session, uint64_t offset,
+                              uint64_t length, uint8_t pattern)
+{
+    ExampleBlob* sess = getSession(session);
+    if (!sess)
+    {
+        return false;
+    }
+    /* The same bounds as writeBytes(), without building the bytes first. */
+    if (offset >= sizeof(sess->buffer) ||
+        length > sizeof(sess->buffer) - offset)
+    {
+        return false;
+    }
+    sess->length =
+        std::max(static_cast<uint32_t>(offset + length), sess->length);
+    std::memset(&sess->buffer[offset], pattern, length);
+    return true;
+}
+
 bool ExampleBlobHandler::writeMeta(uint16_t, uint32_t,
                                    const std::vector<uint8_t>&)
 {
@@ -3,6 +3,7 @@
 #include <blobs-ipmid/blobs.hpp>
 
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -74,6 +75,10 @@ class ExampleBlobHandler : public GenericBlobInterface
                               uint32_t requestedSize) override;
     bool write(uint16_t session, uint32_t offset,
                const std::vector<uint8_t>& data) override;
+    bool writeBytes(uint16_t session, uint32_t offset,
+                    std::span<const uint8_t> data) override;
+    bool fill(uint16_t session, uint64_t offset, uint64_t length,
+              uint8_t pattern) override;
     bool writeMeta(uint16_t session, uint32_t offset,
                    const std::vector<uint8_t>& data) override;
     bool commit(uint16_t session, const std::vector<uint8_t>& data) override;
@@ -16,300 +16,1164 @@
 
 #include "ipmi.hpp"
 
-#include <cstring>
+#include "compress.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <optional>
 #include <span>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 namespace blobs
 {
 
-bool validateRequestLength(BlobOEMCommands command, size_t requestLen)
+namespace
 {
-    /* The smallest string is one letter and the nul-terminator. */
-    static const int kMinStrLen = 2;
-
-    static const std::unordered_map<BlobOEMCommands, size_t> minimumLengths = {
-        {BlobOEMCommands::bmcBlobEnumerate, sizeof(struct BmcBlobEnumerateTx)},
-        {BlobOEMCommands::bmcBlobOpen,
-         sizeof(struct BmcBlobOpenTx) + kMinStrLen},
-        {BlobOEMCommands::bmcBlobClose, sizeof(struct BmcBlobCloseTx)},
-        {BlobOEMCommands::bmcBlobDelete,
-         sizeof(struct BmcBlobDeleteTx) + kMinStrLen},
-        {BlobOEMCommands::bmcBlobStat,
-         sizeof(struct BmcBlobStatTx) + kMinStrLen},
-        {BlobOEMCommands::bmcBlobSessionStat,
-         sizeof(struct BmcBlobSessionStatTx)},
-        {BlobOEMCommands::bmcBlobCommit, sizeof(struct BmcBlobCommitTx)},
-        {BlobOEMCommands::bmcBlobRead, sizeof(struct BmcBlobReadTx)},
-        {BlobOEMCommands::bmcBlobWrite,
-         sizeof(struct BmcBlobWriteTx) + sizeof(uint8_t)},
-        {BlobOEMCommands::bmcBlobWriteMeta,
-         sizeof(struct BmcBlobWriteMetaTx) + sizeof(uint8_t)},
-    };
 
-    auto results = minimumLengths.find(command);
-    if (results == minimumLengths.end())
+template <WireRequest... Requests>
+struct RequestList
+{};
+
+/* Every request with a layout.  Commands without one, such as
+ * bmcBlobGetCount, have no minimum length and act on no session.
+ */
+using KnownRequests =
+    RequestList<BmcBlobEnumerateTx, BmcBlobOpenTx, BmcBlobCloseTx,
+                BmcBlobDeleteTx, BmcBlobStatTx, BmcBlobSessionStatTx,
+                BmcBlobCommitTx, BmcBlobReadTx, BmcBlobWriteTx,
+                BmcBlobWriteMetaTx, BmcBlobBatchTx, BmcBlobEnumerateRangeTx,
+                BmcBlobEnumerateStatTx, BmcBlobOpenHandleTx,
+                BmcBlobStatHandleTx, BmcBlobDeleteHandleTx,
+                BmcBlobWriteAppendTx, BmcBlobWriteWindowedTx,
+                BmcBlobWriteAckTx, BmcBlobGetMissingTx, BmcBlobFillTx,
+                BmcBlobWriteVectoredTx, BmcBlobRead64Tx, BmcBlobWrite64Tx,
+                BmcBlobStat64Tx, BmcBlobSessionStat64Tx, BmcBlobDigestTx,
+                BmcBlobSourceChunksTx>;
+
+template <WireRequest... Requests>
+constexpr auto makeMinimumLengths(RequestList<Requests...>)
+{
+    std::array<size_t, std::numeric_limits<uint8_t>::max() + 1> lengths{};
+    ((lengths[static_cast<uint8_t>(Requests::command)] =
+          minimumRequestLength<Requests>),
+     ...);
+    return lengths;
+}
+
+constexpr auto minimumLengths = makeMinimumLengths(KnownRequests{});
+
+/* Whether the request's fields lead with a BmcSessionHeader. */
+template <WireRequest Request>
+constexpr bool leadsWithSession()
+{
+    if constexpr (requires { &Request::sessionId; })
     {
-        /* Valid length by default if we don't care. */
-        return true;
+        return offsetof(Request, sessionId) ==
+               offsetof(BmcSessionHeader, sessionId);
     }
+    return false;
+}
 
-    /* If the request is shorter than the minimum, it's invalid. */
-    if (requestLen < results->second)
+template <WireRequest... Requests>
+constexpr auto makeSessionCommands(RequestList<Requests...>)
+{
+    std::array<bool, std::numeric_limits<uint8_t>::max() + 1> commands{};
+    ((commands[static_cast<uint8_t>(Requests::command)] =
+          leadsWithSession<Requests>()),
+     ...);
+    return commands;
+}
+
+constexpr auto sessionCommands = makeSessionCommands(KnownRequests{});
+
+static_assert(sessionCommands[static_cast<uint8_t>(
+    BlobOEMCommands::bmcBlobWrite)]);
+static_assert(!sessionCommands[static_cast<uint8_t>(
+    BlobOEMCommands::bmcBlobOpen)]);
+
+/* Reported by bmcBlobGetCaps. */
+constexpr uint32_t supportedExtensions =
+    ProtocolExtensions::autoSizedRead | ProtocolExtensions::batch |
+    ProtocolExtensions::enumerateRange | ProtocolExtensions::enumerateStat |
+    ProtocolExtensions::blobHandles | ProtocolExtensions::writeAppend |
+    ProtocolExtensions::windowedWrite | ProtocolExtensions::missingRanges |
+    ProtocolExtensions::compressedWrites |
+    ProtocolExtensions::compressedReads | ProtocolExtensions::fill |
+    ProtocolExtensions::writeVectored | ProtocolExtensions::largeBlobs |
+    ProtocolExtensions::rangeDigest | ProtocolExtensions::sourceChunks;
+
+/* The 32-bit size fields report a blob past 4GiB as the largest size they
+ * hold, which the host can tell apart with a 64-bit stat.
+ */
+uint32_t narrowSize(uint64_t size)
+{
+    return static_cast<uint32_t>(
+        std::min<uint64_t>(size, std::numeric_limits<uint32_t>::max()));
+}
+
+/* The most bytes that still fit in room if none of them compress, sent as
+ * literal runs of up to 128 bytes behind one control byte each.
+ */
+size_t literalFit(size_t room)
+{
+    return room * 128 / 129;
+}
+
+} // namespace
+
+uint32_t clampReadSize(uint32_t requestedSize, size_t replySpace)
+{
+    if (replySpace <= wireSize<BmcBlobReadRx>)
     {
-        return false;
+        return 0;
     }
 
-    return true;
+    size_t available = replySpace - wireSize<BmcBlobReadRx>;
+    return (requestedSize < available) ? requestedSize
+                                       : static_cast<uint32_t>(available);
+}
+
+bool validateRequestLength(BlobOEMCommands command, size_t requestLen)
+{
+    /* If the request is shorter than the minimum, it's invalid. */
+    return requestLen >= minimumLengths[static_cast<uint8_t>(command)];
 }
 
-std::string stringFromBuffer(std::span<const uint8_t> data)
+std::optional<uint16_t> requestSessionId(BlobOEMCommands command,
+                                         RequestBody data)
 {
-    if (data.empty() || data.back() != '\0')
+    if (!sessionCommands[static_cast<uint8_t>(command)] ||
+        data.length() < wireSize<BmcSessionHeader>)
     {
-        return std::string();
+        return std::nullopt;
     }
 
-    // Last index is nul-terminator.
-    return std::string(data.begin(), data.end() - 1);
+    /* Without its crc, the body starts at the session id. */
+    if (!data.withCrc)
+    {
+        return internal::loadLittleEndian<uint16_t>(data.bytes.data());
+    }
+    return decode<BmcSessionHeader>(data.bytes).sessionId;
 }
 
-Resp getBlobCount(ManagerInterface* mgr, std::span<const uint8_t>)
+ipmi::Cc getBlobCount(ManagerInterface* mgr, RequestBody, ResponseWriter& reply)
 {
     struct BmcBlobCountRx resp;
     resp.crc = 0;
     resp.blobCount = mgr->buildBlobList();
 
-    /* Copy the response into the reply buffer */
-    std::vector<uint8_t> output(sizeof(BmcBlobCountRx), 0);
-    std::memcpy(output.data(), &resp, sizeof(resp));
-
-    return ipmi::responseSuccess(output);
+    /* Encode the response into the reply buffer */
+    reply.put(resp);
+    return ipmi::ccSuccess;
 }
 
-Resp enumerateBlob(ManagerInterface* mgr, std::span<const uint8_t> data)
+ipmi::Cc getBlobCaps(ManagerInterface* mgr, RequestBody data,
+                     ResponseWriter& reply)
 {
-    /* Verify datalen is >= sizeof(request) */
-    struct BmcBlobEnumerateTx request;
+    /* The reply buffer is sized to the channel's max transfer size, and a
+     * request is assumed to have the same limit.
+     */
+    size_t maxTransfer = std::min<size_t>(reply.capacity(),
+                                          std::numeric_limits<uint16_t>::max());
+    auto chunk = [maxTransfer](size_t header) {
+        return static_cast<uint16_t>(
+            (maxTransfer > header) ? maxTransfer - header : 0);
+    };
 
-    std::memcpy(&request, data.data(), sizeof(request));
+    SessionLimits limits = mgr->getSessionLimits();
 
-    std::string blobId = mgr->getBlobId(request.blobIdx);
+    struct BmcBlobGetCapsRx resp;
+    resp.crc = 0;
+    resp.maxTransferSize = static_cast<uint16_t>(maxTransfer);
+    resp.writeChunkSize = chunk(wireSize<BmcBlobWriteTx>);
+    resp.readChunkSize = chunk(wireSize<BmcBlobReadRx>);
+    resp.extensions = supportedExtensions;
+    if (data.channelIntegrity)
+    {
+        resp.extensions |= ProtocolExtensions::noCrcSessions;
+    }
+    resp.maxSessions = limits.maxSessions;
+    resp.openSessions = limits.openSessions;
+    resp.sessionTimeout = static_cast<uint32_t>(limits.timeout.count());
+
+    reply.put(resp);
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc enumerateBlob(ManagerInterface* mgr, RequestBody data,
+                       ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobEnumerateTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    std::string blobId = mgr->getBlobId(request->header.blobIdx);
     if (blobId.empty())
     {
-        return ipmi::responseInvalidFieldRequest();
+        return ipmi::ccInvalidFieldRequest;
+    }
+
+    /* The blobId goes out with its nul-terminator. */
+    reply.put(BmcBlobEnumerateRx{.crc = 0});
+    reply.append(std::span(reinterpret_cast<const uint8_t*>(blobId.c_str()),
+                           blobId.length() + 1));
+    return ipmi::ccSuccess;
+}
+
+/* Bytes blobId shares with the one before it, capped to fit the count byte. */
+static size_t sharedPrefix(const std::string& blobId, const std::string* prev)
+{
+    if (!prev)
+    {
+        return 0;
     }
 
-    std::vector<uint8_t> output(sizeof(BmcBlobEnumerateRx), 0);
-    output.insert(output.end(), blobId.c_str(),
-                  blobId.c_str() + blobId.length() + 1);
-    return ipmi::responseSuccess(output);
+    auto mismatch =
+        std::mismatch(blobId.begin(), blobId.end(), prev->begin(), prev->end());
+    return std::min<size_t>(mismatch.first - blobId.begin(),
+                            std::numeric_limits<uint8_t>::max());
 }
 
-Resp openBlob(ManagerInterface* mgr, std::span<const uint8_t> data)
+ipmi::Cc enumerateBlobRange(ManagerInterface* mgr, RequestBody data,
+                            ResponseWriter& reply)
 {
-    auto request = reinterpret_cast<const struct BmcBlobOpenTx*>(data.data());
+    auto request = decodeRequest<BmcBlobEnumerateRangeTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    std::span<const std::string> blobIds =
+        mgr->getBlobIdRange(request->header.blobIdx);
+    if (blobIds.empty())
+    {
+        return ipmi::ccInvalidFieldRequest;
+    }
+
+    bool frontCoded = request->header.flags & EnumerateRangeFlags::frontCoded;
+    std::span<uint8_t> headerOut =
+        reply.reserve(wireSize<BmcBlobEnumerateRangeRx>);
+    if (headerOut.empty())
+    {
+        return ipmi::ccSuccess;
+    }
+
+    uint8_t count = 0;
+    const std::string* prev = nullptr;
+    for (const std::string& blobId : blobIds)
+    {
+        size_t shared = frontCoded ? sharedPrefix(blobId, prev) : 0;
+        std::string_view rest = std::string_view(blobId).substr(shared);
+        size_t length = (frontCoded ? 1 : 0) + rest.size() + 1;
+
+        /* The first blobId must fit, the rest are packed in until one
+         * doesn't.
+         */
+        if (count == std::numeric_limits<uint8_t>::max() ||
+            (count > 0 && length > reply.remaining()))
+        {
+            break;
+        }
+
+        std::span<uint8_t> out = reply.reserve(length);
+        if (out.empty())
+        {
+            break;
+        }
+
+        auto it = out.begin();
+        if (frontCoded)
+        {
+            *it++ = static_cast<uint8_t>(shared);
+        }
+        it = std::copy(rest.begin(), rest.end(), it);
+        *it = '\0';
+
+        prev = &blobId;
+        count++;
+    }
+
+    BmcBlobEnumerateRangeRx resp;
+    resp.crc = 0;
+    resp.nextIdx = request->header.blobIdx + count;
+    resp.handle = mgr->getBlobHandle(request->header.blobIdx);
+    resp.count = count;
+    encode(resp, headerOut);
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc enumerateStatBlob(ManagerInterface* mgr, RequestBody data,
+                           ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobEnumerateStatTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    std::span<const std::string> blobIds =
+        mgr->getBlobIdRange(request->header.blobIdx);
+    if (blobIds.empty())
+    {
+        return ipmi::ccInvalidFieldRequest;
+    }
+
+    /* Work out how many entries fit before asking for any stats.  The first
+     * must fit, the rest are packed in until one doesn't.
+     */
+    size_t space = reply.remaining();
+    space -= std::min(space, wireSize<BmcBlobEnumerateStatRx>);
+    size_t count = 0;
+    for (const std::string& blobId : blobIds)
+    {
+        size_t length = wireSize<BmcBlobEnumerateStatEntry> + blobId.size() + 1;
+        if (count == std::numeric_limits<uint8_t>::max() ||
+            (count > 0 && length > space))
+        {
+            break;
+        }
+        space -= std::min(space, length);
+        count++;
+    }
+
+    std::vector<std::optional<BlobMeta>> metas(count);
+    mgr->statBlobRange(request->header.blobIdx, metas);
+
+    BmcBlobEnumerateStatRx resp;
+    resp.crc = 0;
+    resp.nextIdx = request->header.blobIdx + count;
+    resp.handle = mgr->getBlobHandle(request->header.blobIdx);
+    resp.count = count;
+    reply.put(resp);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        BmcBlobEnumerateStatEntry entry{};
+        if (metas[i])
+        {
+            entry.valid = 1;
+            entry.blobState = metas[i]->blobState;
+            entry.size = narrowSize(metas[i]->fullSize());
+        }
+        reply.put(entry);
+
+        const std::string& blobId = blobIds[i];
+        reply.append(std::span(reinterpret_cast<const uint8_t*>(blobId.c_str()),
+                               blobId.length() + 1));
+    }
+    return ipmi::ccSuccess;
+}
+
+/* A NO_CRC session drops the per-packet crc, so it may only be opened on a
+ * channel that already guarantees its bytes.
+ */
+static bool openFlagsAllowed(uint16_t flags, RequestBody data)
+{
+    return !(flags & OpenFlags::noCrc) || data.channelIntegrity;
+}
+
+ipmi::Cc openBlob(ManagerInterface* mgr, RequestBody data,
+                  ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobOpenTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    if (!openFlagsAllowed(request->header.flags, data))
+    {
+        return ipmi::ccInvalidFieldRequest;
+    }
+
+    /* Attempt to open. */
     uint16_t session;
+    if (!mgr->open(request->header.flags, request->blobId(), &session))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    struct BmcBlobOpenRx resp;
+    resp.crc = 0;
+    resp.sessionId = session;
 
-    std::string path = stringFromBuffer(data.subspan(sizeof(BmcBlobOpenTx)));
-    if (path.empty())
+    reply.put(resp);
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc openBlobHandle(ManagerInterface* mgr, RequestBody data,
+                        ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobOpenHandleTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    if (!openFlagsAllowed(request->header.flags, data))
     {
-        return ipmi::responseReqDataLenInvalid();
+        return ipmi::ccInvalidFieldRequest;
     }
 
     /* Attempt to open. */
-    if (!mgr->open(request->flags, path, &session))
+    uint16_t session;
+    if (!mgr->openHandle(request->header.flags, request->header.handle,
+                         &session))
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
 
-    struct BmcBlobOpenRx reply;
-    reply.crc = 0;
-    reply.sessionId = session;
+    struct BmcBlobOpenRx resp;
+    resp.crc = 0;
+    resp.sessionId = session;
 
-    std::vector<uint8_t> output(sizeof(BmcBlobOpenRx), 0);
-    std::memcpy(output.data(), &reply, sizeof(reply));
-    return ipmi::responseSuccess(output);
+    reply.put(resp);
+    return ipmi::ccSuccess;
 }
 
-Resp closeBlob(ManagerInterface* mgr, std::span<const uint8_t> data)
+ipmi::Cc closeBlob(ManagerInterface* mgr, RequestBody data, ResponseWriter&)
 {
-    struct BmcBlobCloseTx request;
-    if (data.size() < sizeof(request))
+    auto request = decodeRequest<BmcBlobCloseTx>(data);
+    if (!request)
     {
-        return ipmi::responseReqDataLenInvalid();
+        return ipmi::ccReqDataLenInvalid;
     }
-    std::memcpy(&request, data.data(), sizeof(request));
 
     /* Attempt to close. */
-    if (!mgr->close(request.sessionId))
+    if (!mgr->close(request->header.sessionId))
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
 
-    return ipmi::responseSuccess(std::vector<uint8_t>{});
+    return ipmi::ccSuccess;
 }
 
-Resp deleteBlob(ManagerInterface* mgr, std::span<const uint8_t> data)
+ipmi::Cc deleteBlob(ManagerInterface* mgr, RequestBody data, ResponseWriter&)
 {
-    std::string path = stringFromBuffer(data.subspan(sizeof(BmcBlobDeleteTx)));
-    if (path.empty())
+    auto request = decodeRequest<BmcBlobDeleteTx>(data);
+    if (!request)
     {
-        return ipmi::responseReqDataLenInvalid();
+        return ipmi::ccReqDataLenInvalid;
     }
 
     /* Attempt to delete. */
-    if (!mgr->deleteBlob(path))
+    if (!mgr->deleteBlob(request->blobId()))
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
 
-    return ipmi::responseSuccess(std::vector<uint8_t>{});
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc deleteBlobHandle(ManagerInterface* mgr, RequestBody data,
+                          ResponseWriter&)
+{
+    auto request = decodeRequest<BmcBlobDeleteHandleTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    /* Attempt to delete. */
+    if (!mgr->deleteHandle(request->header.handle))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    return ipmi::ccSuccess;
+}
+
+static ipmi::Cc returnStatBlob(BlobMeta* meta, ResponseWriter& reply)
+{
+    struct BmcBlobStatRx resp;
+    resp.crc = 0;
+    resp.blobState = meta->blobState;
+    resp.size = narrowSize(meta->fullSize());
+    resp.metadataLen = meta->metadata.size();
+
+    /* If there is metadata, it follows the fixed fields. */
+    reply.put(resp);
+    reply.append(meta->metadata);
+    return ipmi::ccSuccess;
 }
 
-static Resp returnStatBlob(BlobMeta* meta)
+static ipmi::Cc returnStat64Blob(BlobMeta* meta, ResponseWriter& reply)
 {
-    struct BmcBlobStatRx reply;
-    reply.crc = 0;
-    reply.blobState = meta->blobState;
-    reply.size = meta->size;
-    reply.metadataLen = meta->metadata.size();
+    struct BmcBlobStat64Rx resp;
+    resp.crc = 0;
+    resp.blobState = meta->blobState;
+    resp.size = meta->fullSize();
+    resp.metadataLen = meta->metadata.size();
 
-    std::vector<uint8_t> output(sizeof(BmcBlobStatRx), 0);
-    std::memcpy(output.data(), &reply, sizeof(reply));
+    reply.put(resp);
+    reply.append(meta->metadata);
+    return ipmi::ccSuccess;
+}
 
-    /* If there is metadata, insert it to output. */
-    if (!meta->metadata.empty())
+ipmi::Cc statBlob(ManagerInterface* mgr, RequestBody data,
+                  ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobStatTx>(data);
+    if (!request)
     {
-        output.insert(output.end(), meta->metadata.begin(),
-                      meta->metadata.end());
+        return ipmi::ccReqDataLenInvalid;
     }
-    return ipmi::responseSuccess(output);
+
+    /* Attempt to stat. */
+    BlobMeta meta;
+    if (!mgr->stat(request->blobId(), &meta))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    return returnStatBlob(&meta, reply);
 }
 
-Resp statBlob(ManagerInterface* mgr, std::span<const uint8_t> data)
+ipmi::Cc statBlobHandle(ManagerInterface* mgr, RequestBody data,
+                        ResponseWriter& reply)
 {
-    std::string path = stringFromBuffer(data.subspan(sizeof(BmcBlobStatTx)));
-    if (path.empty())
+    auto request = decodeRequest<BmcBlobStatHandleTx>(data);
+    if (!request)
     {
-        return ipmi::responseReqDataLenInvalid();
+        return ipmi::ccReqDataLenInvalid;
     }
 
     /* Attempt to stat. */
     BlobMeta meta;
-    if (!mgr->stat(path, &meta))
+    if (!mgr->statHandle(request->header.handle, &meta))
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
 
-    return returnStatBlob(&meta);
+    return returnStatBlob(&meta, reply);
 }
 
-Resp sessionStatBlob(ManagerInterface* mgr, std::span<const uint8_t> data)
+ipmi::Cc sessionStatBlob(ManagerInterface* mgr, RequestBody data,
+                         ResponseWriter& reply)
 {
-    struct BmcBlobSessionStatTx request;
-    if (data.size() < sizeof(request))
+    auto request = decodeRequest<BmcBlobSessionStatTx>(data);
+    if (!request)
     {
-        return ipmi::responseReqDataLenInvalid();
+        return ipmi::ccReqDataLenInvalid;
     }
-    std::memcpy(&request, data.data(), sizeof(request));
 
     /* Attempt to stat. */
     BlobMeta meta;
 
-    if (!mgr->stat(request.sessionId, &meta))
+    if (!mgr->stat(request->header.sessionId, &meta))
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
 
-    return returnStatBlob(&meta);
+    return returnStatBlob(&meta, reply);
 }
 
-Resp commitBlob(ManagerInterface* mgr, std::span<const uint8_t> data)
+ipmi::Cc stat64Blob(ManagerInterface* mgr, RequestBody data,
+                    ResponseWriter& reply)
 {
-    auto request = reinterpret_cast<const struct BmcBlobCommitTx*>(data.data());
+    auto request = decodeRequest<BmcBlobStat64Tx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    BlobMeta meta;
+    if (!mgr->stat(request->blobId(), &meta))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    return returnStat64Blob(&meta, reply);
+}
+
+ipmi::Cc sessionStat64Blob(ManagerInterface* mgr, RequestBody data,
+                           ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobSessionStat64Tx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    BlobMeta meta;
+    if (!mgr->stat(request->header.sessionId, &meta))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    return returnStat64Blob(&meta, reply);
+}
+
+ipmi::Cc commitBlob(ManagerInterface* mgr, RequestBody data, ResponseWriter&)
+{
+    auto request = decodeRequest<BmcBlobCommitTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
 
     /* Sanity check the commitDataLen */
-    if (request->commitDataLen > (data.size() - sizeof(struct BmcBlobCommitTx)))
+    if (request->header.commitDataLen > request->trailer.size())
     {
-        return ipmi::responseReqDataLenInvalid();
+        return ipmi::ccReqDataLenInvalid;
     }
 
-    data = data.subspan(sizeof(struct BmcBlobCommitTx), request->commitDataLen);
+    auto commitData = request->trailer.first(request->header.commitDataLen);
+    if (!mgr->commit(request->header.sessionId,
+                     std::vector<uint8_t>(commitData.begin(),
+                                          commitData.end())))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
 
-    if (!mgr->commit(request->sessionId,
-                     std::vector<uint8_t>(data.begin(), data.end())))
+    return ipmi::ccSuccess;
+}
+
+/* The session's stat tells us whether a read reached the end.  A handler
+ * that reports no size, or can't stat a session at all as many don't, may
+ * still return a short read partway through, so only then is a short read
+ * taken to mean it ran out of blob.  The size is kept from the session's
+ * first read, and only stat'd again after a short one.
+ */
+static uint8_t readTrailerFlags(ManagerInterface* mgr, uint16_t session,
+                                uint64_t nextOffset, uint32_t requestedSize,
+                                size_t readSize)
+{
+    uint64_t size = mgr->getReadSize(session, readSize < requestedSize);
+    bool ended = (size != 0) ? nextOffset >= size : readSize < requestedSize;
+    if (ended)
     {
-        return ipmi::responseUnspecifiedError();
+        return ReadTrailerFlags::endOfBlob;
     }
+    return 0;
+}
 
-    return ipmi::responseSuccess(std::vector<uint8_t>{});
+/* A 32-bit reply can't carry an offset past 4GiB, so the reads that use one
+ * stop just short of it.  One that gets there before the end of the blob
+ * fails, and the host carries on with BmcBlobRead64.
+ */
+static bool stuckAt4GiB(uint64_t nextOffset, uint8_t flags)
+{
+    return nextOffset >= std::numeric_limits<uint32_t>::max() &&
+           !(flags & ReadTrailerFlags::endOfBlob);
 }
 
-Resp readBlob(ManagerInterface* mgr, std::span<const uint8_t> data)
+/* Each reply is compressed on its own, so a retried or out of order read
+ * decodes the same as any other.
+ */
+static ipmi::Cc readCompressed(ManagerInterface* mgr,
+                               const BmcBlobReadTx& request,
+                               ResponseWriter& reply)
 {
-    struct BmcBlobReadTx request;
-    if (data.size() < sizeof(request))
+    std::span<uint8_t> out = reply.unused();
+    out = out.subspan(std::min(out.size(), wireSize<BmcBlobCompressedReadRx>));
+
+    /* A requested size of zero asks for as much as compresses into the
+     * reply.  Either way the reads stop short of 4GiB.
+     */
+    uint64_t limit = std::numeric_limits<uint32_t>::max() - request.offset;
+    if (request.requestedSize != 0)
+    {
+        limit = std::min<uint64_t>(limit, request.requestedSize);
+    }
+
+    /* Start with what fits uncompressed, and only read more while the
+     * stream has room for it and the last chunk read shrank.  Data that
+     * doesn't compress is then read once, with nothing thrown away.  Each
+     * chunk is encoded onto the stream so far, matching back into the ones
+     * before it.
+     */
+    std::vector<uint8_t> data;
+    LzEncoder encoder(out);
+    uint64_t asked = 0;
+    size_t length = 0;
+    uint64_t chunk = std::min<uint64_t>(literalFit(out.size()), limit);
+    while (chunk > 0)
+    {
+        std::vector<uint8_t> more = mgr->read(
+            request.sessionId, static_cast<uint32_t>(request.offset + asked),
+            static_cast<uint32_t>(chunk));
+        asked += chunk;
+        data.insert(data.end(), more.begin(), more.end());
+
+        size_t before = encoder.written();
+        length = encoder.encode(data);
+        if (more.size() < chunk || length < data.size() ||
+            encoder.written() - before >= more.size())
+        {
+            break;
+        }
+        chunk = std::min<uint64_t>(literalFit(out.size() - encoder.written()),
+                                   limit - asked);
+    }
+    size_t written = encoder.written();
+
+    /* Only when everything read went out can the reply have reached the
+     * end of the blob.
+     */
+    struct BmcBlobCompressedReadRx resp;
+    resp.crc = 0;
+    resp.length = static_cast<uint32_t>(length);
+    uint64_t nextOffset = uint64_t{request.offset} + resp.length;
+    resp.nextOffset = static_cast<uint32_t>(nextOffset);
+    uint8_t flags = readTrailerFlags(mgr, request.sessionId, nextOffset,
+                                     static_cast<uint32_t>(asked), data.size());
+    resp.flags = (length == data.size()) ? flags : 0;
+    if (stuckAt4GiB(nextOffset, resp.flags))
     {
-        return ipmi::responseReqDataLenInvalid();
+        return ipmi::ccInvalidFieldRequest;
     }
-    std::memcpy(&request, data.data(), sizeof(request));
 
-    std::vector<uint8_t> result =
-        mgr->read(request.sessionId, request.offset, request.requestedSize);
+    reply.put(resp);
+    reply.reserve(written);
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc readBlob(ManagerInterface* mgr, RequestBody data,
+                  ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobReadTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    auto flags = mgr->getSessionFlags(request->header.sessionId);
+    if (flags && (*flags & OpenFlags::compressedRead))
+    {
+        return readCompressed(mgr, request->header, reply);
+    }
+
+    /* A requested size of zero asks for as much as fits, with room left for
+     * the trailer that tells the host where to carry on.
+     */
+    bool autoSize = (request->header.requestedSize == 0);
+    size_t replySpace = reply.remaining();
+    uint32_t requestedSize = request->header.requestedSize;
+    if (autoSize)
+    {
+        replySpace -= std::min(replySpace, wireSize<BmcBlobReadTrailer>);
+        requestedSize =
+            std::numeric_limits<uint32_t>::max() - request->header.offset;
+    }
+
+    /* Never ask for more than fits in the channel's reply after the crc.  A
+     * short read is allowed, so the host just gets the largest chunk that
+     * fits rather than an error after the handler has done the work.
+     */
+    requestedSize = clampReadSize(requestedSize, replySpace);
+
+    std::vector<uint8_t> result = mgr->read(
+        request->header.sessionId, request->header.offset, requestedSize);
 
     /* If the Read fails, it returns success but with only the crc and 0 bytes
      * of data.
      * If there was data returned, copy into the reply buffer.
      */
-    std::vector<uint8_t> output(sizeof(BmcBlobReadRx), 0);
+    reply.put(BmcBlobReadRx{.crc = 0});
+    reply.append(result);
+
+    if (autoSize)
+    {
+        uint64_t nextOffset = uint64_t{request->header.offset} + result.size();
+        uint8_t flags = readTrailerFlags(mgr, request->header.sessionId,
+                                         nextOffset, requestedSize,
+                                         result.size());
+        if (stuckAt4GiB(nextOffset, flags))
+        {
+            return ipmi::ccInvalidFieldRequest;
+        }
+        reply.put(BmcBlobReadTrailer{
+            .nextOffset = static_cast<uint32_t>(nextOffset), .flags = flags});
+    }
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc read64Blob(ManagerInterface* mgr, RequestBody data,
+                    ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobRead64Tx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    bool autoSize = (request->header.requestedSize == 0);
+    size_t replySpace = reply.remaining();
+    uint32_t requestedSize = request->header.requestedSize;
+    if (autoSize)
+    {
+        replySpace -= std::min(replySpace, wireSize<BmcBlobRead64Trailer>);
+        requestedSize = std::numeric_limits<uint32_t>::max();
+    }
+    requestedSize = clampReadSize(requestedSize, replySpace);
+
+    /* Like a write, a read may not run past the end of the offset space,
+     * where its next offset would wrap.
+     */
+    if (requestedSize >
+        std::numeric_limits<uint64_t>::max() - request->header.offset)
+    {
+        return ipmi::ccInvalidFieldRequest;
+    }
+
+    std::vector<uint8_t> result = mgr->read64(
+        request->header.sessionId, request->header.offset, requestedSize);
 
-    if (!result.empty())
+    reply.put(BmcBlobReadRx{.crc = 0});
+    reply.append(result);
+
+    if (autoSize)
+    {
+        BmcBlobRead64Trailer trailer;
+        trailer.nextOffset = request->header.offset + result.size();
+        trailer.flags =
+            readTrailerFlags(mgr, request->header.sessionId,
+                             trailer.nextOffset, requestedSize, result.size());
+        reply.put(trailer);
+    }
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc write64Blob(ManagerInterface* mgr, RequestBody data, ResponseWriter&)
+{
+    auto request = decodeRequest<BmcBlobWrite64Tx>(data);
+    if (!request)
     {
-        output.insert(output.end(), result.begin(), result.end());
+        return ipmi::ccReqDataLenInvalid;
     }
 
-    return ipmi::responseSuccess(output);
+    if (!mgr->write64(request->header.sessionId, request->header.offset,
+                      request->trailer))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    return ipmi::ccSuccess;
 }
 
-Resp writeBlob(ManagerInterface* mgr, std::span<const uint8_t> data)
+ipmi::Cc writeBlob(ManagerInterface* mgr, RequestBody data, ResponseWriter&)
 {
-    auto request = reinterpret_cast<const struct BmcBlobWriteTx*>(data.data());
-    data = data.subspan(sizeof(struct BmcBlobWriteTx));
+    auto request = decodeRequest<BmcBlobWriteTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
 
     /* Attempt to write the bytes. */
-    if (!mgr->write(request->sessionId, request->offset,
-                    std::vector<uint8_t>(data.begin(), data.end())))
+    if (!mgr->write(request->header.sessionId, request->header.offset,
+                    request->trailer))
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
 
-    return ipmi::responseSuccess(std::vector<uint8_t>{});
+    return ipmi::ccSuccess;
 }
 
-Resp writeMeta(ManagerInterface* mgr, std::span<const uint8_t> data)
+ipmi::Cc writeAppendBlob(ManagerInterface* mgr, RequestBody data,
+                         ResponseWriter&)
 {
-    struct BmcBlobWriteMetaTx request;
-    if (data.size() < sizeof(request))
+    auto request = decodeRequest<BmcBlobWriteAppendTx>(data);
+    if (!request)
     {
-        return ipmi::responseReqDataLenInvalid();
+        return ipmi::ccReqDataLenInvalid;
     }
 
-    /* Copy over the request. */
-    std::memcpy(&request, data.data(), sizeof(request));
+    /* Attempt to write the bytes. */
+    if (!mgr->writeAppend(request->header.sessionId, request->header.sequence,
+                          request->trailer))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
 
-    /* Nothing really else to validate, we just copy those bytes. */
-    data = data.subspan(sizeof(struct BmcBlobWriteMetaTx));
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc writeWindowedBlob(ManagerInterface* mgr, RequestBody data,
+                           ResponseWriter&)
+{
+    auto request = decodeRequest<BmcBlobWriteWindowedTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
 
     /* Attempt to write the bytes. */
-    if (!mgr->writeMeta(request.sessionId, request.offset,
-                        std::vector<uint8_t>(data.begin(), data.end())))
+    if (!mgr->writeWindowed(request->header.sessionId,
+                            request->header.sequence, request->header.offset,
+                            request->trailer))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc writeAckBlob(ManagerInterface* mgr, RequestBody data,
+                      ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobWriteAckTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    std::optional<WriteWindow> window =
+        mgr->getWriteWindow(request->header.sessionId);
+    if (!window)
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    struct BmcBlobWriteAckRx resp;
+    resp.crc = 0;
+    resp.base = window->base;
+    resp.received = window->received;
+
+    reply.put(resp);
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc getMissingBlob(ManagerInterface* mgr, RequestBody data,
+                        ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobGetMissingTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    /* next_offset is offset + length once everything is returned. */
+    if (request->header.length >
+        std::numeric_limits<uint64_t>::max() - request->header.offset)
+    {
+        return ipmi::ccInvalidFieldRequest;
+    }
+
+    size_t space = reply.remaining();
+    space -= std::min(space, wireSize<BmcBlobGetMissingRx>);
+    size_t maxRanges = std::min<size_t>(space / wireSize<BmcBlobMissingRange>,
+                                        std::numeric_limits<uint8_t>::max());
+
+    /* A reply with no room for a range can't move the query on, and the
+     * host would ask again from the same offset forever.
+     */
+    if (maxRanges == 0)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    auto missing =
+        mgr->getMissingRanges(request->header.sessionId, request->header.offset,
+                              request->header.length, maxRanges);
+    if (!missing)
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    /* If the reply is full there may be more, so continue after the last
+     * one sent.  Otherwise everything up to the end has been covered.
+     */
+    uint64_t nextOffset = request->header.offset + request->header.length;
+    if (missing->size() == maxRanges)
+    {
+        nextOffset = missing->empty()
+                         ? request->header.offset
+                         : missing->back().offset + missing->back().length;
+    }
+
+    struct BmcBlobGetMissingRx resp;
+    resp.crc = 0;
+    resp.nextOffset = nextOffset;
+    resp.count = missing->size();
+    reply.put(resp);
+
+    for (const ByteRange& range : *missing)
+    {
+        reply.put(BmcBlobMissingRange{.offset = range.offset,
+                                      .length = range.length});
+    }
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc digestBlob(ManagerInterface* mgr, RequestBody data,
+                    ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobDigestTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    auto algorithm = static_cast<DigestAlgorithm>(request->header.algorithm);
+    if (algorithm != DigestAlgorithm::crc32c &&
+        algorithm != DigestAlgorithm::sha256)
+    {
+        return ipmi::ccInvalidFieldRequest;
+    }
+
+    auto digest = mgr->digest(request->header.sessionId, algorithm,
+                              request->header.offset, request->header.length);
+    if (!digest)
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    reply.put(BmcBlobDigestRx{.crc = 0});
+    reply.append(*digest);
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc sourceChunksBlob(ManagerInterface* mgr, RequestBody data,
+                          ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobSourceChunksTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    std::span<const uint8_t> hashes = request->trailer;
+    if (hashes.empty() || hashes.size() % chunkHashSize != 0)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+    /* The chunks can't run past the end of the offset space, or the later
+     * ones would wrap around to the start of the blob.
+     */
+    size_t count = hashes.size() / chunkHashSize;
+    uint64_t span = uint64_t{request->header.chunkSize} * count;
+    if (request->header.chunkSize == 0 ||
+        span > std::numeric_limits<uint64_t>::max() - request->header.offset)
+    {
+        return ipmi::ccInvalidFieldRequest;
+    }
+
+    std::vector<ChunkHash> chunks;
+    chunks.reserve(count);
+    uint64_t offset = request->header.offset;
+    for (; !hashes.empty(); hashes = hashes.subspan(chunkHashSize))
+    {
+        chunks.push_back(ChunkHash{.offset = offset,
+                                   .length = request->header.chunkSize,
+                                   .hash = hashes.first<chunkHashSize>()});
+        offset += request->header.chunkSize;
+    }
+
+    auto sourced = mgr->sourceChunks(request->header.sessionId, chunks);
+    if (!sourced)
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    std::vector<uint8_t> bitmap((chunks.size() + 7) / 8);
+    for (size_t i = 0; i < sourced->size() && i < chunks.size(); ++i)
+    {
+        if ((*sourced)[i])
+        {
+            bitmap[i / 8] |= 1 << (i % 8);
+        }
+    }
+
+    reply.put(BmcBlobSourceChunksRx{.crc = 0});
+    reply.append(bitmap);
+    return ipmi::ccSuccess;
+}
+
+/* Split the segments after a vectored write header, or return nullopt if they
+ * don't match the count.
+ */
+static std::optional<std::vector<WriteSegment>> splitSegments(
+    uint8_t count, std::span<const uint8_t> segments)
+{
+    std::vector<WriteSegment> split;
+    split.reserve(count);
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        if (segments.size() < wireSize<BmcBlobWriteSegment>)
+        {
+            return std::nullopt;
+        }
+        auto segment = decode<BmcBlobWriteSegment>(segments);
+        segments = segments.subspan(wireSize<BmcBlobWriteSegment>);
+        if (segments.size() < segment.length)
+        {
+            return std::nullopt;
+        }
+        split.push_back(WriteSegment{.offset = segment.offset,
+                                     .data = segments.first(segment.length)});
+        segments = segments.subspan(segment.length);
+    }
+
+    if (!segments.empty())
+    {
+        return std::nullopt;
+    }
+    return split;
+}
+
+ipmi::Cc writeVectoredBlob(ManagerInterface* mgr, RequestBody data,
+                           ResponseWriter&)
+{
+    auto request = decodeRequest<BmcBlobWriteVectoredTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    auto segments = splitSegments(request->header.count, request->trailer);
+    if (!segments)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    if (!mgr->writeVectored(request->header.sessionId, *segments))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc fillBlob(ManagerInterface* mgr, RequestBody data, ResponseWriter&)
+{
+    auto request = decodeRequest<BmcBlobFillTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    if (!mgr->fill(request->header.sessionId, request->header.offset,
+                   request->header.length, request->header.pattern))
+    {
+        return ipmi::ccUnspecifiedError;
+    }
+
+    return ipmi::ccSuccess;
+}
+
+ipmi::Cc writeMeta(ManagerInterface* mgr, RequestBody data, ResponseWriter&)
+{
+    auto request = decodeRequest<BmcBlobWriteMetaTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    /* Nothing really else to validate, we just copy those bytes. */
+    if (!mgr->writeMeta(request->header.sessionId, request->header.offset,
+                        request->trailer))
     {
-        return ipmi::responseUnspecifiedError();
+        return ipmi::ccUnspecifiedError;
     }
 
-    return ipmi::responseSuccess(std::vector<uint8_t>{});
+    return ipmi::ccSuccess;
 }
 
 } // namespace blobs
@@ -1,20 +1,37 @@
 #pragma once
 
 #include "manager.hpp"
+#include "response.hpp"
+#include "wire.hpp"
 
 #include <ipmid/api.h>
 
 #include <blobs-ipmid/blobs.hpp>
 #include <ipmid/api-types.hpp>
 
+#include <optional>
 #include <span>
 #include <string>
+#include <tuple>
 #include <vector>
 
 namespace blobs
 {
 
-using Resp = ipmi::RspType<std::vector<uint8_t>>;
+/* The reply handed back to ipmid.  The payload points into the channel's
+ * response buffer.
+ */
+using Resp = ipmi::RspType<std::span<const uint8_t>>;
+
+/* The front of every request that acts on an open session. */
+struct BmcSessionHeader
+{
+    uint16_t crc;
+    uint16_t sessionId;
+
+    static constexpr auto fields =
+        std::tuple(&BmcSessionHeader::crc, &BmcSessionHeader::sessionId);
+} __attribute__((packed));
 
 /* Used by bmcBlobGetCount */
 struct BmcBlobCountTx
@@ -25,6 +42,9 @@ struct BmcBlobCountRx
 {
     uint16_t crc;
     uint32_t blobCount;
+
+    static constexpr auto fields =
+        std::tuple(&BmcBlobCountRx::crc, &BmcBlobCountRx::blobCount);
 } __attribute__((packed));
 
 /* Used by bmcBlobEnumerate */
@@ -32,11 +52,18 @@ struct BmcBlobEnumerateTx
 {
     uint16_t crc;
     uint32_t blobIdx;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobEnumerate;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobEnumerateTx::crc, &BmcBlobEnumerateTx::blobIdx);
 } __attribute__((packed));
 
 struct BmcBlobEnumerateRx
 {
     uint16_t crc;
+
+    static constexpr auto fields = std::tuple(&BmcBlobEnumerateRx::crc);
 } __attribute__((packed));
 
 /* Used by bmcBlobOpen */
@@ -44,12 +71,20 @@ struct BmcBlobOpenTx
 {
     uint16_t crc;
     uint16_t flags;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobOpen;
+    static constexpr auto trailer = Trailer::string;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobOpenTx::crc, &BmcBlobOpenTx::flags);
 } __attribute__((packed));
 
 struct BmcBlobOpenRx
 {
     uint16_t crc;
     uint16_t sessionId;
+
+    static constexpr auto fields =
+        std::tuple(&BmcBlobOpenRx::crc, &BmcBlobOpenRx::sessionId);
 } __attribute__((packed));
 
 /* Used by bmcBlobClose */
@@ -57,26 +92,43 @@ struct BmcBlobCloseTx
 {
     uint16_t crc;
     uint16_t sessionId; /* Returned from BmcBlobOpen. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobClose;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobCloseTx::crc, &BmcBlobCloseTx::sessionId);
 } __attribute__((packed));
 
 /* Used by bmcBlobDelete */
 struct BmcBlobDeleteTx
 {
     uint16_t crc;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobDelete;
+    static constexpr auto trailer = Trailer::string;
+    static constexpr auto fields = std::tuple(&BmcBlobDeleteTx::crc);
 } __attribute__((packed));
 
 /* Used by bmcBlobStat */
 struct BmcBlobStatTx
 {
     uint16_t crc;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobStat;
+    static constexpr auto trailer = Trailer::string;
+    static constexpr auto fields = std::tuple(&BmcBlobStatTx::crc);
 } __attribute__((packed));
 
 struct BmcBlobStatRx
 {
     uint16_t crc;
     uint16_t blobState;
-    uint32_t size; /* Size in bytes of the blob. */
+    uint32_t size; /* Size in bytes of the blob, 0xffffffff past 4GiB. */
     uint8_t metadataLen;
+
+    static constexpr auto fields =
+        std::tuple(&BmcBlobStatRx::crc, &BmcBlobStatRx::blobState,
+                   &BmcBlobStatRx::size, &BmcBlobStatRx::metadataLen);
 } __attribute__((packed));
 
 /* Used by bmcBlobSessionStat */
@@ -84,6 +136,11 @@ struct BmcBlobSessionStatTx
 {
     uint16_t crc;
     uint16_t sessionId;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobSessionStat;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields = std::tuple(&BmcBlobSessionStatTx::crc,
+                                              &BmcBlobSessionStatTx::sessionId);
 } __attribute__((packed));
 
 /* Used by bmcBlobCommit */
@@ -92,6 +149,12 @@ struct BmcBlobCommitTx
     uint16_t crc;
     uint16_t sessionId;
     uint8_t commitDataLen;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobCommit;
+    static constexpr auto trailer = Trailer::optionalData;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobCommitTx::crc, &BmcBlobCommitTx::sessionId,
+                   &BmcBlobCommitTx::commitDataLen);
 } __attribute__((packed));
 
 /* Used by bmcBlobRead */
@@ -101,11 +164,53 @@ struct BmcBlobReadTx
     uint16_t sessionId;
     uint32_t offset;        /* The byte sequence start, 0-based. */
     uint32_t requestedSize; /* The number of bytes requested for reading. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobRead;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobReadTx::crc, &BmcBlobReadTx::sessionId,
+                   &BmcBlobReadTx::offset, &BmcBlobReadTx::requestedSize);
 } __attribute__((packed));
 
 struct BmcBlobReadRx
 {
     uint16_t crc;
+
+    static constexpr auto fields = std::tuple(&BmcBlobReadRx::crc);
+} __attribute__((packed));
+
+/* A read with requestedSize of zero fills the reply and ends it with this
+ * trailer, after the data.
+ */
+struct BmcBlobReadTrailer
+{
+    uint32_t nextOffset; /* Where the next read should start. */
+    uint8_t flags;       /* ReadTrailerFlags */
+
+    static constexpr auto fields = std::tuple(&BmcBlobReadTrailer::nextOffset,
+                                              &BmcBlobReadTrailer::flags);
+} __attribute__((packed));
+
+enum ReadTrailerFlags
+{
+    endOfBlob = (1 << 0),
+};
+
+/* Sent instead of BmcBlobReadRx for a session opened with
+ * OpenFlags::compressedRead.  The LZ stream follows, and expands to length
+ * bytes of the blob starting at the requested offset.
+ */
+struct BmcBlobCompressedReadRx
+{
+    uint16_t crc;
+    uint32_t length;     /* Uncompressed bytes the stream covers. */
+    uint32_t nextOffset; /* Where the next read should start. */
+    uint8_t flags;       /* ReadTrailerFlags */
+
+    static constexpr auto fields = std::tuple(
+        &BmcBlobCompressedReadRx::crc, &BmcBlobCompressedReadRx::length,
+        &BmcBlobCompressedReadRx::nextOffset,
+        &BmcBlobCompressedReadRx::flags);
 } __attribute__((packed));
 
 /* Used by bmcBlobWrite */
@@ -114,6 +219,267 @@ struct BmcBlobWriteTx
     uint16_t crc;
     uint16_t sessionId;
     uint32_t offset; /* The byte sequence start, 0-based. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobWrite;
+    static constexpr auto trailer = Trailer::data;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobWriteTx::crc, &BmcBlobWriteTx::sessionId,
+                   &BmcBlobWriteTx::offset);
+} __attribute__((packed));
+
+/* Used by bmcBlobWriteAppend, which writes at the session's append cursor. */
+struct BmcBlobWriteAppendTx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+    uint8_t sequence; /* 0 for the first append, then counting up. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobWriteAppend;
+    static constexpr auto trailer = Trailer::data;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobWriteAppendTx::crc, &BmcBlobWriteAppendTx::sessionId,
+                   &BmcBlobWriteAppendTx::sequence);
+} __attribute__((packed));
+
+/* Used by bmcBlobWriteWindowed */
+struct BmcBlobWriteWindowedTx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+    uint8_t sequence; /* 0 for the first write, then counting up. */
+    uint64_t offset;  /* The byte sequence start, 0-based. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobWriteWindowed;
+    static constexpr auto trailer = Trailer::data;
+    static constexpr auto fields = std::tuple(
+        &BmcBlobWriteWindowedTx::crc, &BmcBlobWriteWindowedTx::sessionId,
+        &BmcBlobWriteWindowedTx::sequence, &BmcBlobWriteWindowedTx::offset);
+} __attribute__((packed));
+
+/* Used by bmcBlobWriteAck */
+struct BmcBlobWriteAckTx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobWriteAck;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobWriteAckTx::crc, &BmcBlobWriteAckTx::sessionId);
+} __attribute__((packed));
+
+struct BmcBlobWriteAckRx
+{
+    uint16_t crc;
+    uint8_t base;      /* Oldest sequence number that hasn't landed. */
+    uint32_t received; /* Bit i is set if base + i has landed. */
+
+    static constexpr auto fields =
+        std::tuple(&BmcBlobWriteAckRx::crc, &BmcBlobWriteAckRx::base,
+                   &BmcBlobWriteAckRx::received);
+} __attribute__((packed));
+
+/* Used by bmcBlobGetMissing */
+struct BmcBlobGetMissingTx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+    uint64_t offset; /* The first byte to look at. */
+    uint64_t length; /* The number of bytes to look at. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobGetMissing;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobGetMissingTx::crc, &BmcBlobGetMissingTx::sessionId,
+                   &BmcBlobGetMissingTx::offset, &BmcBlobGetMissingTx::length);
+} __attribute__((packed));
+
+/* The reply is followed by count BmcBlobMissingRange entries. */
+struct BmcBlobGetMissingRx
+{
+    uint16_t crc;
+    uint64_t nextOffset; /* Where to continue, the end once all are sent. */
+    uint8_t count;
+
+    static constexpr auto fields =
+        std::tuple(&BmcBlobGetMissingRx::crc, &BmcBlobGetMissingRx::nextOffset,
+                   &BmcBlobGetMissingRx::count);
+} __attribute__((packed));
+
+struct BmcBlobMissingRange
+{
+    uint64_t offset;
+    uint64_t length;
+
+    static constexpr auto fields = std::tuple(&BmcBlobMissingRange::offset,
+                                              &BmcBlobMissingRange::length);
+} __attribute__((packed));
+
+/* Used by bmcBlobWriteVectored */
+struct BmcBlobWriteVectoredTx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+    uint8_t count; /* The number of segments that follow. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobWriteVectored;
+    static constexpr auto trailer = Trailer::data;
+    static constexpr auto fields = std::tuple(
+        &BmcBlobWriteVectoredTx::crc, &BmcBlobWriteVectoredTx::sessionId,
+        &BmcBlobWriteVectoredTx::count);
+} __attribute__((packed));
+
+/* Each segment is followed by length bytes to write at offset. */
+struct BmcBlobWriteSegment
+{
+    uint64_t offset;
+    uint16_t length;
+
+    static constexpr auto fields = std::tuple(&BmcBlobWriteSegment::offset,
+                                              &BmcBlobWriteSegment::length);
+} __attribute__((packed));
+
+/* Used by bmcBlobRead64 */
+struct BmcBlobRead64Tx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+    uint64_t offset; /* The byte sequence start, 0-based. */
+    uint32_t requestedSize; /* The number of bytes requested for reading. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobRead64;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobRead64Tx::crc, &BmcBlobRead64Tx::sessionId,
+                   &BmcBlobRead64Tx::offset, &BmcBlobRead64Tx::requestedSize);
+} __attribute__((packed));
+
+/* As BmcBlobReadTrailer, for bmcBlobRead64. */
+struct BmcBlobRead64Trailer
+{
+    uint64_t nextOffset; /* Where the next read should start. */
+    uint8_t flags;       /* ReadTrailerFlags */
+
+    static constexpr auto fields = std::tuple(
+        &BmcBlobRead64Trailer::nextOffset, &BmcBlobRead64Trailer::flags);
+} __attribute__((packed));
+
+/* Used by bmcBlobWrite64 */
+struct BmcBlobWrite64Tx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+    uint64_t offset; /* The byte sequence start, 0-based. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobWrite64;
+    static constexpr auto trailer = Trailer::data;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobWrite64Tx::crc, &BmcBlobWrite64Tx::sessionId,
+                   &BmcBlobWrite64Tx::offset);
+} __attribute__((packed));
+
+/* Used by bmcBlobStat64 */
+struct BmcBlobStat64Tx
+{
+    uint16_t crc;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobStat64;
+    static constexpr auto trailer = Trailer::string;
+    static constexpr auto fields = std::tuple(&BmcBlobStat64Tx::crc);
+} __attribute__((packed));
+
+/* Used by bmcBlobSessionStat64 */
+struct BmcBlobSessionStat64Tx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobSessionStat64;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields = std::tuple(
+        &BmcBlobSessionStat64Tx::crc, &BmcBlobSessionStat64Tx::sessionId);
+} __attribute__((packed));
+
+/* The reply to both 64-bit stats, followed by the metadata. */
+struct BmcBlobStat64Rx
+{
+    uint16_t crc;
+    uint16_t blobState;
+    uint64_t size; /* Size in bytes of the blob. */
+    uint8_t metadataLen;
+
+    static constexpr auto fields =
+        std::tuple(&BmcBlobStat64Rx::crc, &BmcBlobStat64Rx::blobState,
+                   &BmcBlobStat64Rx::size, &BmcBlobStat64Rx::metadataLen);
+} __attribute__((packed));
+
+/* Used by bmcBlobDigest */
+struct BmcBlobDigestTx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+    uint8_t algorithm; /* DigestAlgorithm */
+    uint64_t offset;   /* The first byte to cover. */
+    uint64_t length;   /* The number of bytes to cover. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobDigest;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobDigestTx::crc, &BmcBlobDigestTx::sessionId,
+                   &BmcBlobDigestTx::algorithm, &BmcBlobDigestTx::offset,
+                   &BmcBlobDigestTx::length);
+} __attribute__((packed));
+
+/* The reply is followed by the digest. */
+struct BmcBlobDigestRx
+{
+    uint16_t crc;
+
+    static constexpr auto fields = std::tuple(&BmcBlobDigestRx::crc);
+} __attribute__((packed));
+
+/* Used by bmcBlobSourceChunks, followed by a SHA-256 for each chunk. */
+struct BmcBlobSourceChunksTx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+    uint64_t offset;    /* The start of the first chunk. */
+    uint32_t chunkSize; /* Each chunk starts where the last one ends. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobSourceChunks;
+    static constexpr auto trailer = Trailer::data;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobSourceChunksTx::crc,
+                   &BmcBlobSourceChunksTx::sessionId,
+                   &BmcBlobSourceChunksTx::offset,
+                   &BmcBlobSourceChunksTx::chunkSize);
+} __attribute__((packed));
+
+/* The reply is followed by a bit per chunk, least significant first, set
+ * for each chunk the BMC wrote itself.
+ */
+struct BmcBlobSourceChunksRx
+{
+    uint16_t crc;
+
+    static constexpr auto fields = std::tuple(&BmcBlobSourceChunksRx::crc);
+} __attribute__((packed));
+
+/* Used by bmcBlobFill */
+struct BmcBlobFillTx
+{
+    uint16_t crc;
+    uint16_t sessionId;
+    uint64_t offset; /* The first byte to write. */
+    uint64_t length; /* The number of bytes to write. */
+    uint8_t pattern; /* The byte written to each of them. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobFill;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobFillTx::crc, &BmcBlobFillTx::sessionId,
+                   &BmcBlobFillTx::offset, &BmcBlobFillTx::length,
+                   &BmcBlobFillTx::pattern);
 } __attribute__((packed));
 
 /* Used by bmcBlobWriteMeta */
@@ -122,8 +488,214 @@ struct BmcBlobWriteMetaTx
     uint16_t crc;
     uint16_t sessionId; /* Returned from BmcBlobOpen. */
     uint32_t offset;    /* The byte sequence start, 0-based. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobWriteMeta;
+    static constexpr auto trailer = Trailer::data;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobWriteMetaTx::crc, &BmcBlobWriteMetaTx::sessionId,
+                   &BmcBlobWriteMetaTx::offset);
+} __attribute__((packed));
+
+/* Used by bmcBlobGetCaps, which has an empty body like bmcBlobGetCount. */
+struct BmcBlobGetCapsRx
+{
+    uint16_t crc;
+    uint16_t maxTransferSize; /* The channel's max transfer size. */
+    uint16_t writeChunkSize;  /* Most data bytes one BmcBlobWrite can carry. */
+    uint16_t readChunkSize;   /* Most data bytes one BmcBlobRead can return. */
+    uint32_t extensions;      /* ProtocolExtensions */
+    uint16_t maxSessions;
+    uint16_t openSessions;
+    uint32_t sessionTimeout; /* Seconds an idle session is kept. */
+
+    static constexpr auto fields = std::tuple(
+        &BmcBlobGetCapsRx::crc, &BmcBlobGetCapsRx::maxTransferSize,
+        &BmcBlobGetCapsRx::writeChunkSize, &BmcBlobGetCapsRx::readChunkSize,
+        &BmcBlobGetCapsRx::extensions, &BmcBlobGetCapsRx::maxSessions,
+        &BmcBlobGetCapsRx::openSessions, &BmcBlobGetCapsRx::sessionTimeout);
+} __attribute__((packed));
+
+/* Used by bmcBlobBatch.  The request is followed by count entries. */
+struct BmcBlobBatchTx
+{
+    uint16_t crc;
+    uint8_t count;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobBatch;
+    static constexpr auto trailer = Trailer::data;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobBatchTx::crc, &BmcBlobBatchTx::count);
+} __attribute__((packed));
+
+/* Each entry is followed by length bytes of the sub-command's body, without
+ * its crc.
+ */
+struct BmcBlobBatchEntry
+{
+    uint8_t command;
+    uint8_t length;
+
+    static constexpr auto fields =
+        std::tuple(&BmcBlobBatchEntry::command, &BmcBlobBatchEntry::length);
+} __attribute__((packed));
+
+/* The reply is followed by count results, one per sub-command run. */
+struct BmcBlobBatchRx
+{
+    uint16_t crc;
+    uint8_t count;
+
+    static constexpr auto fields =
+        std::tuple(&BmcBlobBatchRx::crc, &BmcBlobBatchRx::count);
+} __attribute__((packed));
+
+/* Each result is followed by length bytes of the sub-command's reply, without
+ * its crc.
+ */
+struct BmcBlobBatchResult
+{
+    uint8_t completionCode;
+    uint8_t length;
+
+    static constexpr auto fields = std::tuple(
+        &BmcBlobBatchResult::completionCode, &BmcBlobBatchResult::length);
+} __attribute__((packed));
+
+/* Used by bmcBlobEnumerateRange */
+struct BmcBlobEnumerateRangeTx
+{
+    uint16_t crc;
+    uint32_t blobIdx; /* 0-based index of the first blob to retrieve. */
+    uint8_t flags;    /* EnumerateRangeFlags */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobEnumerateRange;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobEnumerateRangeTx::crc,
+                   &BmcBlobEnumerateRangeTx::blobIdx,
+                   &BmcBlobEnumerateRangeTx::flags);
+} __attribute__((packed));
+
+/* The reply is followed by count blobIds, each nul-terminated.  When front
+ * coded, each blobId is preceded by a byte giving how many leading bytes it
+ * shares with the one before it, and only the rest of it is sent.
+ */
+struct BmcBlobEnumerateRangeRx
+{
+    uint16_t crc;
+    uint32_t nextIdx; /* Index to continue from, the blob count at the end. */
+    uint32_t handle;  /* Handle of the first blobId, the rest count up. */
+    uint8_t count;
+
+    static constexpr auto fields = std::tuple(
+        &BmcBlobEnumerateRangeRx::crc, &BmcBlobEnumerateRangeRx::nextIdx,
+        &BmcBlobEnumerateRangeRx::handle, &BmcBlobEnumerateRangeRx::count);
+} __attribute__((packed));
+
+enum EnumerateRangeFlags
+{
+    frontCoded = (1 << 0),
+};
+
+/* Used by bmcBlobEnumerateStat */
+struct BmcBlobEnumerateStatTx
+{
+    uint16_t crc;
+    uint32_t blobIdx; /* 0-based index of the first blob to retrieve. */
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobEnumerateStat;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields = std::tuple(&BmcBlobEnumerateStatTx::crc,
+                                              &BmcBlobEnumerateStatTx::blobIdx);
+} __attribute__((packed));
+
+/* The reply is followed by count entries. */
+struct BmcBlobEnumerateStatRx
+{
+    uint16_t crc;
+    uint32_t nextIdx; /* Index to continue from, the blob count at the end. */
+    uint32_t handle;  /* Handle of the first blobId, the rest count up. */
+    uint8_t count;
+
+    static constexpr auto fields = std::tuple(
+        &BmcBlobEnumerateStatRx::crc, &BmcBlobEnumerateStatRx::nextIdx,
+        &BmcBlobEnumerateStatRx::handle, &BmcBlobEnumerateStatRx::count);
 } __attribute__((packed));
 
+/* Each entry is followed by its nul-terminated blobId. */
+struct BmcBlobEnumerateStatEntry
+{
+    uint8_t valid; /* 1 if the blob could be stat'd, else the rest is 0. */
+    uint16_t blobState;
+    uint32_t size; /* 0xffffffff past 4GiB. */
+
+    static constexpr auto fields =
+        std::tuple(&BmcBlobEnumerateStatEntry::valid,
+                   &BmcBlobEnumerateStatEntry::blobState,
+                   &BmcBlobEnumerateStatEntry::size);
+} __attribute__((packed));
+
+/* Used by bmcBlobOpenHandle, the handle comes from an enumerate reply. */
+struct BmcBlobOpenHandleTx
+{
+    uint16_t crc;
+    uint16_t flags;
+    uint32_t handle;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobOpenHandle;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobOpenHandleTx::crc, &BmcBlobOpenHandleTx::flags,
+                   &BmcBlobOpenHandleTx::handle);
+} __attribute__((packed));
+
+/* Used by bmcBlobStatHandle, the reply is a BmcBlobStatRx. */
+struct BmcBlobStatHandleTx
+{
+    uint16_t crc;
+    uint32_t handle;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobStatHandle;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobStatHandleTx::crc, &BmcBlobStatHandleTx::handle);
+} __attribute__((packed));
+
+/* Used by bmcBlobDeleteHandle */
+struct BmcBlobDeleteHandleTx
+{
+    uint16_t crc;
+    uint32_t handle;
+
+    static constexpr auto command = BlobOEMCommands::bmcBlobDeleteHandle;
+    static constexpr auto trailer = Trailer::none;
+    static constexpr auto fields =
+        std::tuple(&BmcBlobDeleteHandleTx::crc, &BmcBlobDeleteHandleTx::handle);
+} __attribute__((packed));
+
+/* Protocol additions beyond the base command set, reported by
+ * bmcBlobGetCaps.
+ */
+enum ProtocolExtensions
+{
+    autoSizedRead = (1 << 0),
+    batch = (1 << 1),
+    enumerateRange = (1 << 2),
+    enumerateStat = (1 << 3),
+    blobHandles = (1 << 4),
+    writeAppend = (1 << 5),
+    windowedWrite = (1 << 6),
+    missingRanges = (1 << 7),
+    compressedWrites = (1 << 8),
+    compressedReads = (1 << 9),
+    fill = (1 << 10),
+    writeVectored = (1 << 11),
+    largeBlobs = (1 << 12),
+    rangeDigest = (1 << 13),
+    sourceChunks = (1 << 14),
+    noCrcSessions = (1 << 15),
+};
+
 /**
  * Validate the minimum request length if there is one.
  *
@@ -134,18 +706,42 @@ struct BmcBlobWriteMetaTx
 bool validateRequestLength(BlobOEMCommands command, size_t requestLen);
 
 /**
- * Given a pointer into an IPMI request buffer and the length of the remaining
- * buffer, builds a string.  This does no string validation w.r.t content.
+ * Find the session a request acts on, for the commands whose request leads
+ * with a BmcSessionHeader.
  *
- * @param[in] data - Buffer containing the string.
- * @return the string if valid otherwise an empty string.
+ * @param[in] command - the command
+ * @param[in] data - the request body.
+ * @return the session id, or nullopt if the request doesn't carry one.
+ */
+std::optional<uint16_t> requestSessionId(BlobOEMCommands command,
+                                         RequestBody data);
+
+/**
+ * Limit a read to the bytes that fit in the reply after the BmcBlobReadRx
+ * header.
+ *
+ * @param[in] requestedSize - the number of bytes the host asked for.
+ * @param[in] replySpace - the bytes left in the channel's reply buffer.
+ * @return the number of bytes to ask the handler for.
+ */
+uint32_t clampReadSize(uint32_t requestedSize, size_t replySpace);
+
+/* Each command handler decodes its request from data, writes any reply body
+ * to reply and returns the IPMI completion code.
  */
-std::string stringFromBuffer(std::span<const uint8_t> data);
 
 /**
  * Writes out a BmcBlobCountRx structure and returns IPMI_OK.
  */
-Resp getBlobCount(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc getBlobCount(ManagerInterface* mgr, RequestBody data,
+                      ResponseWriter& reply);
+
+/**
+ * Writes out a BmcBlobGetCapsRx describing the caller's channel and the
+ * protocol extensions this BMC supports.
+ */
+ipmi::Cc getBlobCaps(ManagerInterface* mgr, RequestBody data,
+                     ResponseWriter& reply);
 
 /**
  * Writes out a BmcBlobEnumerateRx in response to a BmcBlobEnumerateTx
@@ -155,51 +751,178 @@ Resp getBlobCount(ManagerInterface* mgr, std::span<const uint8_t> data);
  * It will also return failure if the response buffer is of an invalid
  * length.
  */
-Resp enumerateBlob(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc enumerateBlob(ManagerInterface* mgr, RequestBody data,
+                       ResponseWriter& reply);
+
+/**
+ * Writes out a BmcBlobEnumerateRangeRx followed by as many blobIds, starting
+ * at the requested index, as fit in the reply.  Returns failure if the index
+ * does not correspond to a blob.
+ */
+ipmi::Cc enumerateBlobRange(ManagerInterface* mgr, RequestBody data,
+                            ResponseWriter& reply);
+
+/**
+ * Writes out a BmcBlobEnumerateStatRx followed by the blobId, state and size
+ * of as many blobs, starting at the requested index, as fit in the reply.
+ * Returns failure if the index does not correspond to a blob.
+ */
+ipmi::Cc enumerateStatBlob(ManagerInterface* mgr, RequestBody data,
+                           ResponseWriter& reply);
 
 /**
  * Attempts to open the blobId specified and associate with a session id.
  */
-Resp openBlob(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc openBlob(ManagerInterface* mgr, RequestBody data,
+                  ResponseWriter& reply);
+
+/**
+ * Attempts to open the blob named by a handle from an enumerate reply.
+ */
+ipmi::Cc openBlobHandle(ManagerInterface* mgr, RequestBody data,
+                        ResponseWriter& reply);
 
 /**
  * Attempts to close the session specified.
  */
-Resp closeBlob(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc closeBlob(ManagerInterface* mgr, RequestBody data,
+                   ResponseWriter& reply);
 
 /**
  * Attempts to delete the blobId specified.
  */
-Resp deleteBlob(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc deleteBlob(ManagerInterface* mgr, RequestBody data,
+                    ResponseWriter& reply);
+
+/**
+ * Attempts to delete the blob named by a handle from an enumerate reply.
+ */
+ipmi::Cc deleteBlobHandle(ManagerInterface* mgr, RequestBody data,
+                          ResponseWriter& reply);
 
 /**
  * Attempts to retrieve the Stat for the blobId specified.
  */
-Resp statBlob(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc statBlob(ManagerInterface* mgr, RequestBody data,
+                  ResponseWriter& reply);
+
+/**
+ * Attempts to retrieve the Stat for the blob named by a handle from an
+ * enumerate reply.
+ */
+ipmi::Cc statBlobHandle(ManagerInterface* mgr, RequestBody data,
+                        ResponseWriter& reply);
 
 /**
  * Attempts to retrieve the Stat for the session specified.
  */
-Resp sessionStatBlob(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc sessionStatBlob(ManagerInterface* mgr, RequestBody data,
+                         ResponseWriter& reply);
 
 /**
  * Attempts to commit the data in the blob.
  */
-Resp commitBlob(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc commitBlob(ManagerInterface* mgr, RequestBody data,
+                    ResponseWriter& reply);
 
 /**
- * Attempt to read data from the blob.
+ * Attempt to read data from the blob.  The requested size is clamped to what
+ * fits in the reply, so the host may get a short read.  A requested size of
+ * zero reads as much as fits and appends a BmcBlobReadTrailer.  A session
+ * opened with OpenFlags::compressedRead gets a BmcBlobCompressedReadRx and as
+ * much of the blob as compresses into the reply instead.
  */
-Resp readBlob(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc readBlob(ManagerInterface* mgr, RequestBody data,
+                  ResponseWriter& reply);
 
 /**
  * Attempt to write data to the blob.
  */
-Resp writeBlob(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc writeBlob(ManagerInterface* mgr, RequestBody data,
+                   ResponseWriter& reply);
+
+/**
+ * As readBlob(), at a 64-bit offset, and ending an auto-sized read with a
+ * BmcBlobRead64Trailer.  The data is never compressed.
+ */
+ipmi::Cc read64Blob(ManagerInterface* mgr, RequestBody data,
+                    ResponseWriter& reply);
+
+/**
+ * As writeBlob(), at a 64-bit offset.
+ */
+ipmi::Cc write64Blob(ManagerInterface* mgr, RequestBody data,
+                     ResponseWriter& reply);
+
+/**
+ * As statBlob(), replying with a 64-bit size.
+ */
+ipmi::Cc stat64Blob(ManagerInterface* mgr, RequestBody data,
+                    ResponseWriter& reply);
+
+/**
+ * As sessionStatBlob(), replying with a 64-bit size.
+ */
+ipmi::Cc sessionStat64Blob(ManagerInterface* mgr, RequestBody data,
+                           ResponseWriter& reply);
+
+/**
+ * Attempt to write data to the blob at the session's append cursor.
+ */
+ipmi::Cc writeAppendBlob(ManagerInterface* mgr, RequestBody data,
+                         ResponseWriter& reply);
+
+/**
+ * Attempt to write data to the blob as part of a window of writes.
+ */
+ipmi::Cc writeWindowedBlob(ManagerInterface* mgr, RequestBody data,
+                           ResponseWriter& reply);
+
+/**
+ * Writes out a BmcBlobWriteAckRx giving which of the session's windowed
+ * writes have landed.
+ */
+ipmi::Cc writeAckBlob(ManagerInterface* mgr, RequestBody data,
+                      ResponseWriter& reply);
+
+/**
+ * Writes out a BmcBlobGetMissingRx followed by as many of the runs of bytes
+ * the session hasn't written, within the requested span, as fit.
+ */
+ipmi::Cc getMissingBlob(ManagerInterface* mgr, RequestBody data,
+                        ResponseWriter& reply);
+
+/**
+ * Writes out a BmcBlobDigestRx followed by the digest of the requested span
+ * of the session's blob.
+ */
+ipmi::Cc digestBlob(ManagerInterface* mgr, RequestBody data,
+                    ResponseWriter& reply);
+
+/**
+ * Offers chunks of the blob by hash and writes out a BmcBlobSourceChunksRx
+ * followed by a bitmap of those the BMC had locally.
+ */
+ipmi::Cc sourceChunksBlob(ManagerInterface* mgr, RequestBody data,
+                          ResponseWriter& reply);
+
+/**
+ * Attempt to write several segments of the blob in one request.  Nothing is
+ * written unless every segment is well-formed.
+ */
+ipmi::Cc writeVectoredBlob(ManagerInterface* mgr, RequestBody data,
+                           ResponseWriter& reply);
+
+/**
+ * Attempt to write one byte over a span of the blob.
+ */
+ipmi::Cc fillBlob(ManagerInterface* mgr, RequestBody data,
+                  ResponseWriter& reply);
 
 /**
  * Attempt to write metadata to the blob.
  */
-Resp writeMeta(ManagerInterface* mgr, std::span<const uint8_t> data);
+ipmi::Cc writeMeta(ManagerInterface* mgr, RequestBody data,
+                   ResponseWriter& reply);
 
 } // namespace blobs
@@ -19,6 +19,7 @@
 #include "ipmi.hpp"
 #include "manager.hpp"
 #include "process.hpp"
+#include "response.hpp"
 #include "utils.hpp"
 
 #include <ipmid/api.h>
@@ -42,6 +43,30 @@ using namespace phosphor::logging;
 
 void setupBlobGlobalHandler() __attribute__((constructor));
 
+/* Whether the channel a request arrived on already guarantees its bytes.
+ * The system interface never leaves the machine.  A LAN request inside an
+ * RMCP+ session is covered by the session's integrity algorithm, which every
+ * cipher suite netipmid offers has; one outside a session isn't.
+ */
+static bool channelHasIntegrity(const ipmi::Context::ptr& ctx)
+{
+    ipmi::ChannelInfo info;
+    if (ipmi::getChannelInfo(ctx->channel, info) != ipmi::ccSuccess)
+    {
+        return false;
+    }
+
+    switch (static_cast<ipmi::EChannelMediumType>(info.mediumType))
+    {
+        case ipmi::EChannelMediumType::systemInterface:
+            return true;
+        case ipmi::EChannelMediumType::lan8032:
+            return ctx->sessionId != 0;
+        default:
+            return false;
+    }
+}
+
 void setupBlobGlobalHandler()
 {
     std::fprintf(stderr,
@@ -54,9 +79,13 @@ void setupBlobGlobalHandler()
         [](ipmi::Context::ptr ctx, uint8_t cmd,
            const std::vector<uint8_t>& data) {
             // Get current IPMI channel and get the max transfer size
-            // (assuming that it does not change).
+            // (assuming that it does not change).  The reply is built in
+            // that channel's reusable response buffer.
             return handleBlobCommand(
-                cmd, data, ipmi::getChannelMaxTransferSize(ctx->channel));
+                ctx->channel, channelHasIntegrity(ctx), cmd, data,
+                getChannelResponseBuffer(
+                    ctx->channel,
+                    ipmi::getChannelMaxTransferSize(ctx->channel)));
         });
 
     /* Install handlers. */
@@ -16,8 +16,15 @@
 
 #include "manager.hpp"
 
+#include "digest.hpp"
+#include "wire.hpp"
+
+#include <openssl/evp.h>
+
 #include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -41,12 +48,15 @@ uint32_t BlobManager::buildBlobList()
     /* Clear out the current list (IPMI handler is presently single-threaded).
      */
     ids.clear();
+    idHandlers.clear();
+    generation++;
 
     /* Grab the list of blobs and extend the local list */
     for (const auto& h : handlers)
     {
         std::vector<std::string> blobs = h->getBlobIds();
         ids.insert(ids.end(), blobs.begin(), blobs.end());
+        idHandlers.insert(idHandlers.end(), blobs.size(), h.get());
     }
 
     return ids.size();
@@ -63,11 +73,91 @@ std::string BlobManager::getBlobId(uint32_t index)
     return ids[index];
 }
 
+std::span<const std::string> BlobManager::getBlobIdRange(uint32_t index)
+{
+    /* Range check. */
+    if (index >= ids.size())
+    {
+        return {};
+    }
+
+    return std::span<const std::string>(ids).subspan(index);
+}
+
+void BlobManager::statBlobRange(uint32_t index,
+                                std::span<std::optional<BlobMeta>> metas)
+{
+    std::span<const std::string> range = getBlobIdRange(index);
+    range = range.first(std::min(range.size(), metas.size()));
+
+    /* Each handler's blobIds are contiguous in the cache, so hand each run
+     * to its handler in one call.
+     */
+    size_t start = 0;
+    while (start < range.size())
+    {
+        GenericBlobInterface* handler = idHandlers[index + start];
+        size_t end = start + 1;
+        while (end < range.size() && idHandlers[index + end] == handler)
+        {
+            end++;
+        }
+
+        handler->statBlobs(range.subspan(start, end - start),
+                           metas.subspan(start, end - start));
+        start = end;
+    }
+
+    for (auto& meta : metas.subspan(range.size()))
+    {
+        meta.reset();
+    }
+}
+
+uint32_t BlobManager::getBlobHandle(uint32_t index)
+{
+    /* Range check, the last index is held back for invalidBlobHandle. */
+    if (index >= ids.size() || index >= 0xffff)
+    {
+        return invalidBlobHandle;
+    }
+
+    return (static_cast<uint32_t>(generation) << 16) | index;
+}
+
+std::optional<size_t> BlobManager::resolveHandle(uint32_t handle) const
+{
+    size_t index = handle & 0xffff;
+    if ((handle >> 16) != generation || index >= ids.size() || index == 0xffff)
+    {
+        return std::nullopt;
+    }
+
+    return index;
+}
+
 bool BlobManager::open(uint16_t flags, const std::string& path,
                        uint16_t* session)
 {
-    GenericBlobInterface* handler = getHandler(path);
+    return openWithHandler(getHandler(path), flags, path, session);
+}
+
+bool BlobManager::openHandle(uint16_t flags, uint32_t handle,
+                             uint16_t* session)
+{
+    auto index = resolveHandle(handle);
+    if (!index)
+    {
+        return false;
+    }
 
+    return openWithHandler(idHandlers[*index], flags, ids[*index], session);
+}
+
+bool BlobManager::openWithHandler(GenericBlobInterface* handler,
+                                  uint16_t flags, const std::string& path,
+                                  uint16_t* session)
+{
     /* No handler found. */
     if (!handler)
     {
@@ -92,13 +182,18 @@ bool BlobManager::open(uint16_t flags, const std::string& path,
      * handler */
     cleanUpStaleSessions(handler);
 
-    if (!handler->open(*session, flags, path))
+    if (!handler->open(*session, flags & ~managerOpenFlags, path))
     {
         return false;
     }
 
     /* Associate session with handler */
-    sessions[*session] = SessionInfo(path, handler, flags);
+    SessionInfo& info = sessions[*session];
+    info = SessionInfo(path, handler, flags);
+    if ((flags & OpenFlags::compressedWrite) && (flags & OpenFlags::write))
+    {
+        info.decoder = std::make_unique<LzDecoder>();
+    }
     openSessions[handler].insert(*session);
     openFiles[path]++;
     return true;
@@ -118,6 +213,17 @@ bool BlobManager::stat(const std::string& path, BlobMeta* meta)
     return handler->stat(path, meta);
 }
 
+bool BlobManager::statHandle(uint32_t handle, BlobMeta* meta)
+{
+    auto index = resolveHandle(handle);
+    if (!index)
+    {
+        return false;
+    }
+
+    return idHandlers[*index]->stat(ids[*index], meta);
+}
+
 bool BlobManager::stat(uint16_t session, BlobMeta* meta)
 {
     if (auto handler = getActionHandler(session))
@@ -127,13 +233,85 @@ bool BlobManager::stat(uint16_t session, BlobMeta* meta)
     return false;
 }
 
+uint64_t BlobManager::getReadSize(uint16_t session, bool refresh)
+{
+    auto item = sessions.find(session);
+    if (item == sessions.end())
+    {
+        return 0;
+    }
+
+    SessionInfo& info = item->second;
+    if (refresh || !info.readSize)
+    {
+        BlobMeta meta{};
+        info.readSize =
+            info.handler->stat(session, &meta) ? meta.fullSize() : 0;
+    }
+    return *info.readSize;
+}
+
+std::optional<uint16_t> BlobManager::getSessionFlags(uint16_t session)
+{
+    if (auto item = sessions.find(session); item != sessions.end())
+    {
+        return item->second.flags;
+    }
+    return std::nullopt;
+}
+
+bool BlobManager::bindNoCrcChannel(uint16_t session, uint8_t channel)
+{
+    auto item = sessions.find(session);
+    if (item == sessions.end() || !(item->second.flags & OpenFlags::noCrc) ||
+        item->second.channel)
+    {
+        return false;
+    }
+    item->second.channel = channel;
+    return true;
+}
+
+std::optional<uint8_t> BlobManager::getNoCrcChannel(uint16_t session)
+{
+    if (auto item = sessions.find(session); item != sessions.end())
+    {
+        return item->second.channel;
+    }
+    return std::nullopt;
+}
+
 bool BlobManager::commit(uint16_t session, const std::vector<uint8_t>& data)
 {
-    if (auto handler = getActionHandler(session))
+    GenericBlobInterface* handler = getActionHandler(session);
+    if (!handler)
+    {
+        return false;
+    }
+
+    if (!(sessions[session].flags & OpenFlags::noCrc))
     {
         return handler->commit(session, data);
     }
-    return false;
+
+    if (data.size() < wireSize<NoCrcCommitHeader>)
+    {
+        return false;
+    }
+    if (!checkBlobCrc(session, decode<NoCrcCommitHeader>(data)))
+    {
+        return false;
+    }
+    return handler->commit(
+        session, std::vector<uint8_t>(
+                     data.begin() + wireSize<NoCrcCommitHeader>, data.end()));
+}
+
+bool BlobManager::checkBlobCrc(uint16_t session,
+                               const NoCrcCommitHeader& expected)
+{
+    auto crc = sessions[session].blobCrc.crcOf(expected.length);
+    return crc && *crc == expected.crc32c;
 }
 
 bool BlobManager::close(uint16_t session)
@@ -153,41 +331,468 @@ bool BlobManager::close(uint16_t session)
 std::vector<uint8_t> BlobManager::read(uint16_t session, uint32_t offset,
                                        uint32_t requestedSize)
 {
-    /* TODO: Currently, configure_ac isn't finding libuserlayer, w.r.t the
-     * symbols I need.
-     */
+    return read64(session, offset, requestedSize);
+}
 
-    /** The channel to use for now.
-     * TODO: We will receive this information through the IPMI message call.
-     */
-    // const int ipmiChannel = ipmi::currentChNum;
-    /** This information is transport specific.
-     * TODO: We need a way to know this dynamically.
-     * on BT, 4 bytes of header, and 1 reply code.
+std::vector<uint8_t> BlobManager::read64(uint16_t session, uint64_t offset,
+                                         uint32_t requestedSize)
+{
+    /* The caller sized requestedSize to fit its reply, so a handler that
+     * returns more is trimmed rather than failing the whole command.
      */
-    // uint32_t maxTransportSize = ipmi::getChannelMaxTransferSize(ipmiChannel);
-
     if (auto handler = getActionHandler(session, OpenFlags::read))
     {
-        return handler->read(session, offset, requestedSize);
+        std::vector<uint8_t> result =
+            handler->read64(session, offset, requestedSize);
+        if (result.size() > requestedSize)
+        {
+            result.resize(requestedSize);
+        }
+        return result;
     }
     return {};
 }
 
+/* Add a write that landed to a noCrc session's CRC32C of the blob. */
+static void foldBlobCrc(SessionInfo& info, uint64_t offset,
+                        std::span<const uint8_t> data)
+{
+    if (info.flags & OpenFlags::noCrc)
+    {
+        info.blobCrc.insert(offset, data.size(), crc32c(data));
+    }
+}
+
+/* Record bytes a write landed.  A write that would start a range past
+ * maxWrittenRanges stops the session's tracking rather than fail, and the
+ * ranges are let go.
+ */
+static void trackWritten(SessionInfo& info, uint64_t offset, uint64_t length)
+{
+    if (info.writtenOverflowed)
+    {
+        return;
+    }
+    if (info.written.size() >= maxWrittenRanges &&
+        !info.written.merges(offset, length))
+    {
+        info.writtenOverflowed = true;
+        info.written.clear();
+        return;
+    }
+    info.written.insert(offset, length);
+}
+
 bool BlobManager::write(uint16_t session, uint32_t offset,
-                        const std::vector<uint8_t>& data)
+                        std::span<const uint8_t> data)
+{
+    return write64(session, offset, data);
+}
+
+bool BlobManager::write64(uint16_t session, uint64_t offset,
+                          std::span<const uint8_t> data)
 {
+    if (data.size() > std::numeric_limits<uint64_t>::max() - offset)
+    {
+        return false;
+    }
+
     if (auto handler = getActionHandler(session, OpenFlags::write))
     {
-        return handler->write(session, offset, data);
+        SessionInfo& info = sessions[session];
+        if (!writeToHandler(handler, session, info, offset, data))
+        {
+            return false;
+        }
+        trackWritten(info, offset, data.size());
+        return true;
     }
     return false;
 }
 
+bool BlobManager::writeVectored(uint16_t session,
+                                std::span<const WriteSegment> segments)
+{
+    GenericBlobInterface* handler =
+        getActionHandler(session, OpenFlags::write);
+    if (!handler)
+    {
+        return false;
+    }
+
+    SessionInfo& info = sessions[session];
+    if (info.decoder ||
+        std::ranges::any_of(segments, [](const WriteSegment& segment) {
+            return segment.data.size() >
+                   std::numeric_limits<uint64_t>::max() - segment.offset;
+        }))
+    {
+        return false;
+    }
+
+    if (!handler->writeVectored(session, segments))
+    {
+        return false;
+    }
+
+    for (const WriteSegment& segment : segments)
+    {
+        trackWritten(info, segment.offset, segment.data.size());
+        foldBlobCrc(info, segment.offset, segment.data);
+    }
+    return true;
+}
+
+bool BlobManager::fill(uint16_t session, uint64_t offset, uint64_t length,
+                       uint8_t pattern)
+{
+    GenericBlobInterface* handler =
+        getActionHandler(session, OpenFlags::write);
+    if (!handler)
+    {
+        return false;
+    }
+
+    SessionInfo& info = sessions[session];
+    if (info.decoder || length > maxFillLength ||
+        length > std::numeric_limits<uint64_t>::max() - offset)
+    {
+        return false;
+    }
+
+    if (!handler->fill(session, offset, length, pattern))
+    {
+        return false;
+    }
+
+    trackWritten(info, offset, length);
+    if (info.flags & OpenFlags::noCrc)
+    {
+        info.blobCrc.insert(offset, length, crc32cRepeat(pattern, length));
+    }
+    return true;
+}
+
+bool BlobManager::writeAppend(uint16_t session, uint8_t sequence,
+                              std::span<const uint8_t> data)
+{
+    GenericBlobInterface* handler =
+        getActionHandler(session, OpenFlags::write);
+    if (!handler)
+    {
+        return false;
+    }
+
+    SessionInfo& info = sessions[session];
+
+    /* The host didn't see the reply to the last write and sent it again. */
+    if (info.appended &&
+        sequence == static_cast<uint8_t>(info.nextSequence - 1))
+    {
+        return true;
+    }
+
+    /* Appends carry on past 4GiB, but never wrap back to the start. */
+    uint64_t room = std::numeric_limits<uint64_t>::max() - info.appendOffset;
+    if (sequence != info.nextSequence || data.size() > room)
+    {
+        return false;
+    }
+
+    if (!writeToHandler(handler, session, info, info.appendOffset, data))
+    {
+        return false;
+    }
+
+    trackWritten(info, info.appendOffset, data.size());
+    info.appendOffset += data.size();
+    info.nextSequence++;
+    info.appended = true;
+    return true;
+}
+
+bool BlobManager::writeToHandler(GenericBlobInterface* handler,
+                                 uint16_t session, SessionInfo& info,
+                                 uint64_t offset,
+                                 std::span<const uint8_t> data)
+{
+    if (!info.decoder)
+    {
+        if (!handler->writeBytes64(session, offset, data))
+        {
+            return false;
+        }
+        foldBlobCrc(info, offset, data);
+        return true;
+    }
+
+    /* The host didn't see the reply to the last write and sent it again. */
+    if (info.lastCompressedLength != 0 &&
+        offset == info.lastCompressedOffset &&
+        data.size() == info.lastCompressedLength)
+    {
+        return true;
+    }
+
+    if (offset != info.compressedOffset)
+    {
+        return false;
+    }
+
+    info.decoded.clear();
+    if (!info.decoder->decode(data, info.decoded))
+    {
+        return false;
+    }
+
+    /* The decoder has moved on, so a retry of this write can't be expanded
+     * the same way again.
+     */
+    if (!handler->writeBytes64(session, info.decodedOffset, info.decoded))
+    {
+        info.decoder->abandon();
+        return false;
+    }
+
+    foldBlobCrc(info, info.decodedOffset, info.decoded);
+    info.lastCompressedOffset = info.compressedOffset;
+    info.lastCompressedLength = data.size();
+    info.compressedOffset += data.size();
+    info.decodedOffset += info.decoded.size();
+    return true;
+}
+
+bool BlobManager::writeWindowed(uint16_t session, uint8_t sequence,
+                                uint64_t offset, std::span<const uint8_t> data)
+{
+    GenericBlobInterface* handler =
+        getActionHandler(session, OpenFlags::write);
+    if (!handler)
+    {
+        return false;
+    }
+
+    SessionInfo& info = sessions[session];
+    WriteWindow& window = info.window;
+
+    /* A compressed stream can only be expanded in order. */
+    if (info.decoder ||
+        data.size() > std::numeric_limits<uint64_t>::max() - offset)
+    {
+        return false;
+    }
+
+    uint8_t ahead = sequence - window.base;
+    uint8_t behind = window.base - sequence;
+
+    /* The window has already moved past it, so this is a retry. */
+    if (behind > 0 && behind <= writeWindowSize && behind <= window.completed)
+    {
+        return true;
+    }
+
+    if (ahead >= writeWindowSize)
+    {
+        return false;
+    }
+
+    uint32_t bit = 1u << ahead;
+    if (window.received & bit)
+    {
+        return true;
+    }
+
+    if (!handler->writeBytes64(session, offset, data))
+    {
+        return false;
+    }
+
+    trackWritten(info, offset, data.size());
+    foldBlobCrc(info, offset, data);
+
+    /* Move the window past every sequence number that has landed. */
+    window.received |= bit;
+    while (window.received & 1)
+    {
+        window.received >>= 1;
+        window.base++;
+        window.completed++;
+    }
+    return true;
+}
+
+std::optional<WriteWindow> BlobManager::getWriteWindow(uint16_t session)
+{
+    if (!getActionHandler(session, OpenFlags::write))
+    {
+        return std::nullopt;
+    }
+
+    return sessions[session].window;
+}
+
+std::optional<std::vector<ByteRange>> BlobManager::getMissingRanges(
+    uint16_t session, uint64_t offset, uint64_t length, size_t maxRanges)
+{
+    if (!getActionHandler(session, OpenFlags::write) ||
+        length > std::numeric_limits<uint64_t>::max() - offset ||
+        sessions[session].writtenOverflowed)
+    {
+        return std::nullopt;
+    }
+
+    return sessions[session].written.gaps(offset, length, maxRanges);
+}
+
+std::optional<std::vector<uint8_t>> BlobManager::digest(
+    uint16_t session, DigestAlgorithm algorithm, uint64_t offset,
+    uint64_t length)
+{
+    GenericBlobInterface* handler = getActionHandler(session);
+    if (!handler || length > std::numeric_limits<uint64_t>::max() - offset)
+    {
+        return std::nullopt;
+    }
+
+    if (auto result = handler->digest(session, algorithm, offset, length))
+    {
+        return result;
+    }
+
+    if (length > maxDigestReadLength ||
+        !getActionHandler(session, OpenFlags::read))
+    {
+        return std::nullopt;
+    }
+
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> sha(
+        nullptr, EVP_MD_CTX_free);
+    if (algorithm == DigestAlgorithm::sha256)
+    {
+        sha.reset(EVP_MD_CTX_new());
+        if (!sha || !EVP_DigestInit_ex(sha.get(), EVP_sha256(), nullptr))
+        {
+            return std::nullopt;
+        }
+    }
+
+    uint32_t crc = 0;
+    while (length > 0)
+    {
+        uint32_t size =
+            static_cast<uint32_t>(std::min<uint64_t>(length, digestReadSize));
+        std::vector<uint8_t> chunk = handler->read64(session, offset, size);
+        if (chunk.empty())
+        {
+            return std::nullopt;
+        }
+        if (chunk.size() > size)
+        {
+            chunk.resize(size);
+        }
+
+        if (sha)
+        {
+            if (!EVP_DigestUpdate(sha.get(), chunk.data(), chunk.size()))
+            {
+                return std::nullopt;
+            }
+        }
+        else
+        {
+            crc = crc32c(chunk, crc);
+        }
+        offset += chunk.size();
+        length -= chunk.size();
+    }
+
+    switch (algorithm)
+    {
+        case DigestAlgorithm::crc32c:
+            return std::vector<uint8_t>{
+                static_cast<uint8_t>(crc), static_cast<uint8_t>(crc >> 8),
+                static_cast<uint8_t>(crc >> 16),
+                static_cast<uint8_t>(crc >> 24)};
+        case DigestAlgorithm::sha256:
+        {
+            std::vector<uint8_t> result(EVP_MAX_MD_SIZE);
+            unsigned int size = 0;
+            if (!EVP_DigestFinal_ex(sha.get(), result.data(), &size))
+            {
+                return std::nullopt;
+            }
+            result.resize(size);
+            return result;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::vector<bool>> BlobManager::sourceChunks(
+    uint16_t session, std::span<const ChunkHash> chunks)
+{
+    GenericBlobInterface* handler =
+        getActionHandler(session, OpenFlags::write);
+    if (!handler)
+    {
+        return std::nullopt;
+    }
+
+    SessionInfo& info = sessions[session];
+    if (info.decoder)
+    {
+        return std::nullopt;
+    }
+    for (const ChunkHash& chunk : chunks)
+    {
+        if (chunk.length > std::numeric_limits<uint64_t>::max() - chunk.offset)
+        {
+            return std::nullopt;
+        }
+    }
+
+    /* The handler's bytes would leave a hole in the blob's CRC32C, so the
+     * host sends them all instead.
+     */
+    if (info.flags & OpenFlags::noCrc)
+    {
+        return std::vector<bool>(chunks.size(), false);
+    }
+
+    std::vector<bool> sourced;
+    sourced.reserve(chunks.size());
+    for (const ChunkHash& chunk : chunks)
+    {
+        bool wrote = handler->sourceChunk(session, chunk.offset, chunk.length,
+                                          chunk.hash);
+        if (wrote)
+        {
+            trackWritten(info, chunk.offset, chunk.length);
+        }
+        sourced.push_back(wrote);
+    }
+    return sourced;
+}
+
 bool BlobManager::deleteBlob(const std::string& path)
 {
-    GenericBlobInterface* handler = getHandler(path);
+    return deleteWithHandler(getHandler(path), path);
+}
 
+bool BlobManager::deleteHandle(uint32_t handle)
+{
+    auto index = resolveHandle(handle);
+    if (!index)
+    {
+        return false;
+    }
+
+    return deleteWithHandler(idHandlers[*index], ids[*index]);
+}
+
+bool BlobManager::deleteWithHandler(GenericBlobInterface* handler,
+                                    const std::string& path)
+{
     /* No handler found. */
     if (!handler)
     {
@@ -205,15 +810,23 @@ bool BlobManager::deleteBlob(const std::string& path)
 }
 
 bool BlobManager::writeMeta(uint16_t session, uint32_t offset,
-                            const std::vector<uint8_t>& data)
+                            std::span<const uint8_t> data)
 {
     if (auto handler = getActionHandler(session))
     {
-        return handler->writeMeta(session, offset, data);
+        return handler->writeMetaBytes(session, offset, data);
     }
     return false;
 }
 
+SessionLimits BlobManager::getSessionLimits()
+{
+    return SessionLimits{.maxSessions = maxSessions,
+                         .openSessions =
+                             static_cast<uint16_t>(sessions.size()),
+                         .timeout = sessionTimeout};
+}
+
 bool BlobManager::getSession(uint16_t* sess)
 {
     uint16_t tries = 0;
@@ -237,7 +850,7 @@ bool BlobManager::getSession(uint16_t* sess)
             (*sess) = lsess;
             return true;
         }
-    } while (++tries < 0xffff);
+    } while (++tries < maxSessions);
 
     return false;
 }
@@ -263,6 +876,10 @@ GenericBlobInterface* BlobManager::getActionHandler(uint16_t session,
         item != sessions.end() && (item->second.flags & requiredFlags))
     {
         item->second.lastActionTime = std::chrono::steady_clock::now();
+        if (requiredFlags & OpenFlags::write)
+        {
+            item->second.readSize.reset();
+        }
         return item->second.handler;
     }
     return nullptr;
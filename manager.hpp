@@ -1,13 +1,20 @@
 #pragma once
 
+#include "blobcrc.hpp"
+#include "compress.hpp"
+#include "rangeset.hpp"
+
 #include <blobs-ipmid/blobs.hpp>
 #include <ipmid/oemrouter.hpp>
 
 #include <chrono>
 #include <ctime>
 #include <memory>
+#include <optional>
 #include <set>
+#include <span>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -17,13 +24,65 @@ namespace blobs
 using namespace std::chrono_literals;
 constexpr auto defaultSessionTimeout = 10min;
 
+/* Session ids are 16 bits, and getSession() tries each value at most once. */
+constexpr uint16_t maxSessions = 0xffff;
+
+/* The most disjoint runs of written bytes a session tracks.  A write that
+ * would start another run past this still lands, but the session stops
+ * tracking, so a host scattering tiny writes can't grow a session's
+ * bookkeeping without bound.
+ */
+constexpr size_t maxWrittenRanges = 1024;
+
+/* A blob handle is the blobId cache generation in the upper 16 bits and the
+ * index into the cache in the lower 16.  Index 0xffff is never handed out,
+ * so this is never a valid handle.
+ */
+constexpr uint32_t invalidBlobHandle = 0xffffffff;
+
+/* Open flags the manager acts on itself rather than passing to handlers. */
+constexpr uint16_t managerOpenFlags =
+    OpenFlags::compressedWrite | OpenFlags::compressedRead | OpenFlags::noCrc;
+
+/* How many sequence numbers past the oldest missing one writeWindowed()
+ * accepts.
+ */
+constexpr uint8_t writeWindowSize = 32;
+
+/* How much of the blob digest() reads at a time when the handler doesn't
+ * compute digests itself.
+ */
+constexpr uint32_t digestReadSize = 4096;
+
+/* The most bytes one digest() reads back, so a single command can't hold the
+ * channel while it reads gigabytes.
+ */
+constexpr uint64_t maxDigestReadLength = 1024 * 1024;
+
+/* The state of a session's windowed writes. */
+struct WriteWindow
+{
+    /* The oldest sequence number that hasn't landed. */
+    uint8_t base = 0;
+    /* Bit i is set if sequence number base + i has landed. */
+    uint32_t received = 0;
+    /* How many sequence numbers the window has moved past. */
+    uint32_t completed = 0;
+};
+
+struct SessionLimits
+{
+    uint16_t maxSessions;
+    uint16_t openSessions;
+    std::chrono::seconds timeout;
+};
+
 struct SessionInfo
 {
     SessionInfo() = default;
     SessionInfo(const std::string& path, GenericBlobInterface* handler,
                 uint16_t flags) : blobId(path), handler(handler), flags(flags)
     {}
-    ~SessionInfo() = default;
 
     std::string blobId;
     GenericBlobInterface* handler;
@@ -34,8 +93,62 @@ struct SessionInfo
      */
     std::chrono::time_point<std::chrono::steady_clock> lastActionTime =
         std::chrono::steady_clock::now();
+
+    /* Where the next writeAppend() lands and the sequence number it must
+     * carry.  appended is set once one has been accepted, so that a retry of
+     * it can be recognised.
+     */
+    uint64_t appendOffset = 0;
+    uint8_t nextSequence = 0;
+    bool appended = false;
+
+    WriteWindow window;
+
+    /* Every byte a write through this session has landed, unless
+     * writtenOverflowed is set, in which case it's empty.
+     */
+    RangeSet written;
+    bool writtenOverflowed = false;
+
+    /* Set for OpenFlags::compressedWrite sessions.  The offsets the host
+     * writes at are into the compressed stream, which must arrive in order.
+     */
+    std::unique_ptr<LzDecoder> decoder;
+    uint64_t compressedOffset = 0;
+    uint64_t decodedOffset = 0;
+    /* The last compressed write taken, so that a retry of it can be
+     * recognised rather than expanded again.
+     */
+    uint64_t lastCompressedOffset = 0;
+    uint64_t lastCompressedLength = 0;
+    /* Reused for each write's expansion. */
+    std::vector<uint8_t> decoded;
+
+    /* For OpenFlags::noCrc sessions, the CRC32C of each run of the blob
+     * written, put together at commit.
+     */
+    BlobCrc blobCrc;
+    /* The size getReadSize() last stat'd, if it's still good. */
+    std::optional<uint64_t> readSize;
+
+    /* For OpenFlags::noCrc sessions, the channel the session was opened on,
+     * the only one whose requests may leave out their crc.
+     */
+    std::optional<uint8_t> channel;
 };
 
+/* Leads the commit data of an OpenFlags::noCrc session, and is stripped
+ * before the rest is passed to the handler.
+ */
+struct NoCrcCommitHeader
+{
+    uint32_t crc32c; /* Of the whole blob. */
+    uint64_t length; /* The blob's length, which the CRC32C covers. */
+
+    static constexpr auto fields = std::tuple(&NoCrcCommitHeader::crc32c,
+                                              &NoCrcCommitHeader::length);
+} __attribute__((packed));
+
 class ManagerInterface
 {
   public:
@@ -48,6 +161,20 @@ class ManagerInterface
 
     virtual std::string getBlobId(uint32_t index) = 0;
 
+    virtual std::span<const std::string> getBlobIdRange(uint32_t index) = 0;
+
+    virtual void statBlobRange(uint32_t index,
+                               std::span<std::optional<BlobMeta>> metas) = 0;
+
+    virtual uint32_t getBlobHandle(uint32_t index) = 0;
+
+    virtual bool openHandle(uint16_t flags, uint32_t handle,
+                            uint16_t* session) = 0;
+
+    virtual bool statHandle(uint32_t handle, BlobMeta* meta) = 0;
+
+    virtual bool deleteHandle(uint32_t handle) = 0;
+
     virtual bool open(uint16_t flags, const std::string& path,
                       uint16_t* session) = 0;
 
@@ -55,6 +182,14 @@ class ManagerInterface
 
     virtual bool stat(uint16_t session, BlobMeta* meta) = 0;
 
+    virtual uint64_t getReadSize(uint16_t session, bool refresh) = 0;
+
+    virtual std::optional<uint16_t> getSessionFlags(uint16_t session) = 0;
+
+    virtual bool bindNoCrcChannel(uint16_t session, uint8_t channel) = 0;
+
+    virtual std::optional<uint8_t> getNoCrcChannel(uint16_t session) = 0;
+
     virtual bool commit(uint16_t session, const std::vector<uint8_t>& data) = 0;
 
     virtual bool close(uint16_t session) = 0;
@@ -63,12 +198,46 @@ class ManagerInterface
                                       uint32_t requestedSize) = 0;
 
     virtual bool write(uint16_t session, uint32_t offset,
-                       const std::vector<uint8_t>& data) = 0;
+                       std::span<const uint8_t> data) = 0;
+
+    virtual std::vector<uint8_t> read64(uint16_t session, uint64_t offset,
+                                        uint32_t requestedSize) = 0;
+
+    virtual bool write64(uint16_t session, uint64_t offset,
+                         std::span<const uint8_t> data) = 0;
+
+    virtual bool writeVectored(uint16_t session,
+                               std::span<const WriteSegment> segments) = 0;
+
+    virtual bool fill(uint16_t session, uint64_t offset, uint64_t length,
+                      uint8_t pattern) = 0;
+
+    virtual bool writeAppend(uint16_t session, uint8_t sequence,
+                             std::span<const uint8_t> data) = 0;
+
+    virtual bool writeWindowed(uint16_t session, uint8_t sequence,
+                               uint64_t offset,
+                               std::span<const uint8_t> data) = 0;
+
+    virtual std::optional<WriteWindow> getWriteWindow(uint16_t session) = 0;
+
+    virtual std::optional<std::vector<ByteRange>> getMissingRanges(
+        uint16_t session, uint64_t offset, uint64_t length,
+        size_t maxRanges) = 0;
+
+    virtual std::optional<std::vector<uint8_t>> digest(
+        uint16_t session, DigestAlgorithm algorithm, uint64_t offset,
+        uint64_t length) = 0;
+
+    virtual std::optional<std::vector<bool>> sourceChunks(
+        uint16_t session, std::span<const ChunkHash> chunks) = 0;
 
     virtual bool deleteBlob(const std::string& path) = 0;
 
     virtual bool writeMeta(uint16_t session, uint32_t offset,
-                           const std::vector<uint8_t>& data) = 0;
+                           std::span<const uint8_t> data) = 0;
+
+    virtual SessionLimits getSessionLimits() = 0;
 };
 
 /**
@@ -81,6 +250,7 @@ class BlobManager : public ManagerInterface
         sessionTimeout(sessionTimeout)
     {
         next = static_cast<uint16_t>(std::time(nullptr));
+        generation = next;
     };
 
     ~BlobManager() = default;
@@ -117,6 +287,65 @@ class BlobManager : public ManagerInterface
      */
     std::string getBlobId(uint32_t index) override;
 
+    /**
+     * Grabs the cached blobIds from index onward, without copying them.  The
+     * view is valid until the next buildBlobList().
+     *
+     * @param[in] index - the index into the blobId cache.
+     * @return the blobIds from index to the end, empty if out of range.
+     */
+    std::span<const std::string> getBlobIdRange(uint32_t index) override;
+
+    /**
+     * Stat the cached blobIds from index onward, asking each handler for all
+     * of its blobIds in the range at once.
+     *
+     * @param[in] index - the index into the blobId cache.
+     * @param[out] metas - one entry per blobId from index, empty where stat
+     *             failed or the index is past the end of the cache.
+     */
+    void statBlobRange(uint32_t index,
+                       std::span<std::optional<BlobMeta>> metas) override;
+
+    /**
+     * Grabs the handle for the indexed blobId.  Handles stay valid until the
+     * next buildBlobList().
+     *
+     * @param[in] index - the index into the blobId cache.
+     * @return the handle, or invalidBlobHandle if out of range.
+     */
+    uint32_t getBlobHandle(uint32_t index) override;
+
+    /**
+     * Like open(), but the blob is named by a handle from getBlobHandle().
+     *
+     * @param[in] flags - the flags to pass to open.
+     * @param[in] handle - the blob handle.
+     * @param[in,out] session - pointer to store the session on success.
+     * @return bool - true if able to open.
+     */
+    bool openHandle(uint16_t flags, uint32_t handle,
+                    uint16_t* session) override;
+
+    /**
+     * Like stat(path), but the blob is named by a handle from
+     * getBlobHandle().
+     *
+     * @param[in] handle - the blob handle.
+     * @param[in,out] meta - a pointer to store the metadata.
+     * @return bool - true if able to retrieve the information.
+     */
+    bool statHandle(uint32_t handle, BlobMeta* meta) override;
+
+    /**
+     * Like deleteBlob(), but the blob is named by a handle from
+     * getBlobHandle().
+     *
+     * @param[in] handle - the blob handle.
+     * @return bool - true if delete was successful.
+     */
+    bool deleteHandle(uint32_t handle) override;
+
     /**
      * Attempts to open the file specified and associates with a session.
      *
@@ -147,7 +376,50 @@ class BlobManager : public ManagerInterface
     bool stat(uint16_t session, BlobMeta* meta) override;
 
     /**
-     * Attempt to commit a blob for a given session.
+     * Return the blob's size as the session's stat reports it, for telling
+     * whether a read reached the end.  The session is stat'd the first time
+     * and the size kept, until refresh asks for it again or anything but a
+     * read through the session may have changed it.
+     *
+     * @param[in] session - the session to look up.
+     * @param[in] refresh - stat the session even if a size is kept.
+     * @return the size, or 0 if the session isn't open, can't be stat'd or
+     *         reports no size.
+     */
+    uint64_t getReadSize(uint16_t session, bool refresh) override;
+
+    /**
+     * Return the flags a session was opened with, including the ones the
+     * handler never sees.
+     *
+     * @param[in] session - the session to look up.
+     * @return the open flags, or nullopt if the session isn't open.
+     */
+    std::optional<uint16_t> getSessionFlags(uint16_t session) override;
+
+    /**
+     * Bind an OpenFlags::noCrc session to the channel it was opened on.  A
+     * session is bound at most once.
+     *
+     * @param[in] session - the session to bind.
+     * @param[in] channel - the IPMI channel the open arrived on.
+     * @return bool - true if the session is open with OpenFlags::noCrc and
+     *         wasn't already bound.
+     */
+    bool bindNoCrcChannel(uint16_t session, uint8_t channel) override;
+
+    /**
+     * Return the channel an OpenFlags::noCrc session was bound to.
+     *
+     * @param[in] session - the session to look up.
+     * @return the channel, or nullopt if the session isn't open or bound.
+     */
+    std::optional<uint8_t> getNoCrcChannel(uint16_t session) override;
+
+    /**
+     * Attempt to commit a blob for a given session.  On an OpenFlags::noCrc
+     * session the data leads with a NoCrcCommitHeader, and the handler is
+     * only asked to commit if the blob matches it.
      *
      * @param[in] session - the session for this command.
      * @param[in] data - an optional commit blob.
@@ -166,7 +438,8 @@ class BlobManager : public ManagerInterface
 
     /**
      * Attempt to read bytes from the blob.  If there's a failure, such as
-     * an invalid offset it'll just return 0 bytes.
+     * an invalid offset it'll just return 0 bytes.  Never returns more than
+     * requestedSize bytes, even if the handler does.
      *
      * @param[in] session - the session for this command.
      * @param[in] offset - the offset from which to read.
@@ -176,6 +449,17 @@ class BlobManager : public ManagerInterface
     std::vector<uint8_t> read(uint16_t session, uint32_t offset,
                               uint32_t requestedSize) override;
 
+    /**
+     * As read(), at an offset that may be past 4GiB.
+     *
+     * @param[in] session - the session for this command.
+     * @param[in] offset - the offset from which to read.
+     * @param[in] requestedSize - the number of bytes to try and read.
+     * @return the bytes read.
+     */
+    std::vector<uint8_t> read64(uint16_t session, uint64_t offset,
+                                uint32_t requestedSize) override;
+
     /**
      * Attempt to write to a blob.  The manager does not track whether
      * the session opened the file for writing.
@@ -186,7 +470,133 @@ class BlobManager : public ManagerInterface
      * @return bool - true if the write succeeded.
      */
     bool write(uint16_t session, uint32_t offset,
-               const std::vector<uint8_t>& data) override;
+               std::span<const uint8_t> data) override;
+
+    /**
+     * As write(), at an offset that may be past 4GiB.
+     *
+     * @param[in] session - the session for this command.
+     * @param[in] offset - the offset into the blob to write.
+     * @param[in] data - the bytes to write to the blob.
+     * @return bool - true if the write succeeded.
+     */
+    bool write64(uint16_t session, uint64_t offset,
+                 std::span<const uint8_t> data) override;
+
+    /**
+     * Write several runs of bytes to a blob in one handler call.  Compressed
+     * sessions are refused, since their stream must arrive in order.
+     *
+     * @param[in] session - the session for this command.
+     * @param[in] segments - the offsets and bytes to write.
+     * @return bool - true if every segment was written.
+     */
+    bool writeVectored(uint16_t session,
+                       std::span<const WriteSegment> segments) override;
+
+    /**
+     * Write the same byte over a span of the blob.  Compressed sessions are
+     * refused, since their offsets are into the stream, as are spans longer
+     * than maxFillLength.
+     *
+     * @param[in] session - the session for this command.
+     * @param[in] offset - the offset into the blob to write.
+     * @param[in] length - the number of bytes to write.
+     * @param[in] pattern - the byte to write.
+     * @return bool - true if the fill succeeded.
+     */
+    bool fill(uint16_t session, uint64_t offset, uint64_t length,
+              uint8_t pattern) override;
+
+    /**
+     * Attempt to write to a blob at the session's append cursor, which
+     * starts at zero and moves past each write.  The first append carries
+     * sequence number 0 and each after it the next, wrapping at 255.
+     * Repeating the last accepted sequence number is taken as a retry and
+     * succeeds without writing again.
+     *
+     * @param[in] session - the session for this command.
+     * @param[in] sequence - the sequence number of this write.
+     * @param[in] data - the bytes to write to the blob.
+     * @return bool - true if the write succeeded or was a retry.
+     */
+    bool writeAppend(uint16_t session, uint8_t sequence,
+                     std::span<const uint8_t> data) override;
+
+    /**
+     * Attempt to write to a blob as part of a window of writes that may
+     * arrive in any order.  The first write of a session carries sequence
+     * number 0, and a write is accepted if its sequence number is fewer than
+     * writeWindowSize past the oldest one that hasn't landed.  A sequence
+     * number that has already landed succeeds without writing again.
+     *
+     * @param[in] session - the session for this command.
+     * @param[in] sequence - the sequence number of this write.
+     * @param[in] offset - the offset into the blob to write.
+     * @param[in] data - the bytes to write to the blob.
+     * @return bool - true if the write succeeded or had already landed.
+     */
+    bool writeWindowed(uint16_t session, uint8_t sequence, uint64_t offset,
+                       std::span<const uint8_t> data) override;
+
+    /**
+     * Report which of a session's windowed writes have landed.
+     *
+     * @param[in] session - the session to check.
+     * @return the window, or nullopt if the session isn't open for writing.
+     */
+    std::optional<WriteWindow> getWriteWindow(uint16_t session) override;
+
+    /**
+     * List the runs of bytes that no write through the session has landed,
+     * so an interrupted upload can resend only those.  Once the landed bytes
+     * form maxWrittenRanges runs, a write that would start another stops the
+     * session's tracking.
+     *
+     * @param[in] session - the session to check.
+     * @param[in] offset - the first byte to look at.
+     * @param[in] length - the number of bytes to look at.
+     * @param[in] maxRanges - the most runs to return.
+     * @return the missing runs in order, or nullopt if the session isn't
+     *         open for writing or has stopped tracking.
+     */
+    std::optional<std::vector<ByteRange>> getMissingRanges(
+        uint16_t session, uint64_t offset, uint64_t length,
+        size_t maxRanges) override;
+
+    /**
+     * Compute a digest over part of the session's view of the blob, so the
+     * host can check an upload without reading it back.  The handler is
+     * asked first, and if it has no digest of its own, the bytes are read
+     * from it digestReadSize at a time.  Reading back needs a session open
+     * for reading, and covers at most maxDigestReadLength bytes.
+     *
+     * @param[in] session - the session to check.
+     * @param[in] algorithm - the digest to compute.
+     * @param[in] offset - the first byte to cover.
+     * @param[in] length - the number of bytes to cover.
+     * @return the digest, or nullopt if the session isn't open, or the
+     *         range couldn't all be read or is too long to read back.
+     */
+    std::optional<std::vector<uint8_t>> digest(
+        uint16_t session, DigestAlgorithm algorithm, uint64_t offset,
+        uint64_t length) override;
+
+    /**
+     * Offer runs of the blob by hash, so the handler can write those it
+     * holds locally and the host need only send the rest.  The runs the
+     * handler writes count as written for getMissingRanges().  Compressed
+     * sessions are refused, since their offsets are into the stream.  On a
+     * noCrc session nothing is sourced, since the handler's bytes would
+     * leave no CRC32C to check the blob by at commit.
+     *
+     * @param[in] session - the session for this command.
+     * @param[in] chunks - the runs on offer.
+     * @return for each run, whether the handler wrote it, or nullopt if the
+     *         session isn't open for writing or a run is out of range.
+     */
+    std::optional<std::vector<bool>> sourceChunks(
+        uint16_t session, std::span<const ChunkHash> chunks) override;
 
     /**
      * Attempt to delete a blobId.  This method will just call the
@@ -214,7 +624,15 @@ class BlobManager : public ManagerInterface
      * @return bool - true if the write succeeded.
      */
     bool writeMeta(uint16_t session, uint32_t offset,
-                   const std::vector<uint8_t>& data) override;
+                   std::span<const uint8_t> data) override;
+
+    /**
+     * Report how many sessions may be open, how many are, and how long an
+     * idle session lasts before it may be expired.
+     *
+     * @return the session limits.
+     */
+    SessionLimits getSessionLimits() override;
 
     /**
      * Attempts to return a valid unique session id.
@@ -225,6 +643,54 @@ class BlobManager : public ManagerInterface
     bool getSession(uint16_t* session);
 
   private:
+    /**
+     * Given a blob handle from the current generation, return its index
+     * into the blobId cache.
+     *
+     * @param[in] handle - the blob handle.
+     * @return the index, or nullopt if the handle is stale or out of range.
+     */
+    std::optional<size_t> resolveHandle(uint32_t handle) const;
+
+    /**
+     * The body of open() and openHandle(), once the handler is known.
+     */
+    bool openWithHandler(GenericBlobInterface* handler, uint16_t flags,
+                         const std::string& path, uint16_t* session);
+
+    /**
+     * Pass a write on to the session's handler, first expanding it if the
+     * session is compressed.
+     *
+     * @param[in] handler - the session's handler.
+     * @param[in] session - the session for this write.
+     * @param[in] info - the session's state.
+     * @param[in] offset - the offset the host wrote at.
+     * @param[in] data - the bytes the host wrote.
+     * @return bool - true if the handler took the write.
+     */
+    bool writeToHandler(GenericBlobInterface* handler, uint16_t session,
+                        SessionInfo& info, uint64_t offset,
+                        std::span<const uint8_t> data);
+
+    /**
+     * Check a noCrc session's blob against the CRC32C the host sent with
+     * its commit, from the CRCs of the runs written.  The blob is never read
+     * back, so runs that don't cover exactly the blob fail the check.
+     *
+     * @param[in] session - the session being committed.
+     * @param[in] expected - what the host says the blob holds.
+     * @return bool - true if the blob matches.
+     */
+    bool checkBlobCrc(uint16_t session, const NoCrcCommitHeader& expected);
+
+    /**
+     * The body of deleteBlob() and deleteHandle(), once the handler is
+     * known.
+     */
+    bool deleteWithHandler(GenericBlobInterface* handler,
+                           const std::string& path);
+
     /**
      * Given a file path will return first handler to answer that it owns
      * it.
@@ -270,6 +736,10 @@ class BlobManager : public ManagerInterface
     uint16_t next;
     /* Temporary list of blobIds used for enumeration. */
     std::vector<std::string> ids;
+    /* The handler that listed each of ids. */
+    std::vector<GenericBlobInterface*> idHandlers;
+    /* Bumped each time ids is rebuilt, so stale blob handles are refused. */
+    uint16_t generation;
     /* List of Blob handler. */
     std::vector<std::unique_ptr<GenericBlobInterface>> handlers;
     /* Mapping of session ids to blob handlers and the path used with open.
@@ -16,14 +16,17 @@
 
 #include "process.hpp"
 
+#include "crc.hpp"
 #include "ipmi.hpp"
 
-#include <ipmiblob/crc.hpp>
 #include <ipmid/api-types.hpp>
 
-#include <cstring>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <optional>
 #include <span>
-#include <unordered_map>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -37,21 +40,49 @@ struct BmcRx
     uint8_t data; /* one byte minimum of data. */
 } __attribute__((packed));
 
-static const std::unordered_map<BlobOEMCommands, IpmiBlobHandler> handlers = {
-    {BlobOEMCommands::bmcBlobGetCount, getBlobCount},
-    {BlobOEMCommands::bmcBlobEnumerate, enumerateBlob},
-    {BlobOEMCommands::bmcBlobOpen, openBlob},
-    {BlobOEMCommands::bmcBlobRead, readBlob},
-    {BlobOEMCommands::bmcBlobWrite, writeBlob},
-    {BlobOEMCommands::bmcBlobCommit, commitBlob},
-    {BlobOEMCommands::bmcBlobClose, closeBlob},
-    {BlobOEMCommands::bmcBlobDelete, deleteBlob},
-    {BlobOEMCommands::bmcBlobStat, statBlob},
-    {BlobOEMCommands::bmcBlobSessionStat, sessionStatBlob},
-    {BlobOEMCommands::bmcBlobWriteMeta, writeMeta},
-};
-
-IpmiBlobHandler validateBlobCommand(uint8_t cmd, std::span<const uint8_t> data)
+/* Indexed by command byte, unassigned commands have no handler. */
+static constexpr auto handlers = [] {
+    std::array<IpmiBlobHandler, std::numeric_limits<uint8_t>::max() + 1>
+        table{};
+    auto set = [&table](BlobOEMCommands command, IpmiBlobHandler handler) {
+        table[static_cast<uint8_t>(command)] = handler;
+    };
+
+    set(BlobOEMCommands::bmcBlobGetCount, getBlobCount);
+    set(BlobOEMCommands::bmcBlobEnumerate, enumerateBlob);
+    set(BlobOEMCommands::bmcBlobOpen, openBlob);
+    set(BlobOEMCommands::bmcBlobRead, readBlob);
+    set(BlobOEMCommands::bmcBlobWrite, writeBlob);
+    set(BlobOEMCommands::bmcBlobCommit, commitBlob);
+    set(BlobOEMCommands::bmcBlobClose, closeBlob);
+    set(BlobOEMCommands::bmcBlobDelete, deleteBlob);
+    set(BlobOEMCommands::bmcBlobStat, statBlob);
+    set(BlobOEMCommands::bmcBlobSessionStat, sessionStatBlob);
+    set(BlobOEMCommands::bmcBlobWriteMeta, writeMeta);
+    set(BlobOEMCommands::bmcBlobGetCaps, getBlobCaps);
+    set(BlobOEMCommands::bmcBlobBatch, batchBlob);
+    set(BlobOEMCommands::bmcBlobEnumerateRange, enumerateBlobRange);
+    set(BlobOEMCommands::bmcBlobEnumerateStat, enumerateStatBlob);
+    set(BlobOEMCommands::bmcBlobOpenHandle, openBlobHandle);
+    set(BlobOEMCommands::bmcBlobStatHandle, statBlobHandle);
+    set(BlobOEMCommands::bmcBlobDeleteHandle, deleteBlobHandle);
+    set(BlobOEMCommands::bmcBlobWriteAppend, writeAppendBlob);
+    set(BlobOEMCommands::bmcBlobWriteWindowed, writeWindowedBlob);
+    set(BlobOEMCommands::bmcBlobWriteAck, writeAckBlob);
+    set(BlobOEMCommands::bmcBlobGetMissing, getMissingBlob);
+    set(BlobOEMCommands::bmcBlobFill, fillBlob);
+    set(BlobOEMCommands::bmcBlobWriteVectored, writeVectoredBlob);
+    set(BlobOEMCommands::bmcBlobRead64, read64Blob);
+    set(BlobOEMCommands::bmcBlobWrite64, write64Blob);
+    set(BlobOEMCommands::bmcBlobStat64, stat64Blob);
+    set(BlobOEMCommands::bmcBlobSessionStat64, sessionStat64Blob);
+    set(BlobOEMCommands::bmcBlobDigest, digestBlob);
+    set(BlobOEMCommands::bmcBlobSourceChunks, sourceChunksBlob);
+    return table;
+}();
+
+std::pair<ipmi::Cc, IpmiBlobHandler> validateBlobCommand(
+    uint8_t cmd, std::span<const uint8_t> data)
 {
     size_t requestLength = data.size();
     /* We know dataLen is at least 1 already */
@@ -60,9 +91,7 @@ IpmiBlobHandler validateBlobCommand(uint8_t cmd, std::span<const uint8_t> data)
     /* Validate it's at least well-formed. */
     if (!validateRequestLength(command, requestLength))
     {
-        return [](ManagerInterface*, std::span<const uint8_t>) {
-            return ipmi::responseReqDataLenInvalid();
-        };
+        return {ipmi::ccReqDataLenInvalid, nullptr};
     }
 
     /* If there is a payload. */
@@ -71,76 +100,195 @@ IpmiBlobHandler validateBlobCommand(uint8_t cmd, std::span<const uint8_t> data)
         /* Verify the request includes: command, crc16, data */
         if (requestLength < sizeof(struct BmcRx))
         {
-            return [](ManagerInterface*, std::span<const uint8_t>) {
-                return ipmi::responseReqDataLenInvalid();
-            };
+            return {ipmi::ccReqDataLenInvalid, nullptr};
         }
 
-        /* We don't include the command byte at offset 0 as part of the crc
-         * payload area or the crc bytes at the beginning.
+        /* The crc covers everything that follows it in the body, so check it
+         * in place.
          */
-        size_t requestBodyLen = requestLength - 3;
+        if (!verifyCrc(data))
+        {
+            return {ipmi::ccUnspecifiedError, nullptr};
+        }
+    }
 
-        /* We start after the command byte. */
-        std::vector<uint8_t> bytes(requestBodyLen);
+    /* Grab the corresponding handler for the command. */
+    IpmiBlobHandler handler = handlers[cmd];
+    if (!handler)
+    {
+        return {ipmi::ccInvalidFieldRequest, nullptr};
+    }
 
-        /* It likely has a well-formed payload.
-         * Get the first two bytes of the request for crc.
-         */
-        uint16_t crc;
-        if (data.size() < sizeof(crc))
+    return {ipmi::ccSuccess, handler};
+}
+
+/* A sub-command's body sits right after its two byte entry header, and a
+ * handler expects its body to lead with a two byte crc it doesn't check.  So
+ * the handler is handed the body together with the entry header in place of
+ * the crc, and likewise writes its reply crc where the result header goes.
+ */
+static_assert(wireSize<BmcBlobBatchEntry> == sizeof(uint16_t));
+static_assert(wireSize<BmcBlobBatchResult> == sizeof(uint16_t));
+
+/* Split the entries after a batch header, or return nullopt if they don't
+ * match the count.
+ */
+static std::optional<std::vector<std::span<const uint8_t>>> splitBatch(
+    uint8_t count, std::span<const uint8_t> entries)
+{
+    std::vector<std::span<const uint8_t>> split;
+    split.reserve(count);
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        if (entries.size() < wireSize<BmcBlobBatchEntry>)
         {
-            return [](ManagerInterface*, std::span<const uint8_t>) {
-                return ipmi::responseReqDataLenInvalid();
-            };
+            return std::nullopt;
         }
-        std::memcpy(&crc, data.data(), sizeof(crc));
+        auto entry = decode<BmcBlobBatchEntry>(entries);
+        size_t entryLength = wireSize<BmcBlobBatchEntry> + entry.length;
+        if (entries.size() < entryLength)
+        {
+            return std::nullopt;
+        }
+        split.push_back(entries.first(entryLength));
+        entries = entries.subspan(entryLength);
+    }
 
-        /* Set the in-place CRC to zero.
-         * Remove the first two bytes for crc and get the reset of the request.
-         */
-        data = data.subspan(sizeof(crc));
+    if (!entries.empty())
+    {
+        return std::nullopt;
+    }
+    return split;
+}
 
-        /* Crc expected but didn't match. */
-        if (crc != ipmiblob::generateCrc(
-                       std::vector<uint8_t>(data.begin(), data.end())))
-        {
-            return [](ManagerInterface*, std::span<const uint8_t>) {
-                return ipmi::responseUnspecifiedError();
-            };
-        };
+/* Run one entry and return its completion code and reply length.  It has
+ * the integrity of the channel the batch arrived on.
+ */
+static std::pair<ipmi::Cc, size_t> runBatchEntry(
+    ManagerInterface* mgr, std::span<const uint8_t> entry,
+    bool channelIntegrity, std::span<uint8_t> out)
+{
+    auto header = decode<BmcBlobBatchEntry>(entry);
+    auto command = static_cast<BlobOEMCommands>(header.command);
+
+    /* The body is taken with the entry header as its crc, unless it's empty
+     * like bmcBlobGetCount's.  bmcBlobGetCaps would size its answer to the
+     * sub-reply rather than the channel, so it's refused like a nested batch.
+     */
+    std::span<const uint8_t> body =
+        header.length ? entry : std::span<const uint8_t>();
+    if (command == BlobOEMCommands::bmcBlobBatch ||
+        command == BlobOEMCommands::bmcBlobGetCaps ||
+        !handlers[header.command])
+    {
+        return {ipmi::ccInvalidFieldRequest, 0};
+    }
+    if (!validateRequestLength(command, body.size()))
+    {
+        return {ipmi::ccReqDataLenInvalid, 0};
     }
 
-    /* Grab the corresponding handler for the command. */
-    auto found = handlers.find(command);
-    if (found == handlers.end())
+    /* A result's length is one byte, which bounds the reply. */
+    size_t maxReply = wireSize<BmcBlobBatchResult> +
+                      std::numeric_limits<decltype(header.length)>::max();
+    ResponseWriter subReply(out.first(std::min(out.size(), maxReply)));
+    ipmi::Cc cc = handlers[header.command](
+        mgr, RequestBody(body, true, channelIntegrity), subReply);
+    if (cc != ipmi::ccSuccess)
     {
-        return [](ManagerInterface*, std::span<const uint8_t>) {
-            return ipmi::responseInvalidFieldRequest();
-        };
+        return {cc, 0};
+    }
+    if (subReply.overflowed())
+    {
+        return {ipmi::ccResponseError, 0};
+    }
+
+    /* Same rule as processBlobCommand, a reply is empty or leads with a crc. */
+    if (subReply.size() == 0)
+    {
+        return {ipmi::ccSuccess, 0};
+    }
+    if (subReply.size() < wireSize<BmcBlobBatchResult>)
+    {
+        return {ipmi::ccUnspecifiedError, 0};
+    }
+    return {ipmi::ccSuccess, subReply.size() - wireSize<BmcBlobBatchResult>};
+}
+
+ipmi::Cc batchBlob(ManagerInterface* mgr, RequestBody data,
+                   ResponseWriter& reply)
+{
+    auto request = decodeRequest<BmcBlobBatchTx>(data);
+    if (!request)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    /* Check every entry is well-formed before running any of them. */
+    auto entries = splitBatch(request->header.count, request->trailer);
+    if (!entries)
+    {
+        return ipmi::ccReqDataLenInvalid;
+    }
+
+    std::span<uint8_t> headerOut = reply.reserve(wireSize<BmcBlobBatchRx>);
+    if (headerOut.empty())
+    {
+        return ipmi::ccSuccess;
+    }
+
+    BmcBlobBatchRx resp;
+    resp.crc = 0;
+    resp.count = 0;
+    for (std::span<const uint8_t> entry : *entries)
+    {
+        if (reply.remaining() < wireSize<BmcBlobBatchResult>)
+        {
+            break;
+        }
+
+        auto [cc, length] = runBatchEntry(mgr, entry, data.channelIntegrity,
+                                          reply.unused());
+        std::span<uint8_t> resultOut =
+            reply.reserve(wireSize<BmcBlobBatchResult> + length);
+        encode(BmcBlobBatchResult{.completionCode = cc,
+                                  .length = static_cast<uint8_t>(length)},
+               resultOut);
+        resp.count++;
+
+        if (cc != ipmi::ccSuccess)
+        {
+            break;
+        }
     }
 
-    return found->second;
+    encode(resp, headerOut);
+    return ipmi::ccSuccess;
 }
 
 Resp processBlobCommand(IpmiBlobHandler cmd, ManagerInterface* mgr,
-                        std::span<const uint8_t> data, size_t maxSize)
+                        RequestBody data, std::span<uint8_t> response)
 {
-    Resp result = cmd(mgr, data);
-    if (std::get<0>(result) != ipmi::ccSuccess)
+    ResponseWriter reply(response);
+    ipmi::Cc cc = cmd(mgr, data, reply);
+    if (cc != ipmi::ccSuccess)
     {
-        return result;
+        return ipmi::response(cc);
+    }
+
+    /* Make sure the reply size fits the ipmi buffer */
+    if (reply.overflowed())
+    {
+        return ipmi::responseResponseError();
     }
 
-    std::vector<uint8_t>& response = std::get<0>(
-        // std::variant<std::vector<uint8_t>>
-        *std::get<1>(result));
-    size_t replyLength = response.size();
+    std::span<uint8_t> replyData = reply.data();
+    size_t replyLength = replyData.size();
 
     /* The command, whatever it was, returned success. */
     if (replyLength == 0)
     {
-        return result;
+        return ipmi::responseSuccess(std::span<const uint8_t>());
     }
 
     /* Read can return 0 bytes, and just a CRC, otherwise you need a CRC and 1
@@ -151,33 +299,153 @@ Resp processBlobCommand(IpmiBlobHandler cmd, ManagerInterface* mgr,
         return ipmi::responseUnspecifiedError();
     }
 
-    /* Make sure the reply size fits the ipmi buffer */
-    if (replyLength > maxSize)
+    /* The handler always leaves room for the crc, which is dropped here if
+     * the reply goes without one.
+     */
+    if (!data.withCrc)
     {
-        return ipmi::responseResponseError();
+        return ipmi::responseSuccess(
+            std::span<const uint8_t>(replyData.subspan(sizeof(uint16_t))));
     }
 
     /* The command, whatever it was, replied, so let's set the CRC. */
-    std::span<const uint8_t> responseView = response;
-    responseView = responseView.subspan(sizeof(uint16_t));
-    std::vector<std::uint8_t> crcBuffer(responseView.begin(),
-                                        responseView.end());
-    /* Copy the CRC into place. */
-    uint16_t crcValue = ipmiblob::generateCrc(crcBuffer);
-    if (response.size() < sizeof(crcValue))
+    if (!stampCrc(replyData))
     {
         return ipmi::responseReqDataLenInvalid();
     }
-    std::memcpy(response.data(), &crcValue, sizeof(crcValue));
 
-    return result;
+    return ipmi::responseSuccess(std::span<const uint8_t>(replyData));
 }
 
-Resp handleBlobCommand(uint8_t cmd, std::vector<uint8_t> data, size_t maxSize)
+/* Bind a session opened with OpenFlags::noCrc to the channel its open arrived
+ * on, so that only requests from there may leave out their crc.  The reply is
+ * that of a successful command, and leads with its crc or result header.
+ */
+static void bindOpenedSession(ManagerInterface* mgr, uint8_t cmd,
+                              std::span<const uint8_t> reply, uint8_t channel)
 {
-    /* on failure rc is set to the corresponding IPMI error. */
-    return processBlobCommand(validateBlobCommand(cmd, data), getBlobManager(),
-                              data, maxSize);
+    auto command = static_cast<BlobOEMCommands>(cmd);
+    if ((command != BlobOEMCommands::bmcBlobOpen &&
+         command != BlobOEMCommands::bmcBlobOpenHandle) ||
+        reply.size() < wireSize<BmcBlobOpenRx>)
+    {
+        return;
+    }
+    mgr->bindNoCrcChannel(decode<BmcBlobOpenRx>(reply).sessionId, channel);
+}
+
+/* Bind the sessions opened by a batch's entries, walking its reply alongside
+ * the entries that were run.
+ */
+static void bindBatchSessions(ManagerInterface* mgr,
+                              std::span<const uint8_t> data,
+                              std::span<const uint8_t> reply, uint8_t channel)
+{
+    auto request = decodeRequest<BmcBlobBatchTx>(data);
+    if (!request || reply.size() < wireSize<BmcBlobBatchRx>)
+    {
+        return;
+    }
+    auto entries = splitBatch(request->header.count, request->trailer);
+    if (!entries)
+    {
+        return;
+    }
+
+    auto resp = decode<BmcBlobBatchRx>(reply);
+    std::span<const uint8_t> results = reply.subspan(wireSize<BmcBlobBatchRx>);
+    for (size_t i = 0; i < resp.count && i < entries->size(); ++i)
+    {
+        if (results.size() < wireSize<BmcBlobBatchResult>)
+        {
+            return;
+        }
+        auto result = decode<BmcBlobBatchResult>(results);
+        size_t resultLength = wireSize<BmcBlobBatchResult> + result.length;
+        if (results.size() < resultLength)
+        {
+            return;
+        }
+
+        if (result.completionCode == ipmi::ccSuccess)
+        {
+            bindOpenedSession(mgr,
+                              decode<BmcBlobBatchEntry>((*entries)[i]).command,
+                              results.first(resultLength), channel);
+        }
+        results = results.subspan(resultLength);
+    }
+}
+
+/* Run a request that left out its crc, which is only accepted on a session
+ * opened with OpenFlags::noCrc on the same channel.
+ */
+static Resp handleNoCrcCommand(uint8_t channel, bool channelIntegrity,
+                               uint8_t cmd, std::span<const uint8_t> data,
+                               std::span<uint8_t> response)
+{
+    RequestBody request(data, false, channelIntegrity);
+    auto command = static_cast<BlobOEMCommands>(cmd);
+    if (!validateRequestLength(command, request.length()))
+    {
+        return ipmi::responseReqDataLenInvalid();
+    }
+
+    auto session = requestSessionId(command, request);
+    if (!session)
+    {
+        return ipmi::responseInvalidFieldRequest();
+    }
+
+    /* The session id hasn't been checked, so it's only trusted from the
+     * channel the session was opened on, as a crc mismatch would be.
+     */
+    ManagerInterface* mgr = getBlobManager();
+    if (mgr->getNoCrcChannel(*session) != channel)
+    {
+        return ipmi::responseUnspecifiedError();
+    }
+
+    return processBlobCommand(handlers[cmd], mgr, request, response);
+}
+
+Resp handleBlobCommand(uint8_t channel, bool channelIntegrity, uint8_t cmd,
+                       std::span<const uint8_t> data,
+                       std::span<uint8_t> response)
+{
+    if (cmd & noCrcCommand)
+    {
+        return handleNoCrcCommand(channel, channelIntegrity,
+                                  cmd & ~noCrcCommand, data, response);
+    }
+
+    auto [cc, handler] = validateBlobCommand(cmd, data);
+    if (cc != ipmi::ccSuccess)
+    {
+        return ipmi::response(cc);
+    }
+
+    ManagerInterface* mgr = getBlobManager();
+    Resp result = processBlobCommand(
+        handler, mgr, RequestBody(data, true, channelIntegrity), response);
+    if (std::get<0>(result) != ipmi::ccSuccess)
+    {
+        return result;
+    }
+
+    /* A batch's entries are run without a channel, so any sessions they open
+     * are bound here.
+     */
+    std::span<const uint8_t> reply = std::get<0>(*std::get<1>(result));
+    if (static_cast<BlobOEMCommands>(cmd) == BlobOEMCommands::bmcBlobBatch)
+    {
+        bindBatchSessions(mgr, data, reply, channel);
+    }
+    else
+    {
+        bindOpenedSession(mgr, cmd, reply, channel);
+    }
+    return result;
 }
 
 } // namespace blobs
@@ -2,12 +2,12 @@
 
 #include "ipmi.hpp"
 #include "manager.hpp"
+#include "response.hpp"
 
 #include <ipmid/api.h>
 
 #include <ipmid/api-types.hpp>
 
-#include <functional>
 #include <span>
 #include <utility>
 #include <vector>
@@ -15,17 +15,24 @@
 namespace blobs
 {
 
-using IpmiBlobHandler =
-    std::function<Resp(ManagerInterface* mgr, std::span<const uint8_t> data)>;
+/* Set in the command byte of a request on a session opened with
+ * OpenFlags::noCrc.  The request leaves out its crc, and so does the reply.
+ */
+constexpr uint8_t noCrcCommand = 0x80;
+
+using IpmiBlobHandler = ipmi::Cc (*)(ManagerInterface* mgr, RequestBody data,
+                                     ResponseWriter& reply);
 
 /**
  * Validate the IPMI request and determine routing.
  *
  * @param[in] cmd  Requested command
  * @param[in] data Requested data
- * @return the ipmi command handler, or nullopt on failure.
+ * @return ipmi::ccSuccess and the ipmi command handler, or the completion
+ *         code to reply with and nullptr on failure.
  */
-IpmiBlobHandler validateBlobCommand(uint8_t cmd, std::span<const uint8_t> data);
+std::pair<ipmi::Cc, IpmiBlobHandler> validateBlobCommand(
+    uint8_t cmd, std::span<const uint8_t> data);
 
 /**
  * Call the IPMI command and process the result, including running the CRC
@@ -33,16 +40,37 @@ IpmiBlobHandler validateBlobCommand(uint8_t cmd, std::span<const uint8_t> data);
  *
  * @param[in] cmd - a function pointer to the ipmi command to process.
  * @param[in] mgr - a pointer to the manager interface.
- * @param[in] data - Requested data.
- * @param[in,out] maxSize - Maximum ipmi reply size
- * @return the ipmi command result.
+ * @param[in] data - Requested data, replied to without a crc if it has none.
+ * @param[in,out] response - reply buffer, sized to the maximum ipmi reply.
+ * @return the ipmi command result, pointing into response.
  */
 Resp processBlobCommand(IpmiBlobHandler cmd, ManagerInterface* mgr,
-                        std::span<const uint8_t> data, size_t maxSize);
+                        RequestBody data, std::span<uint8_t> response);
+
+/**
+ * Run each sub-command of a BmcBlobBatchTx through the handler table and
+ * write a BmcBlobBatchRx with one result per sub-command run.  Stops at the
+ * first sub-command that fails or whose result won't fit, so later
+ * sub-commands never act on a failed earlier step.
+ */
+ipmi::Cc batchBlob(ManagerInterface* mgr, RequestBody data,
+                   ResponseWriter& reply);
 
 /**
  * Given an IPMI command, request buffer, and reply buffer, validate the request
- * and call processBlobCommand.
+ * and call processBlobCommand.  A command byte with noCrcCommand set runs
+ * without a crc either way, if it acts on a session opened with
+ * OpenFlags::noCrc on the same channel.
+ *
+ * @param[in] channel - the IPMI channel the request arrived on.
+ * @param[in] channelIntegrity - whether that channel guarantees its bytes,
+ *                               so OpenFlags::noCrc may be used on it.
+ * @param[in] cmd - the command byte.
+ * @param[in] data - Requested data.
+ * @param[in,out] response - reply buffer, sized to the maximum ipmi reply.
+ * @return the ipmi command result, pointing into response.
  */
-Resp handleBlobCommand(uint8_t cmd, std::vector<uint8_t> data, size_t maxSize);
+Resp handleBlobCommand(uint8_t channel, bool channelIntegrity, uint8_t cmd,
+                       std::span<const uint8_t> data,
+                       std::span<uint8_t> response);
 } // namespace blobs
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rangeset.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace blobs
+{
+
+void RangeSet::insert(uint64_t offset, uint64_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    uint64_t begin = offset;
+    uint64_t end = begin + length;
+
+    /* Every range from the first that reaches begin up to the first that
+     * starts past end is merged into one.
+     */
+    auto first = std::partition_point(
+        ranges.begin(), ranges.end(),
+        [begin](const auto& range) { return range.second < begin; });
+    auto last = first;
+    while (last != ranges.end() && last->first <= end)
+    {
+        begin = std::min(begin, last->first);
+        end = std::max(end, last->second);
+        ++last;
+    }
+
+    if (first == last)
+    {
+        if (ranges.empty())
+        {
+            ranges.reserve(4);
+            first = ranges.begin();
+        }
+        ranges.emplace(first, begin, end);
+        return;
+    }
+
+    *first = {begin, end};
+    ranges.erase(first + 1, last);
+}
+
+bool RangeSet::merges(uint64_t offset, uint64_t length) const
+{
+    if (length == 0)
+    {
+        return true;
+    }
+
+    auto first = std::partition_point(
+        ranges.begin(), ranges.end(),
+        [offset](const auto& range) { return range.second < offset; });
+    return first != ranges.end() && first->first <= offset + length;
+}
+
+std::vector<ByteRange> RangeSet::gaps(uint64_t offset, uint64_t length,
+                                      size_t maxRanges) const
+{
+    std::vector<ByteRange> result;
+    uint64_t cursor = offset;
+    uint64_t end = cursor + length;
+
+    auto it = std::partition_point(
+        ranges.begin(), ranges.end(),
+        [cursor](const auto& range) { return range.second <= cursor; });
+
+    while (cursor < end && result.size() < maxRanges)
+    {
+        uint64_t next =
+            (it == ranges.end()) ? end : std::min(it->first, end);
+        if (next > cursor)
+        {
+            result.push_back({cursor, next - cursor});
+        }
+
+        if (it == ranges.end())
+        {
+            break;
+        }
+        cursor = std::max(cursor, it->second);
+        ++it;
+    }
+
+    return result;
+}
+
+} // namespace blobs
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace blobs
+{
+
+/* A run of bytes within a blob. */
+struct ByteRange
+{
+    uint64_t offset;
+    uint64_t length;
+};
+
+/**
+ * A set of blob offsets kept as sorted ranges that neither overlap nor
+ * touch, so a sequential upload costs one entry however many writes it
+ * takes.  Room for a few ranges is set aside by the first insert, so a set
+ * that is never added to never allocates, and growing a range in place
+ * after that doesn't either.
+ */
+class RangeSet
+{
+  public:
+    /**
+     * Add bytes to the set, merging with any ranges they overlap or touch.
+     *
+     * @param[in] offset - the first byte.
+     * @param[in] length - the number of bytes, may be zero.
+     */
+    void insert(uint64_t offset, uint64_t length);
+
+    /**
+     * Check whether adding bytes would leave the set with no more ranges
+     * than it has, because they overlap or touch a range already in it.
+     *
+     * @param[in] offset - the first byte.
+     * @param[in] length - the number of bytes, may be zero.
+     * @return true if insert() would not add a range.
+     */
+    bool merges(uint64_t offset, uint64_t length) const;
+
+    /**
+     * List, in order, the runs of bytes that are not in the set.
+     *
+     * @param[in] offset - the first byte to look at.
+     * @param[in] length - the number of bytes to look at, which may not run
+     *            past the end of the offset space.
+     * @param[in] maxRanges - the most runs to return.
+     * @return the missing runs, clipped to the bytes looked at.
+     */
+    std::vector<ByteRange> gaps(uint64_t offset, uint64_t length,
+                                size_t maxRanges) const;
+
+    /**
+     * Empty the set and give back the memory its ranges took.
+     */
+    void clear()
+    {
+        ranges.clear();
+        ranges.shrink_to_fit();
+    }
+
+    /**
+     * @return the number of ranges the set is kept as.
+     */
+    size_t size() const
+    {
+        return ranges.size();
+    }
+
+  private:
+    /* Start to end, exclusive. */
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+};
+
+} // namespace blobs
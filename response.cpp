@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "response.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace blobs
+{
+
+bool ResponseWriter::append(std::span<const uint8_t> bytes)
+{
+    std::span<uint8_t> out = reserve(bytes.size());
+    if (out.size() != bytes.size())
+    {
+        return false;
+    }
+
+    std::copy(bytes.begin(), bytes.end(), out.begin());
+    return true;
+}
+
+std::span<uint8_t> ResponseWriter::reserve(size_t size)
+{
+    if (size > remaining())
+    {
+        overflow = true;
+        return {};
+    }
+
+    std::span<uint8_t> out = buffer.subspan(used, size);
+    used += size;
+    return out;
+}
+
+/* IPMI channel numbers are four bits wide. */
+static constexpr size_t maxChannels = 16;
+
+/* The IPMI handler is presently single-threaded, so one buffer per channel is
+ * enough.
+ */
+static std::array<std::vector<uint8_t>, maxChannels> channelBuffers;
+
+std::span<uint8_t> getChannelResponseBuffer(uint8_t channel, size_t maxSize)
+{
+    std::vector<uint8_t>& buffer = channelBuffers[channel % maxChannels];
+    if (buffer.size() < maxSize)
+    {
+        buffer.resize(maxSize);
+    }
+
+    return std::span<uint8_t>(buffer).first(maxSize);
+}
+
+} // namespace blobs
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "wire.hpp"
+
+#include <cstdint>
+#include <span>
+
+namespace blobs
+{
+
+/**
+ * Bounded writer over a caller-owned reply buffer.  A write that would run
+ * past the end of the buffer is dropped and marks the writer overflowed, so
+ * a handler can build its reply without checking every step.
+ */
+class ResponseWriter
+{
+  public:
+    explicit ResponseWriter(std::span<uint8_t> buffer) : buffer(buffer) {}
+
+    /**
+     * Encode a wire struct at the end of the reply.
+     *
+     * @param[in] value - the struct to encode.
+     * @return bool - true if it fit.
+     */
+    template <WireStruct T>
+    bool put(const T& value)
+    {
+        std::span<uint8_t> out = reserve(wireSize<T>);
+        if (out.size() != wireSize<T>)
+        {
+            return false;
+        }
+        encode(value, out);
+        return true;
+    }
+
+    /**
+     * Copy bytes to the end of the reply.
+     *
+     * @param[in] bytes - the bytes to copy.
+     * @return bool - true if they fit.
+     */
+    bool append(std::span<const uint8_t> bytes);
+
+    /**
+     * Claim the next bytes of the reply so they can be filled in place.
+     *
+     * @param[in] size - the number of bytes to claim.
+     * @return the claimed bytes, or an empty span if they don't fit.
+     */
+    std::span<uint8_t> reserve(size_t size);
+
+    /* Number of bytes written so far. */
+    size_t size() const
+    {
+        return used;
+    }
+
+    /* Size of the reply buffer, which is the channel's max transfer size. */
+    size_t capacity() const
+    {
+        return buffer.size();
+    }
+
+    /* Number of bytes that can still be written. */
+    size_t remaining() const
+    {
+        return buffer.size() - used;
+    }
+
+    /* Whether any write was dropped for lack of space. */
+    bool overflowed() const
+    {
+        return overflow;
+    }
+
+    /* The space after the reply written so far.  Bytes filled in here are
+     * only part of the reply once claimed with reserve().
+     */
+    std::span<uint8_t> unused() const
+    {
+        return buffer.subspan(used);
+    }
+
+    /* The reply written so far. */
+    std::span<uint8_t> data() const
+    {
+        return buffer.first(used);
+    }
+
+  private:
+    std::span<uint8_t> buffer;
+    size_t used = 0;
+    bool overflow = false;
+};
+
+/**
+ * Return the reply buffer for an IPMI channel, sized to maxSize.  Storage is
+ * allocated the first time a channel is seen (or its max transfer size
+ * grows) and reused by every command after that, so a reply is only valid
+ * until the next command on the same channel.
+ *
+ * @param[in] channel - the IPMI channel the request arrived on.
+ * @param[in] maxSize - the channel's max transfer size.
+ * @return the channel's reply buffer.
+ */
+std::span<uint8_t> getChannelResponseBuffer(uint8_t channel, size_t maxSize);
+
+} // namespace blobs
@@ -10,12 +10,59 @@ namespace blobs
 class BlobMock : public GenericBlobInterface
 {
   public:
+    /* The methods with a default implementation keep it unless a test sets
+     * an expectation, so a test of write() still sees the writes the
+     * defaults make through it.
+     */
+    BlobMock()
+    {
+        ON_CALL(*this, read64)
+            .WillByDefault(
+                [this](uint16_t session, uint64_t offset, uint32_t size) {
+                    return GenericBlobInterface::read64(session, offset, size);
+                });
+        ON_CALL(*this, writeBytes64)
+            .WillByDefault([this](uint16_t session, uint64_t offset,
+                                  std::span<const uint8_t> data) {
+                return GenericBlobInterface::writeBytes64(session, offset,
+                                                          data);
+            });
+        ON_CALL(*this, fill).WillByDefault(
+            [this](uint16_t session, uint64_t offset, uint64_t length,
+                   uint8_t pattern) {
+                return GenericBlobInterface::fill(session, offset, length,
+                                                  pattern);
+            });
+        ON_CALL(*this, digest)
+            .WillByDefault([this](uint16_t session, DigestAlgorithm algorithm,
+                                  uint64_t offset, uint64_t length) {
+                return GenericBlobInterface::digest(session, algorithm, offset,
+                                                    length);
+            });
+        ON_CALL(*this, sourceChunk)
+            .WillByDefault(
+                [this](uint16_t session, uint64_t offset, uint32_t length,
+                       std::span<const uint8_t, chunkHashSize> hash) {
+                    return GenericBlobInterface::sourceChunk(session, offset,
+                                                             length, hash);
+                });
+        ON_CALL(*this, writeVectored)
+            .WillByDefault([this](uint16_t session,
+                                  std::span<const WriteSegment> segments) {
+                return GenericBlobInterface::writeVectored(session, segments);
+            });
+    }
+
     virtual ~BlobMock() = default;
 
     MOCK_METHOD(bool, canHandleBlob, (const std::string&), (override));
     MOCK_METHOD(std::vector<std::string>, getBlobIds, (), (override));
     MOCK_METHOD(bool, deleteBlob, (const std::string&), (override));
     MOCK_METHOD(bool, stat, (const std::string&, BlobMeta*), (override));
+    MOCK_METHOD(void, statBlobs,
+                (std::span<const std::string>,
+                 std::span<std::optional<BlobMeta>>),
+                (override));
     MOCK_METHOD(bool, open, (uint16_t, uint16_t, const std::string&),
                 (override));
     MOCK_METHOD(std::vector<uint8_t>, read, (uint16_t, uint32_t, uint32_t),
@@ -29,5 +76,19 @@ class BlobMock : public GenericBlobInterface
     MOCK_METHOD(bool, close, (uint16_t), (override));
     MOCK_METHOD(bool, stat, (uint16_t, BlobMeta*), (override));
     MOCK_METHOD(bool, expire, (uint16_t), (override));
+    MOCK_METHOD(std::vector<uint8_t>, read64, (uint16_t, uint64_t, uint32_t),
+                (override));
+    MOCK_METHOD(bool, writeBytes64,
+                (uint16_t, uint64_t, std::span<const uint8_t>), (override));
+    MOCK_METHOD(bool, writeVectored,
+                (uint16_t, std::span<const WriteSegment>), (override));
+    MOCK_METHOD(bool, fill, (uint16_t, uint64_t, uint64_t, uint8_t),
+                (override));
+    MOCK_METHOD(std::optional<std::vector<uint8_t>>, digest,
+                (uint16_t, DigestAlgorithm, uint64_t, uint64_t), (override));
+    MOCK_METHOD(bool, sourceChunk,
+                (uint16_t, uint64_t, uint32_t,
+                 (std::span<const uint8_t, chunkHashSize>)),
+                (override));
 };
 } // namespace blobs
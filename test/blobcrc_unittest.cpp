@@ -0,0 +1,125 @@
+#include "blobcrc.hpp"
+#include "digest.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+namespace
+{
+
+/* The CRC32C of "123456789". */
+constexpr uint32_t checkCrc = 0xe3069283;
+
+constexpr std::string_view checkText = "123456789";
+
+/* Add bytes offset to offset + length of checkText to the crc. */
+void add(BlobCrc& crc, uint64_t offset, uint64_t length)
+{
+    auto text = std::span(reinterpret_cast<const uint8_t*>(checkText.data()),
+                          checkText.size());
+    crc.insert(offset, length, crc32c(text.subspan(offset, length)));
+}
+
+} // namespace
+
+TEST(BlobCrcTest, NothingWrittenIsAnEmptyBlob)
+{
+    BlobCrc crc;
+    EXPECT_EQ(0, crc.crcOf(0));
+    EXPECT_FALSE(crc.crcOf(9));
+}
+
+TEST(BlobCrcTest, InOrderRunsMakeTheBlob)
+{
+    BlobCrc crc;
+    add(crc, 0, 4);
+    add(crc, 4, 5);
+    EXPECT_EQ(checkCrc, crc.crcOf(9));
+}
+
+TEST(BlobCrcTest, RunsInAnyOrderMakeTheBlob)
+{
+    BlobCrc crc;
+    add(crc, 6, 3);
+    add(crc, 0, 2);
+    add(crc, 4, 2);
+    EXPECT_FALSE(crc.crcOf(9));
+    add(crc, 2, 2);
+    EXPECT_EQ(checkCrc, crc.crcOf(9));
+}
+
+TEST(BlobCrcTest, GapOrWrongLengthHasNoCrc)
+{
+    BlobCrc crc;
+    add(crc, 0, 4);
+    add(crc, 5, 4);
+    EXPECT_FALSE(crc.crcOf(9));
+
+    BlobCrc whole;
+    add(whole, 0, 9);
+    EXPECT_FALSE(whole.crcOf(8));
+}
+
+TEST(BlobCrcTest, RetryOfTheLastRunIsReplaced)
+{
+    BlobCrc crc;
+    add(crc, 0, 4);
+    add(crc, 4, 3);
+    add(crc, 4, 3);
+    add(crc, 7, 2);
+    add(crc, 7, 2);
+    EXPECT_EQ(checkCrc, crc.crcOf(9));
+}
+
+TEST(BlobCrcTest, OtherOverlapLosesTheCrc)
+{
+    BlobCrc crc;
+    add(crc, 0, 4);
+    add(crc, 4, 5);
+    add(crc, 2, 4);
+    EXPECT_FALSE(crc.crcOf(9));
+
+    // Once lost, it stays lost.
+    add(crc, 0, 9);
+    EXPECT_FALSE(crc.crcOf(9));
+}
+
+TEST(BlobCrcTest, RetryThatJoinedTwoRunsIsReplaced)
+{
+    BlobCrc crc;
+    add(crc, 6, 3);
+    add(crc, 0, 4);
+    add(crc, 4, 2);
+    add(crc, 4, 2);
+    EXPECT_EQ(checkCrc, crc.crcOf(9));
+}
+
+TEST(BlobCrcTest, RetryWithOtherBytesChangesTheCrc)
+{
+    BlobCrc crc;
+    add(crc, 0, 4);
+    add(crc, 4, 5);
+    crc.insert(4, 5, 0);
+    EXPECT_NE(checkCrc, crc.crcOf(9));
+    add(crc, 4, 5);
+    EXPECT_EQ(checkCrc, crc.crcOf(9));
+}
+
+TEST(BlobCrcTest, RetryOfAnEarlierRunLosesTheCrc)
+{
+    // Only the last run added to a range is remembered.
+    BlobCrc crc;
+    add(crc, 0, 4);
+    add(crc, 4, 5);
+    add(crc, 0, 4);
+    EXPECT_FALSE(crc.crcOf(9));
+}
+
+} // namespace blobs
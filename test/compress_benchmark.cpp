@@ -0,0 +1,247 @@
+/* Compares uploading representative images through compressed sessions
+ * against raw ones: how many write packets each takes on common channel
+ * sizes, and how fast the manager expands the stream.
+ */
+
+#include "compress.hpp"
+#include "ipmi.hpp"
+#include "manager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using namespace blobs;
+
+/* Takes writes and drops them, so only the manager's work is timed. */
+class SinkBlob : public GenericBlobInterface
+{
+  public:
+    bool canHandleBlob(const std::string&) override
+    {
+        return true;
+    }
+    std::vector<std::string> getBlobIds() override
+    {
+        return {"/sink"};
+    }
+    bool deleteBlob(const std::string&) override
+    {
+        return false;
+    }
+    bool stat(const std::string&, BlobMeta*) override
+    {
+        return false;
+    }
+    bool open(uint16_t, uint16_t, const std::string&) override
+    {
+        return true;
+    }
+    std::vector<uint8_t> read(uint16_t, uint32_t, uint32_t) override
+    {
+        return {};
+    }
+    bool write(uint16_t, uint32_t, const std::vector<uint8_t>&) override
+    {
+        return true;
+    }
+    bool writeBytes(uint16_t, uint32_t offset,
+                    std::span<const uint8_t> data) override
+    {
+        size = std::max<size_t>(size, offset + data.size());
+        return true;
+    }
+    bool writeMeta(uint16_t, uint32_t, const std::vector<uint8_t>&) override
+    {
+        return false;
+    }
+    bool commit(uint16_t, const std::vector<uint8_t>&) override
+    {
+        return false;
+    }
+    bool close(uint16_t) override
+    {
+        return true;
+    }
+    bool stat(uint16_t, BlobMeta*) override
+    {
+        return false;
+    }
+    bool expire(uint16_t) override
+    {
+        return true;
+    }
+
+    size_t size = 0;
+};
+
+/* JSON-like inventory, as text-heavy configuration blobs are. */
+std::vector<uint8_t> textImage(size_t size)
+{
+    std::string text;
+    for (int i = 0; text.size() < size; ++i)
+    {
+        text += "{\"name\": \"dimm" + std::to_string(i % 32) +
+                "\", \"vendor\": \"vendor" + std::to_string(i % 5) +
+                "\", \"serial\": \"" + std::to_string(i * 7919 % 100000) +
+                "\", \"present\": true},\n";
+    }
+    text.resize(size);
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+/* Firmware-like: instruction-sized words from a small vocabulary, padding
+ * and tables, with some incompressible stretches standing in for packed
+ * data.
+ */
+std::vector<uint8_t> firmwareImage(size_t size)
+{
+    std::vector<uint8_t> data;
+    uint32_t state = 0x1234567;
+    auto next = [&state] {
+        state = state * 1664525 + 1013904223;
+        return state >> 8;
+    };
+    while (data.size() < size)
+    {
+        switch (next() % 4)
+        {
+            case 0:
+            case 1:
+                for (int i = 0; i < 64; ++i)
+                {
+                    uint32_t word = 0xe5900000 | ((next() % 16) << 12) |
+                                    ((next() % 8) << 2);
+                    for (int b = 0; b < 4; ++b)
+                    {
+                        data.push_back(static_cast<uint8_t>(word >> (8 * b)));
+                    }
+                }
+                break;
+            case 2:
+                data.insert(data.end(), 128, 0xff);
+                break;
+            default:
+                for (int i = 0; i < 128; ++i)
+                {
+                    data.push_back(static_cast<uint8_t>(next()));
+                }
+                break;
+        }
+    }
+    data.resize(size);
+    return data;
+}
+
+std::vector<uint8_t> noiseImage(size_t size)
+{
+    std::vector<uint8_t> data(size);
+    uint32_t state = 0x89abcdef;
+    for (auto& byte : data)
+    {
+        state = state * 1664525 + 1013904223;
+        byte = static_cast<uint8_t>(state >> 24);
+    }
+    return data;
+}
+
+/* Upload stream through a session opened with flags, in writes of chunk
+ * bytes, and return the nanoseconds it took.
+ */
+double upload(uint16_t flags, std::span<const uint8_t> stream, size_t chunk,
+              size_t* expanded)
+{
+    BlobManager mgr;
+    auto blob = std::make_unique<SinkBlob>();
+    SinkBlob* sink = blob.get();
+    mgr.registerHandler(std::move(blob));
+
+    uint16_t session;
+    mgr.open(flags, "/sink", &session);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t offset = 0; offset < stream.size(); offset += chunk)
+    {
+        size_t n = std::min(chunk, stream.size() - offset);
+        if (!mgr.write(session, offset, stream.subspan(offset, n)))
+        {
+            std::printf("write failed at %zu\n", offset);
+            return 0;
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    *expanded = sink->size;
+    return elapsed.count();
+}
+
+} // namespace
+
+int main()
+{
+    constexpr size_t imageSize = 1024 * 1024;
+    /* The OEN and subcommand lead every request. */
+    constexpr size_t requestOverhead = 4 + wireSize<BmcBlobWriteTx>;
+    constexpr size_t channels[] = {64, 256};
+
+    struct
+    {
+        const char* name;
+        std::vector<uint8_t> data;
+    } images[] = {{"text", textImage(imageSize)},
+                  {"firmware", firmwareImage(imageSize)},
+                  {"noise", noiseImage(imageSize)}};
+
+    for (const auto& image : images)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<uint8_t> stream = lzCompress(image.data);
+        std::chrono::duration<double, std::milli> compressMs =
+            std::chrono::steady_clock::now() - start;
+
+        std::printf("%s: %zu -> %zu bytes (%.2fx), compressed in %.1f ms\n",
+                    image.name, image.data.size(), stream.size(),
+                    static_cast<double>(image.data.size()) / stream.size(),
+                    compressMs.count());
+
+        for (size_t channel : channels)
+        {
+            size_t chunk = channel - requestOverhead;
+            size_t rawPackets = (image.data.size() + chunk - 1) / chunk;
+            size_t packets = (stream.size() + chunk - 1) / chunk;
+
+            size_t rawSize = 0;
+            size_t expandedSize = 0;
+            double rawNs =
+                upload(OpenFlags::write, image.data, chunk, &rawSize);
+            double ns =
+                upload(OpenFlags::write | OpenFlags::compressedWrite, stream,
+                       chunk, &expandedSize);
+            if (expandedSize != image.data.size())
+            {
+                std::printf("  expanded to %zu bytes\n", expandedSize);
+                return 1;
+            }
+
+            /* The link, not the BMC, bounds the transfer, so the packet
+             * count is the effective speedup.
+             */
+            std::printf("  %3zu byte channel: %7zu raw packets, %7zu "
+                        "compressed (%.2fx), manager %.1f vs %.1f MB/s\n",
+                        channel, rawPackets, packets,
+                        static_cast<double>(rawPackets) / packets,
+                        rawSize * 1e3 / rawNs, expandedSize * 1e3 / ns);
+        }
+    }
+
+    return 0;
+}
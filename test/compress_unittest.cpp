@@ -0,0 +1,220 @@
+#include "compress.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+namespace
+{
+
+std::vector<uint8_t> textImage()
+{
+    std::string text;
+    for (int i = 0; i < 200; ++i)
+    {
+        text += "{\"sensor\": \"temp" + std::to_string(i % 17) +
+                "\", \"reading\": " + std::to_string(i * 7 % 101) + "},\n";
+    }
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+std::vector<uint8_t> noise(size_t size)
+{
+    std::vector<uint8_t> data(size);
+    uint32_t state = 0x12345678;
+    for (auto& byte : data)
+    {
+        state = state * 1664525 + 1013904223;
+        byte = static_cast<uint8_t>(state >> 24);
+    }
+    return data;
+}
+
+std::vector<uint8_t> roundTrip(const std::vector<uint8_t>& stream)
+{
+    LzDecoder decoder;
+    std::vector<uint8_t> out;
+    EXPECT_TRUE(decoder.decode(stream, out));
+    return out;
+}
+
+} // namespace
+
+TEST(LzTest, EmptyInputIsAnEmptyStream)
+{
+    EXPECT_TRUE(lzCompress({}).empty());
+}
+
+TEST(LzTest, TextRoundTripsAndShrinks)
+{
+    auto data = textImage();
+    auto stream = lzCompress(data);
+    EXPECT_LT(stream.size(), data.size() / 2);
+    EXPECT_EQ(data, roundTrip(stream));
+}
+
+TEST(LzTest, NoiseRoundTripsWithinTheBound)
+{
+    auto data = noise(1000);
+    auto stream = lzCompress(data);
+    EXPECT_LE(stream.size(), data.size() + data.size() / 128 + 1);
+    EXPECT_EQ(data, roundTrip(stream));
+}
+
+TEST(LzTest, ShortMatchesStayWithinTheBound)
+{
+    // Each three byte repeat sits between literals, where taking it as a
+    // match would cost more than sending it as it is.
+    std::vector<uint8_t> data;
+    for (uint8_t byte : noise(300))
+    {
+        data.insert(data.end(), {byte, 'a', 'b', 'c'});
+    }
+    auto stream = lzCompress(data);
+    EXPECT_LE(stream.size(), data.size() + data.size() / 128 + 1);
+    EXPECT_EQ(data, roundTrip(stream));
+}
+
+TEST(LzTest, RunsUseOverlappingMatches)
+{
+    std::vector<uint8_t> data(1000, 0xff);
+    auto stream = lzCompress(data);
+    EXPECT_LT(stream.size(), 40);
+    EXPECT_EQ(data, roundTrip(stream));
+}
+
+TEST(LzTest, StreamMaySplitAnywhere)
+{
+    // Feed the stream a few bytes at a time, so tokens land across calls.
+    auto data = textImage();
+    auto stream = lzCompress(data);
+
+    for (size_t chunk : {1, 2, 3, 7, 56})
+    {
+        LzDecoder decoder;
+        std::vector<uint8_t> out;
+        for (size_t i = 0; i < stream.size(); i += chunk)
+        {
+            size_t n = std::min(chunk, stream.size() - i);
+            ASSERT_TRUE(decoder.decode(
+                std::span<const uint8_t>(stream).subspan(i, n), out));
+        }
+        EXPECT_EQ(data, out);
+    }
+}
+
+TEST(LzTest, CompressIntoStopsWhenFull)
+{
+    // The stream ends on a token boundary and expands to the start of the
+    // input.
+    auto data = textImage();
+    std::vector<uint8_t> out(100);
+    size_t written = 0;
+    size_t length = lzCompressInto(data, out, &written);
+
+    EXPECT_GT(length, out.size());
+    EXPECT_LT(length, data.size());
+    EXPECT_LE(written, out.size());
+    out.resize(written);
+    EXPECT_EQ(std::vector<uint8_t>(data.begin(), data.begin() + length),
+              roundTrip(out));
+}
+
+TEST(LzTest, CompressIntoCutsLiteralRunsToFit)
+{
+    auto data = noise(1000);
+    std::vector<uint8_t> out(50);
+    size_t written = 0;
+    EXPECT_EQ(49, lzCompressInto(data, out, &written));
+    EXPECT_EQ(50, written);
+
+    // Too small for a control byte and a literal.
+    EXPECT_EQ(0, lzCompressInto(data, std::span(out).first(1), &written));
+    EXPECT_EQ(0, written);
+}
+
+TEST(LzTest, EncoderTakesTheInputInParts)
+{
+    // Each part's tail is sent as literals, but matches reach back into the
+    // earlier parts, so a stream in parts of a reasonable size still shrinks.
+    auto data = textImage();
+    for (size_t part : {1, 7, 100, 1000})
+    {
+        std::vector<uint8_t> out(data.size() * 2);
+        LzEncoder encoder(out);
+        size_t length = 0;
+        for (size_t end = 0; end < data.size();)
+        {
+            end = std::min(end + part, data.size());
+            length = encoder.encode(std::span(data).first(end));
+            ASSERT_EQ(end, length);
+        }
+        if (part >= 100)
+        {
+            EXPECT_LT(encoder.written(), data.size() / 2);
+        }
+        out.resize(encoder.written());
+        EXPECT_EQ(data, roundTrip(out));
+    }
+}
+
+TEST(LzTest, EncoderStopsWhenFull)
+{
+    // Once a part doesn't fit, later parts add nothing to the stream.
+    auto data = noise(200);
+    std::vector<uint8_t> out(120);
+    LzEncoder encoder(out);
+    EXPECT_EQ(100, encoder.encode(std::span(data).first(100)));
+    size_t length = encoder.encode(data);
+    EXPECT_LT(length, data.size());
+    size_t written = encoder.written();
+    EXPECT_EQ(length, encoder.encode(data));
+    EXPECT_EQ(written, encoder.written());
+    out.resize(written);
+    EXPECT_EQ(std::vector<uint8_t>(data.begin(), data.begin() + length),
+              roundTrip(out));
+}
+
+TEST(LzTest, MatchBeforeTheStartIsRejected)
+{
+    // A literal 'a', then a match reaching two bytes back.
+    LzDecoder decoder;
+    std::vector<uint8_t> out;
+    EXPECT_FALSE(decoder.decode(std::vector<uint8_t>{0x00, 'a', 0x80, 1, 0},
+                                out));
+
+    // Once failed, the decoder refuses the rest.
+    EXPECT_FALSE(decoder.decode(std::vector<uint8_t>{0x00, 'b'}, out));
+}
+
+TEST(LzTest, MatchPastTheWindowIsRejected)
+{
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 40; ++i)
+    {
+        stream.push_back(0x7f);
+        stream.insert(stream.end(), 128, 'x');
+    }
+    // Distance 4097.
+    stream.insert(stream.end(), {0x80, 0x00, 0x10});
+
+    LzDecoder decoder;
+    std::vector<uint8_t> out;
+    EXPECT_FALSE(decoder.decode(stream, out));
+}
+
+TEST(LzTest, AbandonedDecoderRefusesTheRest)
+{
+    LzDecoder decoder;
+    std::vector<uint8_t> out;
+    decoder.abandon();
+    EXPECT_FALSE(decoder.decode(std::vector<uint8_t>{0x00, 'a'}, out));
+}
+} // namespace blobs
@@ -0,0 +1,70 @@
+/* Compares each in-tree CRC kernel against ipmiblob::generateCrc as the
+ * command pipeline used it: copying the body into a vector on every packet.
+ */
+
+#include "crc.hpp"
+
+#include <ipmiblob/crc.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <vector>
+
+namespace
+{
+
+template <typename F>
+double nsPerCall(F&& fn, size_t iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        fn();
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+} // namespace
+
+int main()
+{
+    constexpr size_t sizes[] = {16, 64, 200, 1024, 65536};
+    /* Stores to it can't be dropped, so neither can the crcs. */
+    volatile uint16_t sink = 0;
+
+    for (size_t size : sizes)
+    {
+        std::vector<uint8_t> packet(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            packet[i] = static_cast<uint8_t>(i * 31 + 7);
+        }
+        std::span<const uint8_t> view = packet;
+        size_t iterations = (64 * 1024 * 1024) / size;
+
+        double legacy = nsPerCall(
+            [&] {
+                sink = ipmiblob::generateCrc(
+                    std::vector<uint8_t>(view.begin(), view.end()));
+            },
+            iterations);
+
+        std::printf("%zu bytes\n", size);
+        std::printf("  %-12s %12.1f ns/op %10.1f MB/s\n", "ipmiblob", legacy,
+                    size * 1e3 / legacy);
+
+        for (const auto& kernel : blobs::getCrcKernels())
+        {
+            double ns = nsPerCall([&] { sink = kernel.generate(view); },
+                                  iterations);
+            std::printf("  %-12s %12.1f ns/op %10.1f MB/s %8.1fx\n",
+                        kernel.name, ns, size * 1e3 / ns, legacy / ns);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "crc.hpp"
+
+#include <ipmiblob/crc.hpp>
+
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+TEST(CrcTest, KnownCheckValue)
+{
+    // The standard CRC-16-CCITT check string, augmented with 0xffff.
+    constexpr std::string_view check = "123456789";
+    std::vector<uint8_t> data(check.begin(), check.end());
+
+    EXPECT_EQ(0xe5cc, generateCrc(data));
+}
+
+TEST(CrcTest, EmptyBufferMatchesIpmiblob)
+{
+    std::vector<uint8_t> data;
+
+    EXPECT_EQ(ipmiblob::generateCrc(data), generateCrc(data));
+}
+
+TEST(CrcTest, MatchesIpmiblobForAllPacketSizes)
+{
+    // Walk every length up to a large IPMI packet with random content.
+    std::mt19937 gen(0x1021);
+    std::uniform_int_distribution<unsigned int> dist(0, 0xff);
+
+    for (size_t len = 1; len <= 256; ++len)
+    {
+        std::vector<uint8_t> data(len);
+        for (auto& b : data)
+        {
+            b = static_cast<uint8_t>(dist(gen));
+        }
+
+        EXPECT_EQ(ipmiblob::generateCrc(data), generateCrc(data))
+            << "length " << len;
+    }
+}
+
+TEST(CrcTest, EveryKernelMatchesIpmiblob)
+{
+    // Each kernel must be bit-exact with the reference at every length and
+    // alignment, including the tails the folding kernels hand to the tables.
+    std::mt19937 gen(0x1d0f);
+    std::uniform_int_distribution<unsigned int> dist(0, 0xff);
+
+    std::vector<uint8_t> buffer(1024 + 16);
+    for (auto& b : buffer)
+    {
+        b = static_cast<uint8_t>(dist(gen));
+    }
+
+    ASSERT_FALSE(getCrcKernels().empty());
+    for (const auto& kernel : getCrcKernels())
+    {
+        for (size_t offset = 0; offset < 16; offset += 3)
+        {
+            for (size_t len = 0; len <= 1024; len += (len < 300) ? 1 : 61)
+            {
+                std::span<const uint8_t> view(buffer.data() + offset, len);
+                std::vector<uint8_t> copy(view.begin(), view.end());
+
+                EXPECT_EQ(ipmiblob::generateCrc(copy), kernel.generate(view))
+                    << kernel.name << " offset " << offset << " length "
+                    << len;
+            }
+        }
+    }
+}
+
+TEST(CrcTest, PortableKernelsAlwaysAvailable)
+{
+    auto kernels = getCrcKernels();
+
+    ASSERT_GE(kernels.size(), 2);
+    EXPECT_STREQ("bytewise", kernels[0].name);
+    EXPECT_STREQ("slice-by-8", kernels[1].name);
+}
+
+TEST(CrcTest, VerifyRejectsShortBody)
+{
+    std::vector<uint8_t> body = {0x00};
+
+    EXPECT_FALSE(verifyCrc(body));
+}
+
+TEST(CrcTest, VerifyChecksLeadingLittleEndianCrc)
+{
+    std::vector<uint8_t> payload = {0x54, 0x00, 0x00, 0x01, 0x66, 0x67};
+    uint16_t crc = ipmiblob::generateCrc(payload);
+
+    std::vector<uint8_t> body = {static_cast<uint8_t>(crc & 0xff),
+                                 static_cast<uint8_t>(crc >> 8)};
+    body.insert(body.end(), payload.begin(), payload.end());
+    EXPECT_TRUE(verifyCrc(body));
+
+    body[0] ^= 0x01;
+    EXPECT_FALSE(verifyCrc(body));
+}
+
+TEST(CrcTest, StampWritesCrcInPlace)
+{
+    std::vector<uint8_t> body = {0xaa, 0xbb, 0x11, 0x22, 0x33};
+    uint16_t crc =
+        ipmiblob::generateCrc(std::vector<uint8_t>{0x11, 0x22, 0x33});
+
+    EXPECT_TRUE(stampCrc(body));
+    EXPECT_EQ(crc & 0xff, body[0]);
+    EXPECT_EQ(crc >> 8, body[1]);
+    EXPECT_TRUE(verifyCrc(body));
+}
+
+TEST(CrcTest, StampRejectsShortBody)
+{
+    std::vector<uint8_t> body = {0xaa};
+
+    EXPECT_FALSE(stampCrc(body));
+    EXPECT_EQ(0xaa, body[0]);
+}
+
+} // namespace blobs
@@ -0,0 +1,360 @@
+#include "example/delta.hpp"
+
+#include <openssl/evp.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+namespace blobs
+{
+
+namespace
+{
+
+std::array<uint8_t, deltaShaSize> sha256(const std::vector<uint8_t>& data)
+{
+    std::array<uint8_t, deltaShaSize> digest{};
+    EVP_Digest(data.data(), data.size(), digest.data(), nullptr, EVP_sha256(),
+               nullptr);
+    return digest;
+}
+
+/* Builds a patch, little-endian as the handler expects. */
+class Patch
+{
+  public:
+    Patch(uint64_t baseSize, uint64_t targetSize,
+          const std::array<uint8_t, deltaShaSize>& baseSha256,
+          const std::array<uint8_t, deltaShaSize>& targetSha256)
+    {
+        bytes.assign(std::begin(deltaMagic), std::end(deltaMagic));
+        put(baseSize, 8);
+        put(targetSize, 8);
+        bytes.insert(bytes.end(), baseSha256.begin(), baseSha256.end());
+        bytes.insert(bytes.end(), targetSha256.begin(), targetSha256.end());
+    }
+
+    Patch& copy(uint64_t baseOffset, uint32_t length)
+    {
+        bytes.push_back(static_cast<uint8_t>(DeltaOp::copy));
+        put(baseOffset, 8);
+        put(length, 4);
+        return *this;
+    }
+
+    Patch& insert(const std::vector<uint8_t>& data)
+    {
+        bytes.push_back(static_cast<uint8_t>(DeltaOp::insert));
+        put(data.size(), 4);
+        bytes.insert(bytes.end(), data.begin(), data.end());
+        return *this;
+    }
+
+    void put(uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+};
+
+} // namespace
+
+class DeltaBlobTest : public ::testing::Test
+{
+  protected:
+    DeltaBlobTest() :
+        dir(fs::temp_directory_path() /
+            ("delta_unittest." + std::to_string(::getpid()))),
+        image{"bios", (dir / "base").string(), (dir / "target").string()},
+        handler({image})
+    {
+        fs::create_directories(dir);
+        base = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'};
+        std::ofstream(image.basePath, std::ios::binary)
+            .write(reinterpret_cast<const char*>(base.data()), base.size());
+    }
+
+    ~DeltaBlobTest() override
+    {
+        fs::remove_all(dir);
+    }
+
+    std::vector<uint8_t> readFile(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), {});
+    }
+
+    /* Stat the session until it is no longer committing. */
+    uint16_t pollUntilDone()
+    {
+        BlobMeta meta;
+        for (int i = 0; i < 100; ++i)
+        {
+            EXPECT_TRUE(handler.stat(session, &meta));
+            if (!(meta.blobState & StateFlags::committing))
+            {
+                break;
+            }
+        }
+        return meta.blobState;
+    }
+
+    /* A patch against the base that should produce target. */
+    Patch patchFor(const std::vector<uint8_t>& target)
+    {
+        return Patch(base.size(), target.size(), sha256(base), sha256(target));
+    }
+
+    bool upload(const Patch& patch)
+    {
+        return handler.open(session, OpenFlags::write, path) &&
+               handler.write(session, 0, patch.bytes) &&
+               handler.commit(session, {});
+    }
+
+    fs::path dir;
+    DeltaImage image;
+    DeltaBlobHandler handler;
+    std::vector<uint8_t> base;
+    std::string path = "/delta/bios";
+    uint16_t session = 1;
+};
+
+TEST_F(DeltaBlobTest, GoodPatchIsRenamedIntoPlace)
+{
+    std::vector<uint8_t> expected = {'e', 'f', 'g', 'x', 'y', 'a', 'b'};
+    Patch patch = patchFor(expected);
+    patch.copy(4, 3).insert({'x', 'y'}).copy(0, 2);
+
+    ASSERT_TRUE(upload(patch));
+    EXPECT_EQ(StateFlags::committed, pollUntilDone());
+    EXPECT_EQ(expected, readFile(image.targetPath));
+    EXPECT_FALSE(fs::exists(image.targetPath + ".partial"));
+}
+
+TEST_F(DeltaBlobTest, BadMagicFailsTheWrite)
+{
+    Patch patch = patchFor({'x', 'y'});
+    patch.insert({'x', 'y'});
+    patch.bytes[0] = 'X';
+
+    EXPECT_FALSE(upload(patch));
+    BlobMeta meta;
+    EXPECT_TRUE(handler.stat(session, &meta));
+    EXPECT_EQ(StateFlags::commit_error, meta.blobState);
+    EXPECT_FALSE(fs::exists(image.targetPath + ".partial"));
+}
+
+TEST_F(DeltaBlobTest, ShortHeaderFailsCommit)
+{
+    Patch patch = patchFor({'x', 'y'});
+    patch.bytes.resize(sizeof(deltaMagic) + 4);
+
+    EXPECT_FALSE(upload(patch));
+}
+
+TEST_F(DeltaBlobTest, BaseSizeMismatchFailsCommit)
+{
+    std::vector<uint8_t> expected = {'x', 'y'};
+    Patch patch(base.size() + 1, expected.size(), sha256(base),
+                sha256(expected));
+    patch.insert(expected);
+
+    EXPECT_FALSE(upload(patch));
+    EXPECT_FALSE(fs::exists(image.targetPath));
+}
+
+TEST_F(DeltaBlobTest, BaseDigestMismatchFailsTheWrite)
+{
+    // A base of the right size but other contents fails the write that
+    // completes the header, before anything is written.
+    std::vector<uint8_t> expected = {'x', 'y'};
+    std::vector<uint8_t> otherBase(base.size(), 'z');
+    Patch patch(base.size(), expected.size(), sha256(otherBase),
+                sha256(expected));
+    patch.insert(expected);
+
+    ASSERT_TRUE(handler.open(session, OpenFlags::write, path));
+    EXPECT_FALSE(handler.write(session, 0, patch.bytes));
+    BlobMeta meta;
+    EXPECT_TRUE(handler.stat(session, &meta));
+    EXPECT_EQ(StateFlags::commit_error, meta.blobState);
+    EXPECT_FALSE(fs::exists(image.targetPath));
+    EXPECT_FALSE(fs::exists(image.targetPath + ".partial"));
+}
+
+TEST_F(DeltaBlobTest, TargetDigestMismatchFailsCommit)
+{
+    // The patch applies cleanly but doesn't produce the target it names, so
+    // nothing is renamed into place.
+    std::vector<uint8_t> expected = {'e', 'f', 'g'};
+    Patch patch(base.size(), expected.size(), sha256(base),
+                sha256({'e', 'f', 'x'}));
+    patch.copy(4, 3);
+
+    ASSERT_TRUE(upload(patch));
+    EXPECT_EQ(StateFlags::commit_error, pollUntilDone());
+    EXPECT_FALSE(fs::exists(image.targetPath));
+    EXPECT_FALSE(fs::exists(image.targetPath + ".partial"));
+}
+
+TEST_F(DeltaBlobTest, PatchMaySplitAnywhere)
+{
+    std::vector<uint8_t> expected = {'e', 'f', 'g', 'x', 'y', 'a', 'b'};
+    Patch patch = patchFor(expected);
+    patch.copy(4, 3).insert({'x', 'y'}).copy(0, 2);
+
+    // One byte per write splits every header and the insert data.
+    ASSERT_TRUE(handler.open(session, OpenFlags::write, path));
+    for (size_t i = 0; i < patch.bytes.size(); ++i)
+    {
+        ASSERT_TRUE(handler.write(session, i, {patch.bytes[i]}));
+    }
+    ASSERT_TRUE(handler.commit(session, {}));
+    EXPECT_EQ(StateFlags::committed, pollUntilDone());
+    EXPECT_EQ(expected, readFile(image.targetPath));
+}
+
+TEST_F(DeltaBlobTest, RetriedWriteIsAccepted)
+{
+    std::vector<uint8_t> expected = {'x', 'y', 'z'};
+    Patch patch = patchFor(expected);
+    patch.insert(expected);
+    std::vector<uint8_t> first(patch.bytes.begin(), patch.bytes.end() - 1);
+
+    ASSERT_TRUE(handler.open(session, OpenFlags::write, path));
+    ASSERT_TRUE(handler.write(session, 0, first));
+    // The whole patch again only adds the byte that wasn't there yet.
+    ASSERT_TRUE(handler.write(session, 0, patch.bytes));
+    ASSERT_TRUE(handler.commit(session, {}));
+    EXPECT_EQ(StateFlags::committed, pollUntilDone());
+    EXPECT_EQ(expected, readFile(image.targetPath));
+}
+
+TEST_F(DeltaBlobTest, WritePastTheReceivedBytesFails)
+{
+    Patch patch = patchFor({'x', 'y'});
+    patch.insert({'x', 'y'});
+    std::vector<uint8_t> tail(patch.bytes.begin() + 1, patch.bytes.end());
+
+    ASSERT_TRUE(handler.open(session, OpenFlags::write, path));
+    EXPECT_FALSE(handler.write(session, 1, tail));
+    EXPECT_TRUE(handler.write(session, 0, patch.bytes));
+}
+
+TEST_F(DeltaBlobTest, ManyShortCopiesAreApplied)
+{
+    // More copies than are queued at once, so some are applied early.
+    size_t count = deltaMaxQueuedCopies + 10;
+    std::vector<uint8_t> expected;
+    for (size_t i = 0; i < count; ++i)
+    {
+        expected.push_back(base[i % base.size()]);
+    }
+    Patch patch = patchFor(expected);
+    for (size_t i = 0; i < count; ++i)
+    {
+        patch.copy(i % base.size(), 1);
+    }
+
+    ASSERT_TRUE(upload(patch));
+    EXPECT_EQ(StateFlags::committed, pollUntilDone());
+    EXPECT_EQ(expected, readFile(image.targetPath));
+}
+
+TEST_F(DeltaBlobTest, CopyPastTheBaseFails)
+{
+    Patch patch = patchFor(std::vector<uint8_t>(4));
+    patch.copy(6, 4);
+
+    EXPECT_FALSE(upload(patch));
+    BlobMeta meta;
+    EXPECT_TRUE(handler.stat(session, &meta));
+    EXPECT_EQ(StateFlags::commit_error, meta.blobState);
+    EXPECT_FALSE(fs::exists(image.targetPath));
+    EXPECT_FALSE(fs::exists(image.targetPath + ".partial"));
+}
+
+TEST_F(DeltaBlobTest, InsertLongerThanThePatchFails)
+{
+    Patch patch = patchFor(std::vector<uint8_t>(4));
+    patch.insert({'x', 'y'});
+    // Claim four bytes of data where there are only two.
+    patch.bytes[patch.bytes.size() - 6] = 4;
+
+    EXPECT_FALSE(upload(patch));
+    EXPECT_FALSE(fs::exists(image.targetPath));
+    EXPECT_FALSE(fs::exists(image.targetPath + ".partial"));
+}
+
+TEST_F(DeltaBlobTest, OpLongerThanTheTargetFails)
+{
+    Patch patch = patchFor(std::vector<uint8_t>(2));
+    patch.copy(0, 4);
+
+    EXPECT_FALSE(upload(patch));
+    EXPECT_FALSE(fs::exists(image.targetPath));
+}
+
+TEST_F(DeltaBlobTest, TargetIsCheckedAStepAtATime)
+{
+    // Writing the target and reading it back each count for half.  The
+    // write applies the first step of the copy, and each poll one more
+    // step of the copy or the check.
+    base.assign(deltaApplyStep * 3, 0x5a);
+    std::ofstream(image.basePath, std::ios::binary)
+        .write(reinterpret_cast<const char*>(base.data()), base.size());
+    Patch patch = patchFor(base);
+    patch.copy(0, base.size());
+
+    ASSERT_TRUE(upload(patch));
+    BlobMeta meta;
+    for (int progress : {33, 50, 66, 83})
+    {
+        EXPECT_TRUE(handler.stat(session, &meta));
+        EXPECT_TRUE(meta.blobState & StateFlags::committing);
+        EXPECT_EQ(progress, meta.blobState >> deltaProgressShift);
+    }
+    EXPECT_TRUE(handler.stat(session, &meta));
+    EXPECT_EQ(StateFlags::committed, meta.blobState);
+    EXPECT_EQ(base, readFile(image.targetPath));
+}
+
+TEST_F(DeltaBlobTest, CloseDuringApplyRemovesThePartialTarget)
+{
+    // The write applies the first step of the copy, and the first poll the
+    // second, which leaves it two thirds applied.
+    base.assign(deltaApplyStep * 3, 0x5a);
+    std::ofstream(image.basePath, std::ios::binary)
+        .write(reinterpret_cast<const char*>(base.data()), base.size());
+    Patch patch = patchFor(base);
+    patch.copy(0, base.size());
+
+    ASSERT_TRUE(upload(patch));
+    BlobMeta meta;
+    EXPECT_TRUE(handler.stat(session, &meta));
+    EXPECT_TRUE(meta.blobState & StateFlags::committing);
+    EXPECT_EQ(33, meta.blobState >> deltaProgressShift);
+    EXPECT_TRUE(fs::exists(image.targetPath + ".partial"));
+
+    EXPECT_TRUE(handler.close(session));
+    EXPECT_FALSE(fs::exists(image.targetPath + ".partial"));
+    EXPECT_FALSE(fs::exists(image.targetPath));
+}
+
+} // namespace blobs
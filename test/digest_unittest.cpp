@@ -0,0 +1,70 @@
+#include "digest.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+namespace
+{
+
+std::vector<uint8_t> bytes(std::string_view text)
+{
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+} // namespace
+
+TEST(DigestTest, Crc32cKnownCheckValue)
+{
+    EXPECT_EQ(0xe3069283, crc32c(bytes("123456789")));
+}
+
+TEST(DigestTest, Crc32cChainsAcrossCalls)
+{
+    auto data = bytes("123456789");
+    uint32_t crc = crc32c(std::span(data).first(4));
+    EXPECT_EQ(0xe3069283, crc32c(std::span(data).subspan(4), crc));
+}
+
+TEST(DigestTest, Crc32cCombineMatchesOnePass)
+{
+    auto data = bytes("123456789");
+    for (size_t split = 0; split <= data.size(); ++split)
+    {
+        std::span<const uint8_t> all(data);
+        EXPECT_EQ(0xe3069283,
+                  crc32cCombine(crc32c(all.first(split)),
+                                crc32c(all.subspan(split)),
+                                data.size() - split));
+    }
+}
+
+TEST(DigestTest, Crc32cCombineLongSecondRun)
+{
+    std::vector<uint8_t> data(100000);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<uint8_t>(i * 31);
+    }
+    std::span<const uint8_t> all(data);
+    EXPECT_EQ(crc32c(all), crc32cCombine(crc32c(all.first(7)),
+                                         crc32c(all.subspan(7)),
+                                         data.size() - 7));
+}
+
+TEST(DigestTest, Crc32cRepeatMatchesTheBytes)
+{
+    for (uint64_t count : {0, 1, 2, 3, 4096, 100003})
+    {
+        std::vector<uint8_t> data(count, 0xa5);
+        EXPECT_EQ(crc32c(data), crc32cRepeat(0xa5, count));
+    }
+}
+
+} // namespace blobs
@@ -30,4 +30,39 @@ std::vector<std::uint8_t> validateReply(
     return hasData ? data : std::vector<uint8_t>{};
 }
 
+std::vector<std::uint8_t> validateReply(Resp reply, bool hasData)
+{
+    // Copy the span reply out of the response buffer and check it as a
+    // vector.
+    auto [cc, payload] = reply;
+    std::optional<std::tuple<std::vector<uint8_t>>> copied;
+    if (payload.has_value())
+    {
+        auto data = std::get<0>(*payload);
+        copied.emplace(std::vector<uint8_t>(data.begin(), data.end()));
+    }
+
+    return validateReply(std::make_tuple(cc, copied), hasData);
+}
+
+ipmi::RspType<std::vector<uint8_t>> runCommand(IpmiBlobHandler cmd,
+                                               ManagerInterface* mgr,
+                                               std::span<const uint8_t> data)
+{
+    // ipmid.hpp isn't installed where we can grab it and this value is per BMC
+    // SoC.
+    std::vector<uint8_t> buffer(64);
+    ResponseWriter reply(buffer);
+
+    ipmi::Cc cc = cmd(mgr, data, reply);
+    if (cc != ipmi::ccSuccess)
+    {
+        return ipmi::response(cc);
+    }
+
+    std::span<uint8_t> written = reply.data();
+    return ipmi::responseSuccess(
+        std::vector<uint8_t>(written.begin(), written.end()));
+}
+
 } // namespace blobs
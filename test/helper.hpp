@@ -1,3 +1,5 @@
+#include "process.hpp"
+
 #include <ipmid/api-types.hpp>
 
 #include <optional>
@@ -12,4 +14,15 @@ namespace blobs
 {
 std::vector<std::uint8_t> validateReply(
     ipmi::RspType<std::vector<uint8_t>> reply, bool hasData = true);
+
+std::vector<std::uint8_t> validateReply(Resp reply, bool hasData = true);
+
+/**
+ * Run a command handler against a scratch reply buffer of the usual IPMI
+ * size and return a copy of what it wrote, so tests can compare replies by
+ * value.
+ */
+ipmi::RspType<std::vector<uint8_t>> runCommand(IpmiBlobHandler cmd,
+                                               ManagerInterface* mgr,
+                                               std::span<const uint8_t> data);
 } // namespace blobs
@@ -1,3 +1,4 @@
+#include "helper.hpp"
 #include "ipmi.hpp"
 #include "manager_mock.hpp"
 
@@ -29,7 +30,8 @@ TEST(BlobCloseTest, ManagerRejectsCloseReturnsFailure)
     std::memcpy(request.data(), &req, dataLen);
 
     EXPECT_CALL(mgr, close(sessionId)).WillOnce(Return(false));
-    EXPECT_EQ(ipmi::responseUnspecifiedError(), closeBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(closeBlob, &mgr, request));
 }
 
 TEST(BlobCloseTest, BlobClosedReturnsSuccess)
@@ -51,6 +53,6 @@ TEST(BlobCloseTest, BlobClosedReturnsSuccess)
 
     EXPECT_CALL(mgr, close(sessionId)).WillOnce(Return(true));
     EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
-              closeBlob(&mgr, request));
+              runCommand(closeBlob, &mgr, request));
 }
 } // namespace blobs
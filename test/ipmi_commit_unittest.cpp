@@ -1,3 +1,4 @@
+#include "helper.hpp"
 #include "ipmi.hpp"
 #include "manager_mock.hpp"
 
@@ -27,7 +28,8 @@ TEST(BlobCommitTest, InvalidCommitDataLengthReturnsFailure)
 
     request.resize(sizeof(struct BmcBlobCommitTx));
     std::memcpy(request.data(), &req, sizeof(struct BmcBlobCommitTx));
-    EXPECT_EQ(ipmi::responseReqDataLenInvalid(), commitBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(commitBlob, &mgr, request));
 }
 
 TEST(BlobCommitTest, ValidCommitNoDataHandlerRejectsReturnsFailure)
@@ -45,7 +47,8 @@ TEST(BlobCommitTest, ValidCommitNoDataHandlerRejectsReturnsFailure)
     std::memcpy(request.data(), &req, sizeof(struct BmcBlobCommitTx));
 
     EXPECT_CALL(mgr, commit(req.sessionId, _)).WillOnce(Return(false));
-    EXPECT_EQ(ipmi::responseUnspecifiedError(), commitBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(commitBlob, &mgr, request));
 }
 
 TEST(BlobCommitTest, ValidCommitNoDataHandlerAcceptsReturnsSuccess)
@@ -64,7 +67,7 @@ TEST(BlobCommitTest, ValidCommitNoDataHandlerAcceptsReturnsSuccess)
     EXPECT_CALL(mgr, commit(req.sessionId, _)).WillOnce(Return(true));
 
     EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
-              commitBlob(&mgr, request));
+              runCommand(commitBlob, &mgr, request));
 }
 
 TEST(BlobCommitTest, ValidCommitWithDataHandlerAcceptsReturnsSuccess)
@@ -87,6 +90,6 @@ TEST(BlobCommitTest, ValidCommitWithDataHandlerAcceptsReturnsSuccess)
         .WillOnce(Return(true));
 
     EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
-              commitBlob(&mgr, request));
+              runCommand(commitBlob, &mgr, request));
 }
 } // namespace blobs
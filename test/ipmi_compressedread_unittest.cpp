@@ -0,0 +1,191 @@
+#include "compress.hpp"
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Matcher;
+using ::testing::NotNull;
+using ::testing::Return;
+
+namespace
+{
+
+constexpr uint16_t compressedFlags =
+    OpenFlags::read | OpenFlags::compressedRead;
+
+// The runCommand() reply is 64 bytes, and a stream of this many bytes that
+// don't compress fills what is left after the header.
+constexpr uint32_t literalReadSize =
+    (64 - sizeof(struct BmcBlobCompressedReadRx)) * 128 / 129;
+
+// A blob of size bytes, each given by byteAt, served through the mock's
+// reads.  Counts every byte the reads return.
+void serveBlob(ManagerMock& mgr, uint32_t size, uint8_t (*byteAt)(uint32_t),
+               size_t* bytesRead)
+{
+    EXPECT_CALL(mgr, read(0x54, _, _))
+        .WillRepeatedly(Invoke([=](uint16_t, uint32_t offset, uint32_t len) {
+            std::vector<uint8_t> bytes;
+            for (uint32_t i = offset; i < size && i - offset < len; ++i)
+            {
+                bytes.push_back(byteAt(i));
+            }
+            *bytesRead += bytes.size();
+            return bytes;
+        }));
+}
+
+uint8_t repetitiveByte(uint32_t)
+{
+    return 0xff;
+}
+
+uint8_t randomByte(uint32_t offset)
+{
+    return static_cast<uint8_t>((offset * 2654435761u) >> 24);
+}
+
+std::vector<uint8_t> readRequest(uint32_t requestedSize)
+{
+    struct BmcBlobReadTx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = 0x100;
+    req.requestedSize = requestedSize;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    return request;
+}
+
+BmcBlobCompressedReadRx replyHeader(const std::vector<uint8_t>& result)
+{
+    BmcBlobCompressedReadRx rep;
+    EXPECT_LE(sizeof(rep), result.size());
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    return rep;
+}
+
+std::vector<uint8_t> expand(const std::vector<uint8_t>& result)
+{
+    LzDecoder decoder;
+    std::vector<uint8_t> out;
+    EXPECT_TRUE(decoder.decode(
+        std::span(result).subspan(sizeof(struct BmcBlobCompressedReadRx)),
+        out));
+    return out;
+}
+
+} // namespace
+
+TEST(BlobCompressedReadTest, RepetitiveDataCoversMoreThanTheReply)
+{
+    // A run of one byte compresses to a few tokens, so the read keeps going
+    // well past what the reply holds uncompressed.
+    ManagerMock mgr;
+    size_t bytesRead = 0;
+    serveBlob(mgr, 0x10000, repetitiveByte, &bytesRead);
+
+    EXPECT_CALL(mgr, getSessionFlags(0x54)).WillOnce(Return(compressedFlags));
+    EXPECT_CALL(mgr, getReadSize(0x54, _)).WillOnce(Return(0x10000));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, readRequest(0)));
+    auto rep = replyHeader(result);
+    EXPECT_LT(64, rep.length);
+    EXPECT_EQ(bytesRead, rep.length);
+    EXPECT_EQ(0x100 + rep.length, rep.nextOffset);
+    EXPECT_EQ(0, rep.flags);
+    EXPECT_EQ(std::vector<uint8_t>(rep.length, 0xff), expand(result));
+}
+
+TEST(BlobCompressedReadTest, IncompressibleDataIsReadOnce)
+{
+    // Data that doesn't compress is read only as far as fits in the reply,
+    // so none of what the handler returns is thrown away, and the rest is
+    // left for the next read rather than marking the end of the blob.
+    ManagerMock mgr;
+    size_t bytesRead = 0;
+    serveBlob(mgr, 0x10000, randomByte, &bytesRead);
+
+    EXPECT_CALL(mgr, getSessionFlags(0x54)).WillOnce(Return(compressedFlags));
+    EXPECT_CALL(mgr, getReadSize(0x54, _)).WillOnce(Return(0x10000));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, readRequest(0)));
+    auto rep = replyHeader(result);
+    EXPECT_EQ(literalReadSize, bytesRead);
+    EXPECT_EQ(literalReadSize, rep.length);
+    EXPECT_EQ(0x100 + rep.length, rep.nextOffset);
+    EXPECT_EQ(0, rep.flags);
+
+    std::vector<uint8_t> expected;
+    for (uint32_t i = 0; i < rep.length; ++i)
+    {
+        expected.push_back(randomByte(0x100 + i));
+    }
+    EXPECT_EQ(expected, expand(result));
+}
+
+TEST(BlobCompressedReadTest, ShortReadReportsEndOfBlob)
+{
+    // The requested size caps the read, and a short read from a handler that
+    // reports no size is the end.
+    ManagerMock mgr;
+    std::vector<uint8_t> data = {0x02, 0x03, 0x05, 0x06};
+
+    EXPECT_CALL(mgr, getSessionFlags(0x54)).WillOnce(Return(compressedFlags));
+    EXPECT_CALL(mgr, read(0x54, 0x100, _)).WillOnce(Return(data));
+    EXPECT_CALL(mgr, getReadSize(0x54, _)).WillOnce(Return(0));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, readRequest(100)));
+    auto rep = replyHeader(result);
+    EXPECT_EQ(data.size(), rep.length);
+    EXPECT_EQ(0x100 + data.size(), rep.nextOffset);
+    EXPECT_EQ(ReadTrailerFlags::endOfBlob, rep.flags);
+    EXPECT_EQ(data, expand(result));
+}
+
+TEST(BlobCompressedReadTest, SessionWithoutStatEndsOnAShortRead)
+{
+    // A handler that can't stat its session is treated like one that reports
+    // no size.
+    ManagerMock mgr;
+    std::vector<uint8_t> data = {0x02, 0x03, 0x05, 0x06};
+
+    EXPECT_CALL(mgr, getSessionFlags(0x54)).WillOnce(Return(compressedFlags));
+    EXPECT_CALL(mgr, read(0x54, 0x100, _)).WillOnce(Return(data));
+    EXPECT_CALL(mgr, getReadSize(0x54, _)).WillOnce(Return(0));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, readRequest(100)));
+    auto rep = replyHeader(result);
+    EXPECT_EQ(data.size(), rep.length);
+    EXPECT_EQ(ReadTrailerFlags::endOfBlob, rep.flags);
+    EXPECT_EQ(data, expand(result));
+}
+
+TEST(BlobCompressedReadTest, UncompressedSessionGetsPlainData)
+{
+    ManagerMock mgr;
+    std::vector<uint8_t> data = {0x02, 0x03, 0x05, 0x06};
+
+    EXPECT_CALL(mgr, getSessionFlags(0x54)).WillOnce(Return(OpenFlags::read));
+    EXPECT_CALL(mgr, read(0x54, 0x100, 0x10)).WillOnce(Return(data));
+
+    auto result =
+        validateReply(runCommand(readBlob, &mgr, readRequest(0x10)));
+    ASSERT_EQ(sizeof(struct BmcBlobReadRx) + data.size(), result.size());
+    EXPECT_EQ(0, std::memcmp(&result[sizeof(struct BmcBlobReadRx)],
+                             data.data(), data.size()));
+}
+
+} // namespace blobs
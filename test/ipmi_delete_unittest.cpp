@@ -1,3 +1,4 @@
+#include "helper.hpp"
 #include "ipmi.hpp"
 #include "manager_mock.hpp"
 
@@ -26,7 +27,8 @@ TEST(BlobDeleteTest, InvalidRequestLengthReturnsFailure)
     std::memcpy(request.data(), &req, sizeof(struct BmcBlobDeleteTx));
     request.insert(request.end(), blobId.begin(), blobId.end());
 
-    EXPECT_EQ(ipmi::responseReqDataLenInvalid(), deleteBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(deleteBlob, &mgr, request));
 }
 
 TEST(BlobDeleteTest, RequestRejectedReturnsFailure)
@@ -44,7 +46,8 @@ TEST(BlobDeleteTest, RequestRejectedReturnsFailure)
     request.emplace_back('\0');
 
     EXPECT_CALL(mgr, deleteBlob(StrEq(blobId))).WillOnce(Return(false));
-    EXPECT_EQ(ipmi::responseUnspecifiedError(), deleteBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(deleteBlob, &mgr, request));
 }
 
 TEST(BlobDeleteTest, BlobDeleteReturnsOk)
@@ -64,6 +67,6 @@ TEST(BlobDeleteTest, BlobDeleteReturnsOk)
     EXPECT_CALL(mgr, deleteBlob(StrEq(blobId))).WillOnce(Return(true));
 
     EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
-              deleteBlob(&mgr, request));
+              runCommand(deleteBlob, &mgr, request));
 }
 } // namespace blobs
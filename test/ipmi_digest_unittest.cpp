@@ -0,0 +1,75 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Return;
+
+namespace
+{
+
+std::vector<uint8_t> digestRequest(uint8_t algorithm, uint64_t offset,
+                                   uint64_t length)
+{
+    struct BmcBlobDigestTx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.algorithm = algorithm;
+    req.offset = offset;
+    req.length = length;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    return request;
+}
+
+} // namespace
+
+TEST(BlobDigestTest, UnknownAlgorithmIsRejected)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, digest(_, _, _, _)).Times(0);
+
+    EXPECT_EQ(ipmi::responseInvalidFieldRequest(),
+              runCommand(digestBlob, &mgr, digestRequest(2, 0, 0x100)));
+}
+
+TEST(BlobDigestTest, ManagerFailureReturnsFailure)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, digest(0x54, DigestAlgorithm::sha256, 0x100, 0x1000))
+        .WillOnce(Return(std::nullopt));
+
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(digestBlob, &mgr, digestRequest(1, 0x100, 0x1000)));
+}
+
+TEST(BlobDigestTest, DigestFollowsTheHeader)
+{
+    // The offset and length are 64 bits wide, so a range past 4GiB works.
+    ManagerMock mgr;
+    std::vector<uint8_t> digest = {0x83, 0x92, 0x06, 0xe3};
+
+    EXPECT_CALL(mgr, digest(0x54, DigestAlgorithm::crc32c, 0x100000000,
+                            0x200000000))
+        .WillOnce(Return(digest));
+
+    auto result = validateReply(runCommand(
+        digestBlob, &mgr, digestRequest(0, 0x100000000, 0x200000000)));
+    ASSERT_EQ(sizeof(struct BmcBlobDigestRx) + digest.size(), result.size());
+    EXPECT_EQ(0, std::memcmp(&result[sizeof(struct BmcBlobDigestRx)],
+                             digest.data(), digest.size()));
+}
+
+} // namespace blobs
@@ -26,7 +26,7 @@ TEST(BlobEnumerateTest, VerifyIfRequestByIdInvalidReturnsFailure)
 
     EXPECT_CALL(mgr, getBlobId(req.blobIdx)).WillOnce(Return(""));
     EXPECT_EQ(ipmi::responseInvalidFieldRequest(),
-              enumerateBlob(&mgr, request));
+              runCommand(enumerateBlob, &mgr, request));
 }
 
 TEST(BlobEnumerateTest, BoringRequestByIdAndReceive)
@@ -45,7 +45,7 @@ TEST(BlobEnumerateTest, BoringRequestByIdAndReceive)
 
     EXPECT_CALL(mgr, getBlobId(req.blobIdx)).WillOnce(Return(blobId));
 
-    auto result = validateReply(enumerateBlob(&mgr, request));
+    auto result = validateReply(runCommand(enumerateBlob, &mgr, request));
 
     // We're expecting this as a response.
     // blobId.length + 1 + sizeof(uint16_t);
@@ -0,0 +1,133 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::ElementsAreArray;
+using ::testing::Return;
+
+namespace
+{
+
+std::vector<uint8_t> rangeRequest(uint32_t blobIdx, uint8_t flags)
+{
+    struct BmcBlobEnumerateRangeTx req;
+    req.crc = 0;
+    req.blobIdx = blobIdx;
+    req.flags = flags;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    return request;
+}
+
+BmcBlobEnumerateRangeRx rangeHeader(const std::vector<uint8_t>& result)
+{
+    struct BmcBlobEnumerateRangeRx rep;
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    return rep;
+}
+
+} // namespace
+
+TEST(BlobEnumerateRangeTest, InvalidIndexReturnsFailure)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, getBlobIdRange(5))
+        .WillOnce(Return(std::span<const std::string>()));
+    EXPECT_EQ(ipmi::responseInvalidFieldRequest(),
+              runCommand(enumerateBlobRange, &mgr, rangeRequest(5, 0)));
+}
+
+TEST(BlobEnumerateRangeTest, PacksEveryIdThatFits)
+{
+    // All the ids fit in one reply, so nextIdx is the end of the list.
+    ManagerMock mgr;
+    std::vector<std::string> ids = {"/skm/1", "/skm/2", "/bmc"};
+
+    EXPECT_CALL(mgr, getBlobIdRange(0))
+        .WillOnce(Return(std::span<const std::string>(ids)));
+    EXPECT_CALL(mgr, getBlobHandle(0)).WillOnce(Return(0x12340000));
+
+    auto result =
+        validateReply(runCommand(enumerateBlobRange, &mgr, rangeRequest(0, 0)));
+
+    auto rep = rangeHeader(result);
+    EXPECT_EQ(3, rep.nextIdx);
+    EXPECT_EQ(0x12340000, rep.handle);
+    EXPECT_EQ(3, rep.count);
+
+    std::string expected("/skm/1\0/skm/2\0/bmc\0", 19);
+    EXPECT_THAT(std::span(result).subspan(sizeof(rep)),
+                ElementsAreArray(expected));
+}
+
+TEST(BlobEnumerateRangeTest, StopsAtTheFirstIdThatDoesNotFit)
+{
+    // runCommand replies into 64 bytes, which holds the header and four of
+    // these ids.
+    ManagerMock mgr;
+    std::vector<std::string> ids(6, std::string(12, 'a'));
+
+    EXPECT_CALL(mgr, getBlobIdRange(1))
+        .WillOnce(Return(std::span<const std::string>(ids).subspan(1)));
+
+    auto result =
+        validateReply(runCommand(enumerateBlobRange, &mgr, rangeRequest(1, 0)));
+
+    auto rep = rangeHeader(result);
+    EXPECT_EQ(4, rep.count);
+    EXPECT_EQ(5, rep.nextIdx);
+    EXPECT_EQ(sizeof(rep) + 4 * 13, result.size());
+}
+
+TEST(BlobEnumerateRangeTest, FrontCodingSendsOnlyTheNewSuffix)
+{
+    ManagerMock mgr;
+    std::vector<std::string> ids = {"/skm/10", "/skm/11", "/bmc"};
+
+    EXPECT_CALL(mgr, getBlobIdRange(0))
+        .WillOnce(Return(std::span<const std::string>(ids)));
+
+    auto result = validateReply(runCommand(
+        enumerateBlobRange, &mgr,
+        rangeRequest(0, EnumerateRangeFlags::frontCoded)));
+
+    auto rep = rangeHeader(result);
+    EXPECT_EQ(3, rep.count);
+
+    std::string expected("\0/skm/10\0\x06"
+                         "1\0\x01"
+                         "bmc\0",
+                         17);
+    EXPECT_THAT(std::span(result).subspan(sizeof(rep)),
+                ElementsAreArray(expected));
+}
+
+TEST(BlobEnumerateRangeTest, FirstIdTooLongFails)
+{
+    // As with BmcBlobEnumerate, an id that can't fit in a reply is an error.
+    ManagerMock mgr;
+    std::vector<std::string> ids = {std::string(100, 'a')};
+
+    EXPECT_CALL(mgr, getBlobIdRange(0))
+        .WillOnce(Return(std::span<const std::string>(ids)));
+
+    std::vector<uint8_t> buffer(64);
+    ResponseWriter reply(buffer);
+    EXPECT_EQ(ipmi::ccSuccess,
+              enumerateBlobRange(&mgr, rangeRequest(0, 0), reply));
+    EXPECT_TRUE(reply.overflowed());
+}
+} // namespace blobs
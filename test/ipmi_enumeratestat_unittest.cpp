@@ -0,0 +1,104 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+namespace
+{
+
+std::vector<uint8_t> enumerateStatRequest(uint32_t blobIdx)
+{
+    struct BmcBlobEnumerateStatTx req;
+    req.crc = 0;
+    req.blobIdx = blobIdx;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    return request;
+}
+
+} // namespace
+
+TEST(BlobEnumerateStatTest, InvalidIndexReturnsFailure)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, getBlobIdRange(2))
+        .WillOnce(Return(std::span<const std::string>()));
+    EXPECT_EQ(ipmi::responseInvalidFieldRequest(),
+              runCommand(enumerateStatBlob, &mgr, enumerateStatRequest(2)));
+}
+
+TEST(BlobEnumerateStatTest, ReturnsIdStateAndSizeForEachBlob)
+{
+    // Both blobs fit, and a failed stat is marked rather than skipped.
+    ManagerMock mgr;
+    std::vector<std::string> ids = {"/a", "/bc"};
+
+    EXPECT_CALL(mgr, getBlobIdRange(0))
+        .WillOnce(Return(std::span<const std::string>(ids)));
+    EXPECT_CALL(mgr, statBlobRange(0, _))
+        .WillOnce(
+            Invoke([](uint32_t, std::span<std::optional<BlobMeta>> metas) {
+                ASSERT_EQ(2, metas.size());
+                metas[0] = BlobMeta{.blobState = StateFlags::committed,
+                                    .size = 0x1234,
+                                    .metadata = {}};
+                metas[1].reset();
+            }));
+    EXPECT_CALL(mgr, getBlobHandle(0)).WillOnce(Return(0x12340000));
+
+    auto request = enumerateStatRequest(0);
+    auto result = validateReply(runCommand(enumerateStatBlob, &mgr, request));
+
+    struct BmcBlobEnumerateStatRx rep;
+    ASSERT_LE(sizeof(rep), result.size());
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(2, rep.nextIdx);
+    EXPECT_EQ(0x12340000, rep.handle);
+    EXPECT_EQ(2, rep.count);
+
+    std::vector<uint8_t> expected = {
+        1, StateFlags::committed, 0, 0x34, 0x12, 0, 0, '/', 'a', 0,
+        0, 0, 0, 0, 0, 0, 0, '/', 'b', 'c', 0};
+    EXPECT_EQ(expected, std::vector<uint8_t>(result.begin() + sizeof(rep),
+                                             result.end()));
+}
+
+TEST(BlobEnumerateStatTest, OnlyStatsTheBlobsThatFit)
+{
+    // runCommand replies into 64 bytes: the header and three 17 byte entries.
+    ManagerMock mgr;
+    std::vector<std::string> ids(5, std::string(9, 'a'));
+
+    EXPECT_CALL(mgr, getBlobIdRange(0))
+        .WillOnce(Return(std::span<const std::string>(ids)));
+    EXPECT_CALL(mgr, statBlobRange(0, _))
+        .WillOnce(
+            Invoke([](uint32_t, std::span<std::optional<BlobMeta>> metas) {
+                EXPECT_EQ(3, metas.size());
+            }));
+
+    auto request = enumerateStatRequest(0);
+    auto result = validateReply(runCommand(enumerateStatBlob, &mgr, request));
+
+    struct BmcBlobEnumerateStatRx rep;
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(3, rep.nextIdx);
+    EXPECT_EQ(3, rep.count);
+}
+} // namespace blobs
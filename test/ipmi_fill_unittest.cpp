@@ -0,0 +1,79 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::Return;
+
+namespace
+{
+
+std::vector<uint8_t> fillRequest(uint16_t sessionId, uint64_t offset,
+                                 uint64_t length, uint8_t pattern)
+{
+    struct BmcBlobFillTx req;
+    req.crc = 0;
+    req.sessionId = sessionId;
+    req.offset = offset;
+    req.length = length;
+    req.pattern = pattern;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    return request;
+}
+
+} // namespace
+
+TEST(BlobFillTest, ManagerReturnsFailureReturnsFailure)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, fill(0x54, 0x100, 0x10000, 0xff)).WillOnce(Return(false));
+
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(fillBlob, &mgr,
+                         fillRequest(0x54, 0x100, 0x10000, 0xff)));
+}
+
+TEST(BlobFillTest, ManagerReturnsTrueFillSucceeds)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, fill(0x54, 0x100, 0x10000, 0x00)).WillOnce(Return(true));
+
+    EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
+              runCommand(fillBlob, &mgr,
+                         fillRequest(0x54, 0x100, 0x10000, 0x00)));
+}
+
+TEST(BlobFillTest, SpanPast4GiBReachesTheManager)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, fill(0x54, 0x100000100, 0x100000000, 0xff))
+        .WillOnce(Return(true));
+
+    EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
+              runCommand(fillBlob, &mgr,
+                         fillRequest(0x54, 0x100000100, 0x100000000, 0xff)));
+}
+
+TEST(BlobFillTest, MissingPatternReturnsFailure)
+{
+    ManagerMock mgr;
+    auto request = fillRequest(0x54, 0x100, 0x10000, 0xff);
+    request.pop_back();
+
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(fillBlob, &mgr, request));
+}
+
+} // namespace blobs
@@ -0,0 +1,60 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::Return;
+
+// Like BmcBlobGetCount, the request is only the subcommand byte.
+
+TEST(BlobGetCapsTest, ReportsChannelAndSessionLimits)
+{
+    // runCommand replies into a 64 byte buffer, which stands in for the
+    // channel's max transfer size.
+    ManagerMock mgr;
+    SessionLimits limits = {.maxSessions = maxSessions,
+                            .openSessions = 3,
+                            .timeout = std::chrono::minutes(10)};
+
+    EXPECT_CALL(mgr, getSessionLimits()).WillOnce(Return(limits));
+
+    auto result = validateReply(runCommand(getBlobCaps, &mgr, {}));
+    ASSERT_EQ(sizeof(struct BmcBlobGetCapsRx), result.size());
+
+    struct BmcBlobGetCapsRx rep;
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(0, rep.crc);
+    EXPECT_EQ(64, rep.maxTransferSize);
+    EXPECT_EQ(64 - sizeof(struct BmcBlobWriteTx), rep.writeChunkSize);
+    EXPECT_EQ(64 - sizeof(struct BmcBlobReadRx), rep.readChunkSize);
+    EXPECT_TRUE(rep.extensions & ProtocolExtensions::autoSizedRead);
+    EXPECT_FALSE(rep.extensions & ProtocolExtensions::noCrcSessions);
+    EXPECT_EQ(maxSessions, rep.maxSessions);
+    EXPECT_EQ(3, rep.openSessions);
+    EXPECT_EQ(600, rep.sessionTimeout);
+}
+
+TEST(BlobGetCapsTest, NoCrcSessionsOnlyOnAChannelWithIntegrity)
+{
+    ManagerMock mgr;
+    EXPECT_CALL(mgr, getSessionLimits()).WillOnce(Return(SessionLimits{}));
+
+    std::array<uint8_t, 64> buffer{};
+    ResponseWriter reply(buffer);
+    std::vector<uint8_t> empty;
+    EXPECT_EQ(ipmi::ccSuccess,
+              getBlobCaps(&mgr, RequestBody(empty, true, true), reply));
+
+    auto rep = decode<BmcBlobGetCapsRx>(reply.data());
+    EXPECT_TRUE(rep.extensions & ProtocolExtensions::noCrcSessions);
+}
+} // namespace blobs
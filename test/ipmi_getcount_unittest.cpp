@@ -28,7 +28,7 @@ TEST(BlobCountTest, ReturnsZeroBlobs)
 
     EXPECT_CALL(mgr, buildBlobList()).WillOnce(Return(0));
 
-    auto result = validateReply(getBlobCount(&mgr, {}));
+    auto result = validateReply(runCommand(getBlobCount, &mgr, {}));
 
     EXPECT_EQ(sizeof(rep), result.size());
     EXPECT_EQ(0, std::memcmp(result.data(), &rep, sizeof(rep)));
@@ -47,7 +47,7 @@ TEST(BlobCountTest, ReturnsTwoBlobs)
 
     EXPECT_CALL(mgr, buildBlobList()).WillOnce(Return(2));
 
-    auto result = validateReply(getBlobCount(&mgr, {}));
+    auto result = validateReply(runCommand(getBlobCount, &mgr, {}));
 
     EXPECT_EQ(sizeof(rep), result.size());
     EXPECT_EQ(0, std::memcmp(result.data(), &rep, sizeof(rep)));
@@ -0,0 +1,117 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Return;
+
+namespace
+{
+
+std::vector<uint8_t> missingRequest(uint64_t offset, uint64_t length)
+{
+    struct BmcBlobGetMissingTx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = offset;
+    req.length = length;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    return request;
+}
+
+} // namespace
+
+TEST(BlobGetMissingTest, NoSessionReturnsFailure)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, getMissingRanges(0x54, 0, 0x1000, _))
+        .WillOnce(Return(std::nullopt));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(getMissingBlob, &mgr, missingRequest(0, 0x1000)));
+}
+
+TEST(BlobGetMissingTest, ReturnsTheMissingRanges)
+{
+    ManagerMock mgr;
+    std::vector<ByteRange> missing = {{0x10, 0x20}, {0x80, 0x100}};
+
+    EXPECT_CALL(mgr, getMissingRanges(0x54, 0, 0x1000, _))
+        .WillOnce(Return(missing));
+
+    auto result = validateReply(
+        runCommand(getMissingBlob, &mgr, missingRequest(0, 0x1000)));
+
+    struct BmcBlobGetMissingRx rep;
+    ASSERT_EQ(sizeof(rep) + 2 * sizeof(BmcBlobMissingRange), result.size());
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(2, rep.count);
+    // Everything fit, so the query is done.
+    EXPECT_EQ(0x1000, rep.nextOffset);
+
+    struct BmcBlobMissingRange range;
+    std::memcpy(&range, &result[sizeof(rep) + sizeof(range)], sizeof(range));
+    EXPECT_EQ(0x80, range.offset);
+    EXPECT_EQ(0x100, range.length);
+}
+
+TEST(BlobGetMissingTest, FullReplyContinuesAfterTheLastRange)
+{
+    // runCommand replies into 64 bytes, which holds the header and three
+    // ranges.  The offsets are 64 bits wide, so the query can start past
+    // 4GiB.
+    ManagerMock mgr;
+    std::vector<ByteRange> missing;
+    for (uint64_t i = 0; i < 3; ++i)
+    {
+        missing.push_back({0x100000000 + i * 0x10, 0x8});
+    }
+
+    EXPECT_CALL(mgr, getMissingRanges(0x54, 0x100000000, 0x1000, 3))
+        .WillOnce(Return(missing));
+
+    auto result = validateReply(runCommand(
+        getMissingBlob, &mgr, missingRequest(0x100000000, 0x1000)));
+
+    struct BmcBlobGetMissingRx rep;
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(3, rep.count);
+    EXPECT_EQ(0x100000028, rep.nextOffset);
+}
+
+TEST(BlobGetMissingTest, RangePastTheOffsetSpaceIsRejected)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, getMissingRanges(_, _, _, _)).Times(0);
+    EXPECT_EQ(ipmi::responseInvalidFieldRequest(),
+              runCommand(getMissingBlob, &mgr,
+                         missingRequest(0xfffffffffffffff0, 0x20)));
+}
+
+TEST(BlobGetMissingTest, ReplyWithNoRoomForARangeIsRejected)
+{
+    // A reply that only holds the header would send the host back to the
+    // same offset, so the request fails rather than loop.
+    ManagerMock mgr;
+    std::array<uint8_t, sizeof(BmcBlobGetMissingRx) + 1> buffer{};
+    ResponseWriter reply(buffer);
+
+    EXPECT_CALL(mgr, getMissingRanges(_, _, _, _)).Times(0);
+    EXPECT_EQ(ipmi::ccReqDataLenInvalid,
+              getMissingBlob(&mgr, missingRequest(0, 0x1000), reply));
+}
+
+} // namespace blobs
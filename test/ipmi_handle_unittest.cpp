@@ -0,0 +1,122 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Matcher;
+using ::testing::NotNull;
+using ::testing::Return;
+
+template <typename T>
+std::vector<uint8_t> toRequest(const T& req)
+{
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    return request;
+}
+
+TEST(BlobHandleTest, OpenHandleReturnsSession)
+{
+    ManagerMock mgr;
+    struct BmcBlobOpenHandleTx req;
+    req.crc = 0;
+    req.flags = OpenFlags::write;
+    req.handle = 0x12340002;
+
+    EXPECT_CALL(mgr, openHandle(req.flags, req.handle, NotNull()))
+        .WillOnce(Invoke([](uint16_t, uint32_t, uint16_t* session) {
+            *session = 0x54;
+            return true;
+        }));
+
+    auto result =
+        validateReply(runCommand(openBlobHandle, &mgr, toRequest(req)));
+
+    struct BmcBlobOpenRx rep;
+    ASSERT_EQ(sizeof(rep), result.size());
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(0x54, rep.sessionId);
+}
+
+TEST(BlobHandleTest, OpenHandleRejectedReturnsFailure)
+{
+    ManagerMock mgr;
+    struct BmcBlobOpenHandleTx req;
+    req.crc = 0;
+    req.flags = OpenFlags::read;
+    req.handle = invalidBlobHandle;
+
+    EXPECT_CALL(mgr, openHandle(req.flags, req.handle, _))
+        .WillOnce(Return(false));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(openBlobHandle, &mgr, toRequest(req)));
+}
+
+TEST(BlobHandleTest, StatHandleReturnsStat)
+{
+    ManagerMock mgr;
+    struct BmcBlobStatHandleTx req;
+    req.crc = 0;
+    req.handle = 0x12340001;
+
+    EXPECT_CALL(mgr, statHandle(req.handle, NotNull()))
+        .WillOnce(Invoke([](uint32_t, BlobMeta* meta) {
+            meta->blobState = StateFlags::committed;
+            meta->size = 0x100;
+            meta->metadata = {0x01, 0x02};
+            return true;
+        }));
+
+    auto result =
+        validateReply(runCommand(statBlobHandle, &mgr, toRequest(req)));
+
+    struct BmcBlobStatRx rep;
+    ASSERT_EQ(sizeof(rep) + 2, result.size());
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(StateFlags::committed, rep.blobState);
+    EXPECT_EQ(0x100, rep.size);
+    EXPECT_EQ(2, rep.metadataLen);
+}
+
+TEST(BlobHandleTest, StatHandleRejectedReturnsFailure)
+{
+    ManagerMock mgr;
+    struct BmcBlobStatHandleTx req;
+    req.crc = 0;
+    req.handle = 0x12340001;
+
+    EXPECT_CALL(mgr, statHandle(req.handle, _)).WillOnce(Return(false));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(statBlobHandle, &mgr, toRequest(req)));
+}
+
+TEST(BlobHandleTest, DeleteHandleReturnsSuccess)
+{
+    ManagerMock mgr;
+    struct BmcBlobDeleteHandleTx req;
+    req.crc = 0;
+    req.handle = 0x12340000;
+
+    EXPECT_CALL(mgr, deleteHandle(req.handle)).WillOnce(Return(true));
+    EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
+              runCommand(deleteBlobHandle, &mgr, toRequest(req)));
+}
+
+TEST(BlobHandleTest, ShortRequestReturnsFailure)
+{
+    ManagerMock mgr;
+    std::vector<uint8_t> request = {0, 0, 0x01, 0x02};
+
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(deleteBlobHandle, &mgr, request));
+}
+} // namespace blobs
@@ -0,0 +1,224 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::ElementsAreArray;
+using ::testing::Invoke;
+using ::testing::Matcher;
+using ::testing::NotNull;
+using ::testing::Return;
+using ::testing::StrEq;
+
+namespace
+{
+
+constexpr uint64_t past4GiB = 0x100000100;
+
+template <typename T>
+std::vector<uint8_t> toBytes(const T& value)
+{
+    std::vector<uint8_t> bytes(sizeof(value));
+    std::memcpy(bytes.data(), &value, sizeof(value));
+    return bytes;
+}
+
+} // namespace
+
+TEST(BlobRead64Test, ReadReachesTheManagerWithTheFullOffset)
+{
+    ManagerMock mgr;
+    struct BmcBlobRead64Tx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = past4GiB;
+    req.requestedSize = 0x10;
+    std::vector<uint8_t> data = {0x02, 0x03, 0x05, 0x06};
+
+    EXPECT_CALL(mgr, read64(0x54, past4GiB, 0x10)).WillOnce(Return(data));
+
+    auto result = validateReply(runCommand(read64Blob, &mgr, toBytes(req)));
+    ASSERT_EQ(sizeof(struct BmcBlobReadRx) + data.size(), result.size());
+    EXPECT_EQ(0, std::memcmp(&result[sizeof(struct BmcBlobReadRx)],
+                             data.data(), data.size()));
+}
+
+TEST(BlobRead64Test, AutoSizedReadEndsWithA64BitTrailer)
+{
+    ManagerMock mgr;
+    struct BmcBlobRead64Tx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = past4GiB;
+    req.requestedSize = 0;
+
+    uint32_t fits = 64 - sizeof(struct BmcBlobReadRx) -
+                    sizeof(struct BmcBlobRead64Trailer);
+    std::vector<uint8_t> data(fits, 0x5a);
+
+    EXPECT_CALL(mgr, read64(0x54, past4GiB, fits)).WillOnce(Return(data));
+    EXPECT_CALL(mgr, getReadSize(0x54, _)).WillOnce(Return(past4GiB + 0x10));
+
+    auto result = validateReply(runCommand(read64Blob, &mgr, toBytes(req)));
+    ASSERT_EQ(64, result.size());
+
+    BmcBlobRead64Trailer trailer;
+    std::memcpy(&trailer, &result[result.size() - sizeof(trailer)],
+                sizeof(trailer));
+    EXPECT_EQ(past4GiB + fits, trailer.nextOffset);
+    EXPECT_EQ(ReadTrailerFlags::endOfBlob, trailer.flags);
+}
+
+TEST(BlobRead64Test, ReadPastTheEndOfTheOffsetSpaceIsRejected)
+{
+    // Its next offset would wrap, so the read never reaches the manager.
+    ManagerMock mgr;
+    struct BmcBlobRead64Tx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = std::numeric_limits<uint64_t>::max();
+    req.requestedSize = 0x10;
+
+    EXPECT_CALL(mgr, read64(_, _, _)).Times(0);
+    EXPECT_EQ(ipmi::ccInvalidFieldRequest,
+              std::get<0>(runCommand(read64Blob, &mgr, toBytes(req))));
+
+    req.requestedSize = 0;
+    EXPECT_EQ(ipmi::ccInvalidFieldRequest,
+              std::get<0>(runCommand(read64Blob, &mgr, toBytes(req))));
+}
+
+TEST(BlobRead64Test, ReadUpToTheEndOfTheOffsetSpaceRuns)
+{
+    ManagerMock mgr;
+    struct BmcBlobRead64Tx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = std::numeric_limits<uint64_t>::max() - 0x10;
+    req.requestedSize = 0x10;
+    std::vector<uint8_t> data(0x10, 0xaa);
+
+    EXPECT_CALL(mgr, read64(0x54, req.offset, 0x10)).WillOnce(Return(data));
+
+    auto result = validateReply(runCommand(read64Blob, &mgr, toBytes(req)));
+    EXPECT_EQ(sizeof(struct BmcBlobReadRx) + data.size(), result.size());
+}
+
+TEST(BlobWrite64Test, WriteReachesTheManagerWithTheFullOffset)
+{
+    ManagerMock mgr;
+    struct BmcBlobWrite64Tx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = past4GiB;
+
+    auto request = toBytes(req);
+    std::array<uint8_t, 2> expectedBytes = {0x66, 0x67};
+    request.insert(request.end(), expectedBytes.begin(), expectedBytes.end());
+
+    EXPECT_CALL(mgr, write64(0x54, past4GiB, ElementsAreArray(expectedBytes)))
+        .WillOnce(Return(false))
+        .WillOnce(Return(true));
+
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(write64Blob, &mgr, request));
+    EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
+              runCommand(write64Blob, &mgr, request));
+}
+
+TEST(BlobStat64Test, StatReportsTheFullSize)
+{
+    ManagerMock mgr;
+    auto request = toBytes(BmcBlobStat64Tx{.crc = 0});
+    request.insert(request.end(), {'a', '\0'});
+
+    EXPECT_CALL(mgr, stat(Matcher<const std::string&>(StrEq("a")),
+                          Matcher<BlobMeta*>(NotNull())))
+        .WillOnce(Invoke([](const std::string&, BlobMeta* meta) {
+            meta->blobState = 0x01;
+            meta->size64 = past4GiB;
+            meta->metadata = {0x0a, 0x0b};
+            return true;
+        }));
+
+    auto result = validateReply(runCommand(stat64Blob, &mgr, request));
+
+    struct BmcBlobStat64Rx rep;
+    ASSERT_EQ(sizeof(rep) + 2, result.size());
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(0x01, rep.blobState);
+    EXPECT_EQ(past4GiB, rep.size);
+    EXPECT_EQ(2, rep.metadataLen);
+    EXPECT_EQ(0x0a, result[sizeof(rep)]);
+}
+
+TEST(BlobStat64Test, SessionStatReportsTheFullSize)
+{
+    ManagerMock mgr;
+    auto request = toBytes(BmcBlobSessionStat64Tx{.crc = 0, .sessionId = 0x54});
+
+    EXPECT_CALL(mgr, stat(Matcher<uint16_t>(0x54),
+                          Matcher<BlobMeta*>(NotNull())))
+        .WillOnce(Invoke([](uint16_t, BlobMeta* meta) {
+            meta->blobState = 0x02;
+            meta->size64 = past4GiB;
+            return true;
+        }));
+
+    auto result = validateReply(runCommand(sessionStat64Blob, &mgr, request));
+
+    struct BmcBlobStat64Rx rep;
+    ASSERT_EQ(sizeof(rep), result.size());
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(0x02, rep.blobState);
+    EXPECT_EQ(past4GiB, rep.size);
+    EXPECT_EQ(0, rep.metadataLen);
+}
+
+TEST(BlobStat64Test, HandlerThatOnlySetsTheSizeIsReportedAsIs)
+{
+    // A handler built before size64 fills in just the 32-bit size.
+    ManagerMock mgr;
+    auto request = toBytes(BmcBlobSessionStat64Tx{.crc = 0, .sessionId = 0x54});
+
+    EXPECT_CALL(mgr, stat(Matcher<uint16_t>(0x54),
+                          Matcher<BlobMeta*>(NotNull())))
+        .WillOnce(Invoke([](uint16_t, BlobMeta* meta) {
+            meta->size = 0x1234;
+            return true;
+        }));
+
+    auto result = validateReply(runCommand(sessionStat64Blob, &mgr, request));
+
+    struct BmcBlobStat64Rx rep;
+    ASSERT_EQ(sizeof(rep), result.size());
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(0x1234, rep.size);
+}
+
+TEST(BlobStat64Test, FailedStatReturnsFailure)
+{
+    ManagerMock mgr;
+    auto request = toBytes(BmcBlobSessionStat64Tx{.crc = 0, .sessionId = 0x54});
+
+    EXPECT_CALL(mgr, stat(Matcher<uint16_t>(0x54),
+                          Matcher<BlobMeta*>(NotNull())))
+        .WillOnce(Return(false));
+
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(sessionStat64Blob, &mgr, request));
+}
+
+} // namespace blobs
@@ -2,6 +2,7 @@
 #include "ipmi.hpp"
 #include "manager_mock.hpp"
 
+#include <array>
 #include <cstring>
 #include <string>
 
@@ -33,7 +34,8 @@ TEST(BlobOpenTest, InvalidRequestLengthReturnsFailure)
     std::memcpy(request.data(), &req, sizeof(struct BmcBlobOpenTx));
     request.insert(request.end(), blobId.begin(), blobId.end());
 
-    EXPECT_EQ(ipmi::responseReqDataLenInvalid(), openBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(openBlob, &mgr, request));
 }
 
 TEST(BlobOpenTest, RequestRejectedReturnsFailure)
@@ -53,7 +55,8 @@ TEST(BlobOpenTest, RequestRejectedReturnsFailure)
 
     EXPECT_CALL(mgr, open(req.flags, StrEq(blobId), _)).WillOnce(Return(false));
 
-    EXPECT_EQ(ipmi::responseUnspecifiedError(), openBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(openBlob, &mgr, request));
 }
 
 TEST(BlobOpenTest, BlobOpenReturnsOk)
@@ -81,7 +84,7 @@ TEST(BlobOpenTest, BlobOpenReturnsOk)
             return true;
         }));
 
-    auto result = validateReply(openBlob(&mgr, request));
+    auto result = validateReply(runCommand(openBlob, &mgr, request));
 
     rep.crc = 0;
     rep.sessionId = returnedSession;
@@ -89,4 +92,48 @@ TEST(BlobOpenTest, BlobOpenReturnsOk)
     EXPECT_EQ(sizeof(rep), result.size());
     EXPECT_EQ(0, std::memcmp(result.data(), &rep, sizeof(rep)));
 }
+
+TEST(BlobOpenTest, NoCrcOpenWithoutChannelIntegrityIsRejected)
+{
+    // Without its crc, nothing would check a request on the session.
+    ManagerMock mgr;
+    std::vector<uint8_t> request;
+    BmcBlobOpenTx req;
+    std::string blobId = "a";
+
+    req.crc = 0;
+    req.flags = OpenFlags::write | OpenFlags::noCrc;
+    request.resize(sizeof(struct BmcBlobOpenTx));
+    std::memcpy(request.data(), &req, sizeof(struct BmcBlobOpenTx));
+    request.insert(request.end(), blobId.begin(), blobId.end());
+    request.emplace_back('\0');
+
+    EXPECT_CALL(mgr, open(_, _, _)).Times(0);
+
+    EXPECT_EQ(ipmi::responseInvalidFieldRequest(),
+              runCommand(openBlob, &mgr, request));
+}
+
+TEST(BlobOpenTest, NoCrcOpenWithChannelIntegrityOpens)
+{
+    ManagerMock mgr;
+    std::vector<uint8_t> request;
+    BmcBlobOpenTx req;
+    std::string blobId = "a";
+
+    req.crc = 0;
+    req.flags = OpenFlags::write | OpenFlags::noCrc;
+    request.resize(sizeof(struct BmcBlobOpenTx));
+    std::memcpy(request.data(), &req, sizeof(struct BmcBlobOpenTx));
+    request.insert(request.end(), blobId.begin(), blobId.end());
+    request.emplace_back('\0');
+
+    EXPECT_CALL(mgr, open(req.flags, StrEq(blobId), NotNull()))
+        .WillOnce(Return(true));
+
+    std::array<uint8_t, 64> buffer{};
+    ResponseWriter reply(buffer);
+    EXPECT_EQ(ipmi::ccSuccess,
+              openBlob(&mgr, RequestBody(request, true, true), reply));
+}
 } // namespace blobs
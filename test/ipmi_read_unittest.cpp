@@ -10,6 +10,10 @@
 namespace blobs
 {
 
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Matcher;
+using ::testing::NotNull;
 using ::testing::Return;
 
 TEST(BlobReadTest, ManagerReturnsNoData)
@@ -31,7 +35,7 @@ TEST(BlobReadTest, ManagerReturnsNoData)
     EXPECT_CALL(mgr, read(req.sessionId, req.offset, req.requestedSize))
         .WillOnce(Return(data));
 
-    auto result = validateReply(readBlob(&mgr, request));
+    auto result = validateReply(runCommand(readBlob, &mgr, request));
     EXPECT_EQ(sizeof(struct BmcBlobReadRx), result.size());
 }
 
@@ -53,13 +57,269 @@ TEST(BlobReadTest, ManagerReturnsData)
     EXPECT_CALL(mgr, read(req.sessionId, req.offset, req.requestedSize))
         .WillOnce(Return(data));
 
-    auto result = validateReply(readBlob(&mgr, request));
+    auto result = validateReply(runCommand(readBlob, &mgr, request));
     EXPECT_EQ(sizeof(struct BmcBlobReadRx) + data.size(), result.size());
     EXPECT_EQ(0, std::memcmp(&result[sizeof(struct BmcBlobReadRx)], data.data(),
                              data.size()));
 }
 
-/* TODO(venture): We need a test that handles other checks such as if the size
- * requested won't fit into a packet response.
- */
+TEST(BlobReadTest, RequestLargerThanReplyIsClamped)
+{
+    // Verify that a request that won't fit in the reply is clamped to the
+    // bytes left after the crc before the manager is asked for it.
+    ManagerMock mgr;
+    std::vector<uint8_t> request;
+    struct BmcBlobReadTx req;
+
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = 0x100;
+    req.requestedSize = 0x1000;
+    request.resize(sizeof(struct BmcBlobReadTx));
+    std::memcpy(request.data(), &req, sizeof(struct BmcBlobReadTx));
+
+    // runCommand replies into a 64 byte buffer.
+    uint32_t fits = 64 - sizeof(struct BmcBlobReadRx);
+    std::vector<uint8_t> data(fits, 0x5a);
+
+    EXPECT_CALL(mgr, read(req.sessionId, req.offset, fits))
+        .WillOnce(Return(data));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, request));
+    EXPECT_EQ(sizeof(struct BmcBlobReadRx) + data.size(), result.size());
+}
+
+TEST(BlobReadTest, ClampReadSizeLeavesRoomForTheCrc)
+{
+    EXPECT_EQ(0x10u, clampReadSize(0x10, 64));
+    EXPECT_EQ(62u, clampReadSize(0x1000, 64));
+    EXPECT_EQ(0u, clampReadSize(0x10, sizeof(struct BmcBlobReadRx)));
+    EXPECT_EQ(0u, clampReadSize(0x10, 0));
+}
+
+TEST(BlobReadTest, AutoSizedReadFillsReplyAndReportsNextOffset)
+{
+    // A requested size of zero reads as much as fits in the reply after the
+    // crc and the trailer, and the trailer gives the next offset.
+    ManagerMock mgr;
+    std::vector<uint8_t> request;
+    struct BmcBlobReadTx req;
+
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = 0x100;
+    req.requestedSize = 0;
+    request.resize(sizeof(struct BmcBlobReadTx));
+    std::memcpy(request.data(), &req, sizeof(struct BmcBlobReadTx));
+
+    uint32_t fits = 64 - sizeof(struct BmcBlobReadRx) -
+                    sizeof(struct BmcBlobReadTrailer);
+    std::vector<uint8_t> data(fits, 0x5a);
+
+    EXPECT_CALL(mgr, read(req.sessionId, req.offset, fits))
+        .WillOnce(Return(data));
+    EXPECT_CALL(mgr, getReadSize(req.sessionId, _)).WillOnce(Return(0x1000));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, request));
+    ASSERT_EQ(64, result.size());
+
+    BmcBlobReadTrailer trailer;
+    std::memcpy(&trailer, &result[result.size() - sizeof(trailer)],
+                sizeof(trailer));
+    EXPECT_EQ(req.offset + fits, trailer.nextOffset);
+    EXPECT_EQ(0, trailer.flags);
+}
+
+TEST(BlobReadTest, AutoSizedShortReadReportsEndOfBlob)
+{
+    // A short auto-sized read from a handler that reports no size means it
+    // ran out of blob.
+    ManagerMock mgr;
+    std::vector<uint8_t> request;
+    struct BmcBlobReadTx req;
+
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = 0x100;
+    req.requestedSize = 0;
+    request.resize(sizeof(struct BmcBlobReadTx));
+    std::memcpy(request.data(), &req, sizeof(struct BmcBlobReadTx));
+    std::vector<uint8_t> data = {0x02, 0x03, 0x05, 0x06};
+
+    EXPECT_CALL(mgr, read(req.sessionId, req.offset, _)).WillOnce(Return(data));
+    EXPECT_CALL(mgr, getReadSize(req.sessionId, _)).WillOnce(Return(0));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, request));
+    ASSERT_EQ(sizeof(struct BmcBlobReadRx) + data.size() +
+                  sizeof(struct BmcBlobReadTrailer),
+              result.size());
+    EXPECT_EQ(0, std::memcmp(&result[sizeof(struct BmcBlobReadRx)], data.data(),
+                             data.size()));
+
+    BmcBlobReadTrailer trailer;
+    std::memcpy(&trailer, &result[result.size() - sizeof(trailer)],
+                sizeof(trailer));
+    EXPECT_EQ(req.offset + data.size(), trailer.nextOffset);
+    EXPECT_EQ(ReadTrailerFlags::endOfBlob, trailer.flags);
+}
+
+TEST(BlobReadTest, AutoSizedShortReadBeforeTheEndIsNotEndOfBlob)
+{
+    // A handler streaming from a pipe or flash may return less than asked
+    // partway through, which isn't the end while the size says more remains.
+    ManagerMock mgr;
+    std::vector<uint8_t> request;
+    struct BmcBlobReadTx req;
+
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = 0x100;
+    req.requestedSize = 0;
+    request.resize(sizeof(struct BmcBlobReadTx));
+    std::memcpy(request.data(), &req, sizeof(struct BmcBlobReadTx));
+    std::vector<uint8_t> data = {0x02, 0x03, 0x05, 0x06};
+
+    EXPECT_CALL(mgr, read(req.sessionId, req.offset, _)).WillOnce(Return(data));
+    EXPECT_CALL(mgr, getReadSize(req.sessionId, _)).WillOnce(Return(0x1000));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, request));
+
+    BmcBlobReadTrailer trailer;
+    std::memcpy(&trailer, &result[result.size() - sizeof(trailer)],
+                sizeof(trailer));
+    EXPECT_EQ(req.offset + data.size(), trailer.nextOffset);
+    EXPECT_EQ(0, trailer.flags);
+}
+
+TEST(BlobReadTest, AutoSizedReadWithoutStatEndsOnAShortRead)
+{
+    // Many handlers can't stat a session, and are treated like one that
+    // reports no size: only a short read is the end of the blob.
+    ManagerMock mgr;
+    std::vector<uint8_t> request;
+    struct BmcBlobReadTx req;
+
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = 0;
+    req.requestedSize = 0;
+    request.resize(sizeof(struct BmcBlobReadTx));
+    std::memcpy(request.data(), &req, sizeof(struct BmcBlobReadTx));
+
+    uint32_t fits = 64 - sizeof(struct BmcBlobReadRx) -
+                    sizeof(struct BmcBlobReadTrailer);
+    std::vector<uint8_t> full(fits, 0x11);
+    std::vector<uint8_t> shortRead = {0x02, 0x03};
+
+    // Only the short read stats the session again.
+    EXPECT_CALL(mgr, read(req.sessionId, req.offset, fits))
+        .WillOnce(Return(full))
+        .WillOnce(Return(shortRead));
+    EXPECT_CALL(mgr, getReadSize(req.sessionId, false)).WillOnce(Return(0));
+    EXPECT_CALL(mgr, getReadSize(req.sessionId, true)).WillOnce(Return(0));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, request));
+    struct BmcBlobReadTrailer trailer;
+    ASSERT_EQ(sizeof(struct BmcBlobReadRx) + full.size() + sizeof(trailer),
+              result.size());
+    std::memcpy(&trailer, &result[result.size() - sizeof(trailer)],
+                sizeof(trailer));
+    EXPECT_EQ(0, trailer.flags);
+
+    result = validateReply(runCommand(readBlob, &mgr, request));
+    ASSERT_EQ(sizeof(struct BmcBlobReadRx) + shortRead.size() + sizeof(trailer),
+              result.size());
+    std::memcpy(&trailer, &result[result.size() - sizeof(trailer)],
+                sizeof(trailer));
+    EXPECT_EQ(ReadTrailerFlags::endOfBlob, trailer.flags);
+}
+
+TEST(BlobReadTest, AutoSizedFullReadAtBlobEndReportsEndOfBlob)
+{
+    // A full read that reaches the size the session reports is also the end.
+    ManagerMock mgr;
+    std::vector<uint8_t> request;
+    struct BmcBlobReadTx req;
+
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = 0;
+    req.requestedSize = 0;
+    request.resize(sizeof(struct BmcBlobReadTx));
+    std::memcpy(request.data(), &req, sizeof(struct BmcBlobReadTx));
+
+    uint32_t fits = 64 - sizeof(struct BmcBlobReadRx) -
+                    sizeof(struct BmcBlobReadTrailer);
+    std::vector<uint8_t> data(fits, 0x5a);
+
+    EXPECT_CALL(mgr, read(req.sessionId, req.offset, fits))
+        .WillOnce(Return(data));
+    EXPECT_CALL(mgr, getReadSize(req.sessionId, _)).WillOnce(Return(fits));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, request));
+
+    BmcBlobReadTrailer trailer;
+    std::memcpy(&trailer, &result[result.size() - sizeof(trailer)],
+                sizeof(trailer));
+    EXPECT_EQ(fits, trailer.nextOffset);
+    EXPECT_EQ(ReadTrailerFlags::endOfBlob, trailer.flags);
+}
+
+TEST(BlobReadTest, AutoSizedReadStopsShortOf4GiBAtTheEnd)
+{
+    // The read is cut so the next offset still fits in 32 bits, and a blob
+    // that ends there is done.
+    ManagerMock mgr;
+    std::vector<uint8_t> request;
+    struct BmcBlobReadTx req;
+
+    uint32_t fits = 64 - sizeof(struct BmcBlobReadRx) -
+                    sizeof(struct BmcBlobReadTrailer);
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = 0xffffffff - fits + 5;
+    req.requestedSize = 0;
+    request.resize(sizeof(struct BmcBlobReadTx));
+    std::memcpy(request.data(), &req, sizeof(struct BmcBlobReadTx));
+    std::vector<uint8_t> data(fits - 5, 0x5a);
+
+    EXPECT_CALL(mgr, read(req.sessionId, req.offset, fits - 5))
+        .WillOnce(Return(data));
+    EXPECT_CALL(mgr, getReadSize(req.sessionId, _))
+        .WillOnce(Return(0xffffffff));
+
+    auto result = validateReply(runCommand(readBlob, &mgr, request));
+
+    BmcBlobReadTrailer trailer;
+    std::memcpy(&trailer, &result[result.size() - sizeof(trailer)],
+                sizeof(trailer));
+    EXPECT_EQ(0xffffffff, trailer.nextOffset);
+    EXPECT_EQ(ReadTrailerFlags::endOfBlob, trailer.flags);
+}
+
+TEST(BlobReadTest, AutoSizedReadReaching4GiBBeforeTheEndFails)
+{
+    // A 32-bit next offset can't go on past 4GiB, so the host is told to
+    // use BmcBlobRead64 rather than sent back to the start of the blob.
+    ManagerMock mgr;
+    std::vector<uint8_t> request;
+    struct BmcBlobReadTx req;
+
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = 0xfffffff0;
+    req.requestedSize = 0;
+    request.resize(sizeof(struct BmcBlobReadTx));
+    std::memcpy(request.data(), &req, sizeof(struct BmcBlobReadTx));
+    std::vector<uint8_t> data(0xf, 0x5a);
+
+    EXPECT_CALL(mgr, read(req.sessionId, req.offset, 0xf))
+        .WillOnce(Return(data));
+    EXPECT_CALL(mgr, getReadSize(req.sessionId, _))
+        .WillOnce(Return(0x200000000));
+
+    EXPECT_EQ(ipmi::responseInvalidFieldRequest(),
+              runCommand(readBlob, &mgr, request));
+}
+
 } // namespace blobs
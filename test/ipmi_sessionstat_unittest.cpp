@@ -36,7 +36,8 @@ TEST(BlobSessionStatTest, RequestRejectedByManagerReturnsFailure)
                 stat(Matcher<uint16_t>(req.sessionId), Matcher<BlobMeta*>(_)))
         .WillOnce(Return(false));
 
-    EXPECT_EQ(ipmi::responseUnspecifiedError(), sessionStatBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(sessionStatBlob, &mgr, request));
 }
 
 TEST(BlobSessionStatTest, RequestSucceedsNoMetadata)
@@ -69,7 +70,7 @@ TEST(BlobSessionStatTest, RequestSucceedsNoMetadata)
             return true;
         }));
 
-    auto result = validateReply(sessionStatBlob(&mgr, request));
+    auto result = validateReply(runCommand(sessionStatBlob, &mgr, request));
 
     EXPECT_EQ(sizeof(rep), result.size());
     EXPECT_EQ(0, std::memcmp(result.data(), &rep, sizeof(rep)));
@@ -109,7 +110,7 @@ TEST(BlobSessionStatTest, RequestSucceedsWithMetadata)
             return true;
         }));
 
-    auto result = validateReply(sessionStatBlob(&mgr, request));
+    auto result = validateReply(runCommand(sessionStatBlob, &mgr, request));
 
     EXPECT_EQ(sizeof(rep) + lmeta.metadata.size(), result.size());
     EXPECT_EQ(0, std::memcmp(result.data(), &rep, sizeof(rep)));
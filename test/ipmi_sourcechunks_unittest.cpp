@@ -0,0 +1,137 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <cstring>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+namespace
+{
+
+std::vector<uint8_t> sourceRequest(uint64_t offset, uint32_t chunkSize,
+                                   size_t count)
+{
+    struct BmcBlobSourceChunksTx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.offset = offset;
+    req.chunkSize = chunkSize;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    // Each chunk's hash is filled with its index.
+    for (size_t i = 0; i < count; ++i)
+    {
+        request.insert(request.end(), chunkHashSize, i);
+    }
+    return request;
+}
+
+} // namespace
+
+TEST(BlobSourceChunksTest, PartialHashIsRejected)
+{
+    ManagerMock mgr;
+    auto request = sourceRequest(0, 0x1000, 1);
+    request.pop_back();
+
+    EXPECT_CALL(mgr, sourceChunks(_, _)).Times(0);
+
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(sourceChunksBlob, &mgr, request));
+}
+
+TEST(BlobSourceChunksTest, NoHashesIsRejected)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, sourceChunks(_, _)).Times(0);
+
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(sourceChunksBlob, &mgr, sourceRequest(0, 0x1000, 0)));
+}
+
+TEST(BlobSourceChunksTest, ZeroChunkSizeIsRejected)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, sourceChunks(_, _)).Times(0);
+
+    EXPECT_EQ(ipmi::responseInvalidFieldRequest(),
+              runCommand(sourceChunksBlob, &mgr, sourceRequest(0, 0, 1)));
+}
+
+TEST(BlobSourceChunksTest, ChunksPastTheOffsetSpaceAreRejected)
+{
+    // The second chunk would wrap around to offset 0.
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, sourceChunks(_, _)).Times(0);
+
+    EXPECT_EQ(ipmi::responseInvalidFieldRequest(),
+              runCommand(sourceChunksBlob, &mgr,
+                         sourceRequest(0xfffffffffffff000, 0x1000, 2)));
+}
+
+TEST(BlobSourceChunksTest, ChunksEndingAtTheLastOffsetAreSourced)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, sourceChunks(0x54, _))
+        .WillOnce(Return(std::vector<bool>{false, false}));
+
+    validateReply(runCommand(sourceChunksBlob, &mgr,
+                             sourceRequest(0xffffffffffffdfff, 0x1000, 2)));
+}
+
+TEST(BlobSourceChunksTest, ManagerFailureReturnsFailure)
+{
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, sourceChunks(0x54, _)).WillOnce(Return(std::nullopt));
+
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(sourceChunksBlob, &mgr,
+                         sourceRequest(0, 0x1000, 2)));
+}
+
+TEST(BlobSourceChunksTest, ChunksFollowEachOtherAndBitmapIsReturned)
+{
+    // Nine chunks, of which the BMC has the first, fourth and ninth.
+    ManagerMock mgr;
+
+    EXPECT_CALL(mgr, sourceChunks(0x54, _))
+        .WillOnce(Invoke([](uint16_t, std::span<const ChunkHash> chunks) {
+            EXPECT_EQ(9, chunks.size());
+            for (size_t i = 0; i < chunks.size(); ++i)
+            {
+                EXPECT_EQ(0x100000000 + i * 0x1000, chunks[i].offset);
+                EXPECT_EQ(0x1000, chunks[i].length);
+                EXPECT_EQ(i, chunks[i].hash[0]);
+                EXPECT_EQ(i, chunks[i].hash[chunkHashSize - 1]);
+            }
+            return std::vector<bool>{true,  false, false, true, false,
+                                     false, false, false, true};
+        }));
+
+    auto result = validateReply(runCommand(
+        sourceChunksBlob, &mgr, sourceRequest(0x100000000, 0x1000, 9)));
+    std::vector<uint8_t> expected = {0x09, 0x01};
+    ASSERT_EQ(sizeof(struct BmcBlobSourceChunksRx) + expected.size(),
+              result.size());
+    EXPECT_EQ(0, std::memcmp(&result[sizeof(struct BmcBlobSourceChunksRx)],
+                             expected.data(), expected.size()));
+}
+
+} // namespace blobs
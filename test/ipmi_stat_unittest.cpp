@@ -36,7 +36,8 @@ TEST(BlobStatTest, InvalidRequestLengthReturnsFailure)
     // Do not include the nul-terminator
     request.insert(request.end(), blobId.begin(), blobId.end());
 
-    EXPECT_EQ(ipmi::responseReqDataLenInvalid(), statBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(statBlob, &mgr, request));
 }
 
 TEST(BlobStatTest, RequestRejectedReturnsFailure)
@@ -58,7 +59,8 @@ TEST(BlobStatTest, RequestRejectedReturnsFailure)
                           Matcher<BlobMeta*>(_)))
         .WillOnce(Return(false));
 
-    EXPECT_EQ(ipmi::responseUnspecifiedError(), statBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(statBlob, &mgr, request));
 }
 
 TEST(BlobStatTest, RequestSucceedsNoMetadata)
@@ -93,7 +95,7 @@ TEST(BlobStatTest, RequestSucceedsNoMetadata)
             return true;
         }));
 
-    auto result = validateReply(statBlob(&mgr, request));
+    auto result = validateReply(runCommand(statBlob, &mgr, request));
 
     EXPECT_EQ(sizeof(rep), result.size());
     EXPECT_EQ(0, std::memcmp(result.data(), &rep, sizeof(rep)));
@@ -135,11 +137,36 @@ TEST(BlobStatTest, RequestSucceedsWithMetadata)
             return true;
         }));
 
-    auto result = validateReply(statBlob(&mgr, request));
+    auto result = validateReply(runCommand(statBlob, &mgr, request));
 
     EXPECT_EQ(sizeof(rep) + lmeta.metadata.size(), result.size());
     EXPECT_EQ(0, std::memcmp(result.data(), &rep, sizeof(rep)));
     EXPECT_EQ(0, std::memcmp(result.data() + sizeof(rep), lmeta.metadata.data(),
                              lmeta.metadata.size()));
 }
+
+TEST(BlobStatTest, SizePast4GiBIsReportedAsTheMaximum)
+{
+    // A blob too large for the 32-bit size field reports 0xffffffff rather
+    // than a truncated size.
+
+    ManagerMock mgr;
+    std::vector<uint8_t> request(sizeof(struct BmcBlobStatTx));
+    request.insert(request.end(), {'a', '\0'});
+
+    EXPECT_CALL(mgr, stat(Matcher<const std::string&>(StrEq("a")),
+                          Matcher<BlobMeta*>(NotNull())))
+        .WillOnce(Invoke([](const std::string&, BlobMeta* meta) {
+            meta->blobState = 0x01;
+            meta->size64 = 0x100000010;
+            return true;
+        }));
+
+    auto result = validateReply(runCommand(statBlob, &mgr, request));
+
+    struct BmcBlobStatRx rep;
+    ASSERT_EQ(sizeof(rep), result.size());
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(0xffffffff, rep.size);
+}
 } // namespace blobs
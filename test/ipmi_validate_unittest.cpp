@@ -1,6 +1,8 @@
 #include "ipmi.hpp"
 #include "manager_mock.hpp"
 
+#include <cstring>
+#include <span>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -40,4 +42,25 @@ TEST(IpmiValidateTest, VerifyCommandMinimumLengths)
         EXPECT_EQ(result, test.expect);
     }
 }
+
+TEST(IpmiValidateTest, SessionIdIsFoundOnSessionCommands)
+{
+    BmcBlobWriteTx req;
+    req.crc = 0x1234;
+    req.sessionId = 0x54;
+    req.offset = 0x100;
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+
+    EXPECT_EQ(0x54, requestSessionId(BlobOEMCommands::bmcBlobWrite, request));
+    EXPECT_EQ(0x54,
+              requestSessionId(BlobOEMCommands::bmcBlobCommit, request));
+    // An open names a blob, and a get-count has no layout at all.
+    EXPECT_FALSE(requestSessionId(BlobOEMCommands::bmcBlobOpen, request));
+    EXPECT_FALSE(
+        requestSessionId(BlobOEMCommands::bmcBlobGetCount, request));
+    // Too short to hold a session id.
+    EXPECT_FALSE(requestSessionId(BlobOEMCommands::bmcBlobWrite,
+                                  std::span(request).first(3)));
+}
 } // namespace blobs
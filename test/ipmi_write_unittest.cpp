@@ -32,7 +32,8 @@ TEST(BlobWriteTest, ManagerReturnsFailureReturnsFailure)
                            ElementsAreArray(expectedBytes)))
         .WillOnce(Return(false));
 
-    EXPECT_EQ(ipmi::responseUnspecifiedError(), writeBlob(&mgr, request));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(writeBlob, &mgr, request));
 }
 
 TEST(BlobWriteTest, ManagerReturnsTrueWriteSucceeds)
@@ -58,6 +59,6 @@ TEST(BlobWriteTest, ManagerReturnsTrueWriteSucceeds)
         .WillOnce(Return(true));
 
     EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
-              writeBlob(&mgr, request));
+              runCommand(writeBlob, &mgr, request));
 }
 } // namespace blobs
@@ -0,0 +1,71 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::ElementsAreArray;
+using ::testing::Return;
+
+namespace
+{
+
+std::vector<uint8_t> appendRequest(uint16_t sessionId, uint8_t sequence,
+                                   std::span<const uint8_t> bytes)
+{
+    struct BmcBlobWriteAppendTx req;
+    req.crc = 0;
+    req.sessionId = sessionId;
+    req.sequence = sequence;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    request.insert(request.end(), bytes.begin(), bytes.end());
+    return request;
+}
+
+} // namespace
+
+TEST(BlobWriteAppendTest, ManagerReturnsFailureReturnsFailure)
+{
+    ManagerMock mgr;
+    std::array<uint8_t, 2> expectedBytes = {0x66, 0x67};
+
+    EXPECT_CALL(mgr, writeAppend(0x54, 7, ElementsAreArray(expectedBytes)))
+        .WillOnce(Return(false));
+
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(writeAppendBlob, &mgr,
+                         appendRequest(0x54, 7, expectedBytes)));
+}
+
+TEST(BlobWriteAppendTest, ManagerReturnsTrueWriteSucceeds)
+{
+    ManagerMock mgr;
+    std::array<uint8_t, 2> expectedBytes = {0x66, 0x67};
+
+    EXPECT_CALL(mgr, writeAppend(0x54, 0, ElementsAreArray(expectedBytes)))
+        .WillOnce(Return(true));
+
+    EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
+              runCommand(writeAppendBlob, &mgr,
+                         appendRequest(0x54, 0, expectedBytes)));
+}
+
+TEST(BlobWriteAppendTest, MissingDataReturnsFailure)
+{
+    // Like BmcBlobWrite, there must be at least one byte to write.
+    ManagerMock mgr;
+
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(writeAppendBlob, &mgr, appendRequest(0x54, 0, {})));
+}
+} // namespace blobs
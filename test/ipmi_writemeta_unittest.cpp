@@ -1,3 +1,4 @@
+#include "helper.hpp"
 #include "ipmi.hpp"
 #include "manager_mock.hpp"
 
@@ -35,7 +36,8 @@ TEST(BlobWriteMetaTest, ManagerReturnsFailureReturnsFailure)
                                ElementsAreArray(expectedBytes)))
         .WillOnce(Return(false));
 
-    EXPECT_EQ(ipmi::responseUnspecifiedError(), writeMeta(&mgr, request));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(writeMeta, &mgr, request));
 }
 
 TEST(BlobWriteMetaTest, ManagerReturnsTrueWriteSucceeds)
@@ -60,6 +62,6 @@ TEST(BlobWriteMetaTest, ManagerReturnsTrueWriteSucceeds)
         .WillOnce(Return(true));
 
     EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
-              writeMeta(&mgr, request));
+              runCommand(writeMeta, &mgr, request));
 }
 } // namespace blobs
@@ -0,0 +1,112 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+namespace
+{
+
+std::vector<uint8_t> vectoredRequest(uint16_t sessionId, uint8_t count)
+{
+    struct BmcBlobWriteVectoredTx req;
+    req.crc = 0;
+    req.sessionId = sessionId;
+    req.count = count;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    return request;
+}
+
+void addSegment(std::vector<uint8_t>& request, uint64_t offset,
+                const std::vector<uint8_t>& bytes)
+{
+    struct BmcBlobWriteSegment segment;
+    segment.offset = offset;
+    segment.length = bytes.size();
+
+    size_t at = request.size();
+    request.resize(at + sizeof(segment));
+    std::memcpy(&request[at], &segment, sizeof(segment));
+    request.insert(request.end(), bytes.begin(), bytes.end());
+}
+
+} // namespace
+
+TEST(BlobWriteVectoredTest, SegmentsReachTheManagerInOneCall)
+{
+    ManagerMock mgr;
+    std::vector<uint8_t> first = {0x11, 0x22};
+    std::vector<uint8_t> second = {0x33, 0x44, 0x55};
+
+    auto request = vectoredRequest(0x54, 2);
+    addSegment(request, 0x100, first);
+    addSegment(request, 0x100000040, second);
+
+    EXPECT_CALL(mgr, writeVectored(0x54, _))
+        .WillOnce(Invoke([&](uint16_t, std::span<const WriteSegment> s) {
+            EXPECT_EQ(2, s.size());
+            EXPECT_EQ(0x100, s[0].offset);
+            EXPECT_EQ(first,
+                      std::vector<uint8_t>(s[0].data.begin(), s[0].data.end()));
+            EXPECT_EQ(0x100000040, s[1].offset);
+            EXPECT_EQ(second,
+                      std::vector<uint8_t>(s[1].data.begin(), s[1].data.end()));
+            return true;
+        }));
+
+    EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
+              runCommand(writeVectoredBlob, &mgr, request));
+}
+
+TEST(BlobWriteVectoredTest, ManagerReturnsFailureReturnsFailure)
+{
+    ManagerMock mgr;
+    auto request = vectoredRequest(0x54, 1);
+    addSegment(request, 0, {0x11});
+
+    EXPECT_CALL(mgr, writeVectored(0x54, _)).WillOnce(Return(false));
+
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(writeVectoredBlob, &mgr, request));
+}
+
+TEST(BlobWriteVectoredTest, ShortSegmentIsRejected)
+{
+    // The last segment claims more bytes than the request has.
+    ManagerMock mgr;
+    auto request = vectoredRequest(0x54, 2);
+    addSegment(request, 0, {0x11});
+    addSegment(request, 8, {0x22, 0x33});
+    request.pop_back();
+
+    EXPECT_CALL(mgr, writeVectored(_, _)).Times(0);
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(writeVectoredBlob, &mgr, request));
+}
+
+TEST(BlobWriteVectoredTest, BytesPastTheLastSegmentAreRejected)
+{
+    ManagerMock mgr;
+    auto request = vectoredRequest(0x54, 1);
+    addSegment(request, 0, {0x11});
+    addSegment(request, 8, {0x22});
+
+    EXPECT_CALL(mgr, writeVectored(_, _)).Times(0);
+    EXPECT_EQ(ipmi::responseReqDataLenInvalid(),
+              runCommand(writeVectoredBlob, &mgr, request));
+}
+
+} // namespace blobs
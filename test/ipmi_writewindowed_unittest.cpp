@@ -0,0 +1,84 @@
+#include "helper.hpp"
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::ElementsAreArray;
+using ::testing::Return;
+
+TEST(BlobWriteWindowedTest, WriteIsPassedToTheManager)
+{
+    ManagerMock mgr;
+    struct BmcBlobWriteWindowedTx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+    req.sequence = 3;
+    // The offset is 64 bits wide.
+    req.offset = 0x100000100;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    std::array<uint8_t, 2> expectedBytes = {0x66, 0x67};
+    request.insert(request.end(), expectedBytes.begin(), expectedBytes.end());
+
+    EXPECT_CALL(mgr, writeWindowed(req.sessionId, req.sequence, req.offset,
+                                   ElementsAreArray(expectedBytes)))
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+
+    EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>{}),
+              runCommand(writeWindowedBlob, &mgr, request));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(writeWindowedBlob, &mgr, request));
+}
+
+TEST(BlobWriteAckTest, ReturnsTheWindow)
+{
+    ManagerMock mgr;
+    struct BmcBlobWriteAckTx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+
+    WriteWindow window;
+    window.base = 7;
+    window.received = 0b1010;
+    EXPECT_CALL(mgr, getWriteWindow(req.sessionId)).WillOnce(Return(window));
+
+    auto result = validateReply(runCommand(writeAckBlob, &mgr, request));
+
+    struct BmcBlobWriteAckRx rep;
+    ASSERT_EQ(sizeof(rep), result.size());
+    std::memcpy(&rep, result.data(), sizeof(rep));
+    EXPECT_EQ(7, rep.base);
+    EXPECT_EQ(0b1010u, rep.received);
+}
+
+TEST(BlobWriteAckTest, NoSessionReturnsFailure)
+{
+    ManagerMock mgr;
+    struct BmcBlobWriteAckTx req;
+    req.crc = 0;
+    req.sessionId = 0x54;
+
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+
+    EXPECT_CALL(mgr, getWriteWindow(req.sessionId))
+        .WillOnce(Return(std::nullopt));
+    EXPECT_EQ(ipmi::responseUnspecifiedError(),
+              runCommand(writeAckBlob, &mgr, request));
+}
+} // namespace blobs
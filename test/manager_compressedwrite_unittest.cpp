@@ -0,0 +1,210 @@
+#include "blob_mock.hpp"
+#include "compress.hpp"
+#include "manager.hpp"
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+namespace
+{
+
+/* A blob of short repeated records, which compresses well. */
+std::vector<uint8_t> makeImage()
+{
+    std::vector<uint8_t> image;
+    for (int i = 0; i < 64; ++i)
+    {
+        image.insert(image.end(), {'b', 'l', 'o', 'b', '0'});
+        image.push_back(static_cast<uint8_t>('0' + i % 10));
+    }
+    return image;
+}
+
+/* Collect what the handler is asked to write, checking it's in order. */
+void expectWrites(BlobMock* m1ptr, uint16_t sess,
+                  std::vector<uint8_t>* received)
+{
+    EXPECT_CALL(*m1ptr, write(sess, _, _))
+        .WillRepeatedly(Invoke([received](uint16_t, uint32_t offset,
+                                          const std::vector<uint8_t>& data) {
+            EXPECT_EQ(received->size(), offset);
+            received->insert(received->end(), data.begin(), data.end());
+            return true;
+        }));
+}
+
+uint16_t openCompressed(BlobManager& mgr, BlobMock* m1ptr,
+                        const std::string& path)
+{
+    uint16_t sess;
+    // The handler isn't told the stream is compressed.
+    EXPECT_CALL(*m1ptr, open(_, OpenFlags::write, path))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(
+        mgr.open(OpenFlags::write | OpenFlags::compressedWrite, path, &sess));
+    return sess;
+}
+
+} // namespace
+
+TEST(ManagerCompressedWriteTest, WritesAreExpandedForTheHandler)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> image = makeImage();
+    std::vector<uint8_t> stream = lzCompress(image);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+
+    std::vector<uint8_t> received;
+    uint16_t sess = openCompressed(mgr, m1ptr, path);
+    expectWrites(m1ptr, sess, &received);
+
+    std::span<const uint8_t> view = stream;
+    for (size_t offset = 0; offset < stream.size(); offset += 10)
+    {
+        size_t n = std::min<size_t>(10, stream.size() - offset);
+        EXPECT_TRUE(mgr.write(sess, offset, view.subspan(offset, n)));
+    }
+    EXPECT_EQ(image, received);
+}
+
+TEST(ManagerCompressedWriteTest, RetriedWriteIsNotExpandedAgain)
+{
+    // The host resends a write whose reply it didn't see, which succeeds
+    // without passing the handler the same bytes twice.
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> image = makeImage();
+    std::vector<uint8_t> stream = lzCompress(image);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+
+    std::vector<uint8_t> received;
+    uint16_t sess = openCompressed(mgr, m1ptr, path);
+    expectWrites(m1ptr, sess, &received);
+
+    std::span<const uint8_t> view = stream;
+    for (size_t offset = 0; offset < stream.size(); offset += 10)
+    {
+        size_t n = std::min<size_t>(10, stream.size() - offset);
+        EXPECT_TRUE(mgr.write(sess, offset, view.subspan(offset, n)));
+        EXPECT_TRUE(mgr.write(sess, offset, view.subspan(offset, n)));
+    }
+    EXPECT_EQ(image, received);
+
+    // Only the last write can be retried.
+    EXPECT_FALSE(mgr.write(sess, 0, view.first(10)));
+}
+
+TEST(ManagerCompressedWriteTest, AppendWritesAreExpandedForTheHandler)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> image = makeImage();
+    std::vector<uint8_t> stream = lzCompress(image);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+
+    std::vector<uint8_t> received;
+    uint16_t sess = openCompressed(mgr, m1ptr, path);
+    expectWrites(m1ptr, sess, &received);
+
+    std::span<const uint8_t> view = stream;
+    uint8_t sequence = 0;
+    for (size_t offset = 0; offset < stream.size(); offset += 10)
+    {
+        size_t n = std::min<size_t>(10, stream.size() - offset);
+        EXPECT_TRUE(mgr.writeAppend(sess, sequence, view.subspan(offset, n)));
+        // A retry isn't expanded a second time.
+        EXPECT_TRUE(mgr.writeAppend(sess, sequence, view.subspan(offset, n)));
+        sequence++;
+    }
+    EXPECT_EQ(image, received);
+}
+
+TEST(ManagerCompressedWriteTest, OutOfOrderWriteIsRejected)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> image = makeImage();
+    std::vector<uint8_t> stream = lzCompress(image);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+
+    uint16_t sess = openCompressed(mgr, m1ptr, path);
+
+    EXPECT_CALL(*m1ptr, write(_, _, _)).Times(0);
+    EXPECT_FALSE(mgr.write(sess, 4, std::span(stream).subspan(4, 4)));
+    EXPECT_FALSE(mgr.writeWindowed(sess, 0, 0, stream));
+}
+
+TEST(ManagerCompressedWriteTest, HandlerFailureEndsTheStream)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> image = makeImage();
+    std::vector<uint8_t> stream = lzCompress(image);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+
+    uint16_t sess = openCompressed(mgr, m1ptr, path);
+
+    EXPECT_CALL(*m1ptr, write(sess, 0, _)).WillOnce(Return(false));
+    EXPECT_FALSE(mgr.write(sess, 0, stream));
+    EXPECT_FALSE(mgr.write(sess, 0, stream));
+}
+
+TEST(ManagerCompressedWriteTest, RawSessionIsNotExpanded)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> image = makeImage();
+    std::vector<uint8_t> stream = lzCompress(image);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, OpenFlags::write, path))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, 0, stream)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.write(sess, 0, stream));
+}
+} // namespace blobs
@@ -0,0 +1,211 @@
+#include "blob_mock.hpp"
+#include "manager.hpp"
+
+#include <openssl/evp.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::InSequence;
+using ::testing::Return;
+
+TEST(ManagerDigestTest, NoSessionReturnsNothing)
+{
+    BlobManager mgr;
+
+    EXPECT_FALSE(mgr.digest(1, DigestAlgorithm::crc32c, 0, 0x100));
+}
+
+TEST(ManagerDigestTest, OffsetOverflowReturnsNothing)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+
+    EXPECT_CALL(*m1ptr, digest(_, _, _, _)).Times(0);
+    EXPECT_FALSE(
+        mgr.digest(sess, DigestAlgorithm::crc32c, 0xffffffffffffff00, 0x200));
+}
+
+TEST(ManagerDigestTest, HandlerDigestIsUsed)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+    std::vector<uint8_t> digest(32, 0x5a);
+
+    EXPECT_CALL(*m1ptr, digest(sess, DigestAlgorithm::sha256, 0x100, 0x1000))
+        .WillOnce(Return(digest));
+    EXPECT_CALL(*m1ptr, read(_, _, _)).Times(0);
+
+    EXPECT_EQ(digest, mgr.digest(sess, DigestAlgorithm::sha256, 0x100, 0x1000));
+}
+
+TEST(ManagerDigestTest, FallbackStreamsReadsInChunks)
+{
+    // Without a handler digest, the range is read back in chunks and hashed
+    // as it goes.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+    std::vector<uint8_t> data(digestReadSize + 0x100, 0xa5);
+
+    EXPECT_CALL(*m1ptr, digest(_, _, _, _)).WillOnce(Return(std::nullopt));
+    {
+        InSequence seq;
+        EXPECT_CALL(*m1ptr, read(sess, 0x10, digestReadSize))
+            .WillOnce(Return(std::vector<uint8_t>(digestReadSize, 0xa5)));
+        EXPECT_CALL(*m1ptr, read(sess, 0x10 + digestReadSize, 0x100))
+            .WillOnce(Return(std::vector<uint8_t>(0x100, 0xa5)));
+    }
+
+    std::vector<uint8_t> expected(EVP_MAX_MD_SIZE);
+    unsigned int size = 0;
+    ASSERT_TRUE(EVP_Digest(data.data(), data.size(), expected.data(), &size,
+                           EVP_sha256(), nullptr));
+    expected.resize(size);
+
+    EXPECT_EQ(expected,
+              mgr.digest(sess, DigestAlgorithm::sha256, 0x10, data.size()));
+}
+
+TEST(ManagerDigestTest, FallbackCrcIsLittleEndian)
+{
+    // A short read is followed by a read for the rest of the range.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+
+    EXPECT_CALL(*m1ptr, digest(_, _, _, _)).WillOnce(Return(std::nullopt));
+    {
+        InSequence seq;
+        EXPECT_CALL(*m1ptr, read(sess, 0, 9))
+            .WillOnce(Return(std::vector<uint8_t>{'1', '2', '3', '4'}));
+        EXPECT_CALL(*m1ptr, read(sess, 4, 5))
+            .WillOnce(Return(std::vector<uint8_t>{'5', '6', '7', '8', '9'}));
+    }
+
+    std::vector<uint8_t> expected = {0x83, 0x92, 0x06, 0xe3};
+    EXPECT_EQ(expected, mgr.digest(sess, DigestAlgorithm::crc32c, 0, 9));
+}
+
+TEST(ManagerDigestTest, FallbackEmptyReadReturnsNothing)
+{
+    // A range that runs past the end of the blob cannot be digested.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+
+    EXPECT_CALL(*m1ptr, digest(_, _, _, _)).WillOnce(Return(std::nullopt));
+    {
+        InSequence seq;
+        EXPECT_CALL(*m1ptr, read(sess, 0, 0x100))
+            .WillOnce(Return(std::vector<uint8_t>(0x80, 0)));
+        EXPECT_CALL(*m1ptr, read(sess, 0x80, 0x80))
+            .WillOnce(Return(std::vector<uint8_t>()));
+    }
+
+    EXPECT_FALSE(mgr.digest(sess, DigestAlgorithm::crc32c, 0, 0x100));
+}
+
+TEST(ManagerDigestTest, FallbackNeedsAReadSession)
+{
+    // A write-only session can't be read back, though the handler may still
+    // digest it.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, digest(_, _, _, _)).WillOnce(Return(std::nullopt));
+    EXPECT_CALL(*m1ptr, read(_, _, _)).Times(0);
+    EXPECT_FALSE(mgr.digest(sess, DigestAlgorithm::crc32c, 0, 0x100));
+}
+
+TEST(ManagerDigestTest, FallbackLongerThanTheReadLimitReturnsNothing)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+
+    EXPECT_CALL(*m1ptr, digest(_, _, _, _)).WillOnce(Return(std::nullopt));
+    EXPECT_CALL(*m1ptr, read(_, _, _)).Times(0);
+    EXPECT_FALSE(mgr.digest(sess, DigestAlgorithm::sha256, 0,
+                            maxDigestReadLength + 1));
+}
+} // namespace blobs
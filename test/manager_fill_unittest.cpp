@@ -0,0 +1,227 @@
+#include "blob_mock.hpp"
+#include "manager.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::AllOf;
+using ::testing::Each;
+using ::testing::InSequence;
+using ::testing::Return;
+using ::testing::SizeIs;
+
+TEST(ManagerFillTest, NoSessionReturnsFalse)
+{
+    BlobManager mgr;
+
+    EXPECT_FALSE(mgr.fill(1, 0, 0x100, 0xff));
+}
+
+TEST(ManagerFillTest, ReadOnlySessionReturnsFalse)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+
+    EXPECT_CALL(*m1ptr, fill(_, _, _, _)).Times(0);
+    EXPECT_FALSE(mgr.fill(sess, 0, 0x100, 0xff));
+}
+
+TEST(ManagerFillTest, HandlerFillsAndTheSpanIsWritten)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, fill(sess, 0x100, 0x10000, 0xff))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(mgr.fill(sess, 0x100, 0x10000, 0xff));
+
+    auto missing = mgr.getMissingRanges(sess, 0, 0x20000, 4);
+    ASSERT_TRUE(missing);
+    ASSERT_EQ(2, missing->size());
+    EXPECT_EQ(0, (*missing)[0].offset);
+    EXPECT_EQ(0x100, (*missing)[0].length);
+    EXPECT_EQ(0x10100, (*missing)[1].offset);
+}
+
+TEST(ManagerFillTest, FailedFillIsNotCountedAsWritten)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, fill(sess, 0, 0x100, 0xff)).WillOnce(Return(false));
+    EXPECT_FALSE(mgr.fill(sess, 0, 0x100, 0xff));
+
+    auto missing = mgr.getMissingRanges(sess, 0, 0x100, 4);
+    ASSERT_TRUE(missing);
+    EXPECT_EQ(1, missing->size());
+}
+
+TEST(ManagerFillTest, FillPastTheOffsetSpaceIsRejected)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, fill(_, _, _, _)).Times(0);
+    EXPECT_FALSE(mgr.fill(sess, 0xffffffffffffff00, 0x101, 0xff));
+}
+
+TEST(ManagerFillTest, FillPastTheLengthLimitIsRejected)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, fill(sess, 0, maxFillLength, 0xff))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(mgr.fill(sess, 0, maxFillLength, 0xff));
+
+    EXPECT_CALL(*m1ptr, fill(sess, 0, maxFillLength + 1, 0xff)).Times(0);
+    EXPECT_FALSE(mgr.fill(sess, 0, maxFillLength + 1, 0xff));
+}
+
+TEST(ManagerFillTest, CompressedSessionIsRejected)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write | OpenFlags::compressedWrite, path,
+                         &sess));
+
+    EXPECT_CALL(*m1ptr, fill(_, _, _, _)).Times(0);
+    EXPECT_FALSE(mgr.fill(sess, 0, 0x100, 0xff));
+}
+
+TEST(ManagerFillFallbackTest, DefaultFillWritesInChunks)
+{
+    // A handler without its own fill() gets the pattern through write().
+    BlobManager mgr;
+    auto m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    {
+        InSequence seq;
+        EXPECT_CALL(*m1ptr, write(sess, 0x10, AllOf(SizeIs(fillChunkSize),
+                                                    Each(0xff))))
+            .WillOnce(Return(true));
+        EXPECT_CALL(*m1ptr,
+                    write(sess, 0x10 + fillChunkSize,
+                          AllOf(SizeIs(fillChunkSize), Each(0xff))))
+            .WillOnce(Return(true));
+        EXPECT_CALL(*m1ptr, write(sess, 0x10 + 2 * fillChunkSize,
+                                  AllOf(SizeIs(5), Each(0xff))))
+            .WillOnce(Return(true));
+    }
+
+    EXPECT_TRUE(mgr.fill(sess, 0x10, 2 * fillChunkSize + 5, 0xff));
+}
+
+TEST(ManagerFillFallbackTest, DefaultFillStopsAtTheFirstFailedWrite)
+{
+    BlobManager mgr;
+    auto m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, 0, _)).WillOnce(Return(false));
+    EXPECT_FALSE(mgr.fill(sess, 0, 3 * fillChunkSize, 0x00));
+}
+
+TEST(ManagerFillFallbackTest, DefaultFillPastTheOffsetSpaceIsRejected)
+{
+    // The default is a public method of the handler, so it checks the span
+    // itself rather than rely on the manager to.
+    BlobMock blob;
+
+    EXPECT_CALL(blob, write(_, _, _)).Times(0);
+    EXPECT_FALSE(blob.fill(1, 0xffffffffffffff00, 0x101, 0xff));
+}
+
+TEST(ManagerFillFallbackTest, DefaultFillPastTheLengthLimitIsRejected)
+{
+    BlobMock blob;
+
+    EXPECT_CALL(blob, write(_, _, _)).Times(0);
+    EXPECT_FALSE(blob.fill(1, 0, maxFillLength + 1, 0xff));
+}
+
+} // namespace blobs
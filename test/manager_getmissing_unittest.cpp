@@ -0,0 +1,188 @@
+#include "blob_mock.hpp"
+#include "manager.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Return;
+
+TEST(ManagerGetMissingTest, NoSessionReturnsNothing)
+{
+    BlobManager mgr;
+
+    EXPECT_FALSE(mgr.getMissingRanges(1, 0, 64, 8));
+}
+
+TEST(ManagerGetMissingTest, ReadOnlySessionReturnsNothing)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+    EXPECT_FALSE(mgr.getMissingRanges(sess, 0, 64, 8));
+}
+
+TEST(ManagerGetMissingTest, EveryKindOfWriteIsTracked)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data(16, 0x5a);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, _, data)).WillRepeatedly(Return(true));
+    EXPECT_TRUE(mgr.writeAppend(sess, 0, data));
+    EXPECT_TRUE(mgr.write(sess, 32, data));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 1, 64, data));
+
+    auto missing = mgr.getMissingRanges(sess, 0, 100, 8);
+    ASSERT_TRUE(missing);
+    ASSERT_EQ(3, missing->size());
+    EXPECT_EQ(16, (*missing)[0].offset);
+    EXPECT_EQ(16, (*missing)[0].length);
+    EXPECT_EQ(48, (*missing)[1].offset);
+    EXPECT_EQ(16, (*missing)[1].length);
+    EXPECT_EQ(80, (*missing)[2].offset);
+    EXPECT_EQ(20, (*missing)[2].length);
+}
+
+TEST(ManagerGetMissingTest, FailedWriteIsNotTracked)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data(16, 0x5a);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, 0, data)).WillOnce(Return(false));
+    EXPECT_FALSE(mgr.write(sess, 0, data));
+
+    auto missing = mgr.getMissingRanges(sess, 0, 16, 8);
+    ASSERT_TRUE(missing);
+    ASSERT_EQ(1, missing->size());
+    EXPECT_EQ(0, (*missing)[0].offset);
+    EXPECT_EQ(16, (*missing)[0].length);
+}
+
+TEST(ManagerGetMissingTest, EachSessionTracksItsOwnWrites)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data(16, 0x5a);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t first, second;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &first));
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &second));
+
+    EXPECT_CALL(*m1ptr, write(first, 0, data)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.write(first, 0, data));
+
+    auto missing = mgr.getMissingRanges(first, 0, 16, 8);
+    ASSERT_TRUE(missing);
+    EXPECT_TRUE(missing->empty());
+
+    missing = mgr.getMissingRanges(second, 0, 16, 8);
+    ASSERT_TRUE(missing);
+    EXPECT_EQ(1, missing->size());
+}
+
+TEST(ManagerGetMissingTest, WriteStartingAnotherRangePastTheLimitStopsTracking)
+{
+    // Tracking never fails a write.  Once there are too many ranges, the
+    // write still lands and the session can no longer report its gaps.
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data(16, 0x5a);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    // Every other 16 bytes, so no two writes touch.
+    EXPECT_CALL(*m1ptr, write(sess, _, data)).WillRepeatedly(Return(true));
+    for (uint32_t i = 0; i < maxWrittenRanges; ++i)
+    {
+        EXPECT_TRUE(mgr.write(sess, i * 32, data));
+    }
+    EXPECT_TRUE(mgr.getMissingRanges(sess, 0, maxWrittenRanges * 32, 1));
+
+    EXPECT_TRUE(mgr.write(sess, maxWrittenRanges * 32, data));
+    EXPECT_FALSE(mgr.getMissingRanges(sess, 0, maxWrittenRanges * 32, 1));
+
+    // Later writes still land.
+    EXPECT_TRUE(mgr.write(sess, 16, data));
+    EXPECT_FALSE(mgr.getMissingRanges(sess, 0, maxWrittenRanges * 32, 1));
+}
+
+TEST(ManagerGetMissingTest, FillPastTheLimitStopsTracking)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data(16, 0x5a);
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, _, data)).WillRepeatedly(Return(true));
+    for (uint32_t i = 0; i < maxWrittenRanges; ++i)
+    {
+        EXPECT_TRUE(mgr.write(sess, i * 32, data));
+    }
+
+    EXPECT_CALL(*m1ptr, fill(sess, maxWrittenRanges * 32, 16, 0xff))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(mgr.fill(sess, maxWrittenRanges * 32, 16, 0xff));
+    EXPECT_FALSE(mgr.getMissingRanges(sess, 0, maxWrittenRanges * 32, 1));
+}
+} // namespace blobs
@@ -0,0 +1,51 @@
+#include "blob_mock.hpp"
+#include "manager.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Return;
+
+TEST(ManagerGetSessionLimitsTest, NoSessionsOpen)
+{
+    // A new manager reports the session limit and timeout it was built with
+    // and no open sessions.
+
+    BlobManager mgr(std::chrono::seconds(30));
+
+    SessionLimits limits = mgr.getSessionLimits();
+    EXPECT_EQ(maxSessions, limits.maxSessions);
+    EXPECT_EQ(0, limits.openSessions);
+    EXPECT_EQ(std::chrono::seconds(30), limits.timeout);
+}
+
+TEST(ManagerGetSessionLimitsTest, CountsOpenSessions)
+{
+    // Each open adds a session and each close removes one.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    uint16_t flags = OpenFlags::read, first, second;
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(_)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, flags, _)).WillRepeatedly(Return(true));
+    EXPECT_TRUE(mgr.open(flags, "/asdf/a", &first));
+    EXPECT_TRUE(mgr.open(flags, "/asdf/b", &second));
+    EXPECT_EQ(2, mgr.getSessionLimits().openSessions);
+
+    EXPECT_CALL(*m1ptr, close(first)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.close(first));
+    EXPECT_EQ(1, mgr.getSessionLimits().openSessions);
+    EXPECT_EQ(maxSessions, mgr.getSessionLimits().maxSessions);
+}
+} // namespace blobs
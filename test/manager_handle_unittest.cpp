@@ -0,0 +1,139 @@
+#include "blob_mock.hpp"
+#include "manager.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Matcher;
+using ::testing::Return;
+
+namespace
+{
+
+/* Register two handlers owning "/a", "/b" and "/c" respectively. Handles are
+ * resolved through the blobId cache, never by asking each handler about the
+ * name.
+ */
+void registerTwoHandlers(BlobManager& mgr, BlobMock** m1ptr, BlobMock** m2ptr)
+{
+    auto m1 = std::make_unique<BlobMock>();
+    auto m2 = std::make_unique<BlobMock>();
+    *m1ptr = m1.get();
+    *m2ptr = m2.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+    EXPECT_TRUE(mgr.registerHandler(std::move(m2)));
+
+    EXPECT_CALL(**m1ptr, getBlobIds())
+        .WillRepeatedly(Return(std::vector<std::string>{"/a", "/b"}));
+    EXPECT_CALL(**m2ptr, getBlobIds())
+        .WillRepeatedly(Return(std::vector<std::string>{"/c"}));
+
+    EXPECT_CALL(**m1ptr, canHandleBlob(_)).Times(0);
+    EXPECT_CALL(**m2ptr, canHandleBlob(_)).Times(0);
+}
+
+} // namespace
+
+TEST(ManagerHandleTest, HandlesAreInvalidPastTheEndOfTheList)
+{
+    BlobManager mgr;
+    BlobMock *m1ptr, *m2ptr;
+    registerTwoHandlers(mgr, &m1ptr, &m2ptr);
+
+    EXPECT_EQ(3, mgr.buildBlobList());
+    EXPECT_NE(invalidBlobHandle, mgr.getBlobHandle(2));
+    EXPECT_EQ(invalidBlobHandle, mgr.getBlobHandle(3));
+}
+
+TEST(ManagerHandleTest, HandlesCountUpWithTheIndex)
+{
+    BlobManager mgr;
+    BlobMock *m1ptr, *m2ptr;
+    registerTwoHandlers(mgr, &m1ptr, &m2ptr);
+
+    mgr.buildBlobList();
+    EXPECT_EQ(mgr.getBlobHandle(0) + 1, mgr.getBlobHandle(1));
+    EXPECT_EQ(mgr.getBlobHandle(0) + 2, mgr.getBlobHandle(2));
+}
+
+TEST(ManagerHandleTest, StatHandleGoesToTheOwningHandler)
+{
+    BlobManager mgr;
+    BlobMock *m1ptr, *m2ptr;
+    registerTwoHandlers(mgr, &m1ptr, &m2ptr);
+
+    mgr.buildBlobList();
+
+    BlobMeta meta;
+    EXPECT_CALL(*m2ptr, stat("/c", &meta)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.statHandle(mgr.getBlobHandle(2), &meta));
+}
+
+TEST(ManagerHandleTest, OpenHandleOpensTheNamedBlob)
+{
+    BlobManager mgr;
+    BlobMock *m1ptr, *m2ptr;
+    registerTwoHandlers(mgr, &m1ptr, &m2ptr);
+
+    mgr.buildBlobList();
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, OpenFlags::read, "/b")).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.openHandle(OpenFlags::read, mgr.getBlobHandle(1), &sess));
+
+    // The blob is now open, so it can't be deleted.
+    EXPECT_CALL(*m1ptr, deleteBlob(_)).Times(0);
+    EXPECT_FALSE(mgr.deleteHandle(mgr.getBlobHandle(1)));
+}
+
+TEST(ManagerHandleTest, DeleteHandleDeletesTheNamedBlob)
+{
+    BlobManager mgr;
+    BlobMock *m1ptr, *m2ptr;
+    registerTwoHandlers(mgr, &m1ptr, &m2ptr);
+
+    mgr.buildBlobList();
+
+    EXPECT_CALL(*m1ptr, deleteBlob("/a")).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.deleteHandle(mgr.getBlobHandle(0)));
+}
+
+TEST(ManagerHandleTest, RebuildingTheListInvalidatesHandles)
+{
+    BlobManager mgr;
+    BlobMock *m1ptr, *m2ptr;
+    registerTwoHandlers(mgr, &m1ptr, &m2ptr);
+
+    mgr.buildBlobList();
+    uint32_t stale = mgr.getBlobHandle(0);
+
+    mgr.buildBlobList();
+    EXPECT_NE(stale, mgr.getBlobHandle(0));
+
+    BlobMeta meta;
+    EXPECT_CALL(*m1ptr, stat(Matcher<const std::string&>(_), &meta)).Times(0);
+    EXPECT_FALSE(mgr.statHandle(stale, &meta));
+}
+
+TEST(ManagerHandleTest, InvalidHandleIsRejected)
+{
+    BlobManager mgr;
+    BlobMock *m1ptr, *m2ptr;
+    registerTwoHandlers(mgr, &m1ptr, &m2ptr);
+
+    mgr.buildBlobList();
+
+    uint16_t sess;
+    BlobMeta meta;
+    EXPECT_FALSE(mgr.openHandle(OpenFlags::read, invalidBlobHandle, &sess));
+    EXPECT_FALSE(mgr.statHandle(invalidBlobHandle, &meta));
+    EXPECT_FALSE(mgr.deleteHandle(invalidBlobHandle));
+}
+} // namespace blobs
@@ -0,0 +1,139 @@
+#include "blob_mock.hpp"
+#include "manager.hpp"
+
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::ElementsAreArray;
+using ::testing::Return;
+
+namespace
+{
+
+constexpr uint64_t past4GiB = 0x100000100;
+
+} // namespace
+
+TEST(ManagerLargeBlobTest, WritePast4GiBReachesTheHandler)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, writeBytes64(sess, past4GiB, ElementsAreArray(data)))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(mgr.write64(sess, past4GiB, data));
+}
+
+TEST(ManagerLargeBlobTest, ThirtyTwoBitWriteUsesTheSameEntryPoint)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, writeBytes64(sess, 0x10, ElementsAreArray(data)))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(mgr.write(sess, 0x10, data));
+}
+
+TEST(ManagerLargeBlobTest, WritePastTheOffsetSpaceIsRejected)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, writeBytes64(_, _, _)).Times(0);
+    EXPECT_FALSE(
+        mgr.write64(sess, std::numeric_limits<uint64_t>::max() - 1, data));
+}
+
+TEST(ManagerLargeBlobTest, ReadPast4GiBIsTrimmedToTheRequest)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+
+    EXPECT_CALL(*m1ptr, read64(sess, past4GiB, 2)).WillOnce(Return(data));
+    EXPECT_EQ(std::vector<uint8_t>(data.begin(), data.begin() + 2),
+              mgr.read64(sess, past4GiB, 2));
+}
+
+TEST(ManagerLargeBlobFallbackTest, ThirtyTwoBitHandlerStopsAt4GiB)
+{
+    // A handler without the 64-bit entry points sees offsets below 4GiB as
+    // before, and anything past them fails without reaching it.
+    BlobManager mgr;
+    auto m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read | OpenFlags::write, path, &sess));
+
+    std::vector<uint8_t> data = {0x11, 0x22};
+    EXPECT_CALL(*m1ptr, write(sess, 0xffffffff, data)).WillOnce(Return(true));
+    EXPECT_CALL(*m1ptr, read(sess, 0xffffffff, 2)).WillOnce(Return(data));
+    EXPECT_TRUE(mgr.write64(sess, 0xffffffff, data));
+    EXPECT_EQ(data, mgr.read64(sess, 0xffffffff, 2));
+
+    EXPECT_CALL(*m1ptr, write(_, _, _)).Times(0);
+    EXPECT_CALL(*m1ptr, read(_, _, _)).Times(0);
+    EXPECT_FALSE(mgr.write64(sess, past4GiB, data));
+    EXPECT_TRUE(mgr.read64(sess, past4GiB, 2).empty());
+}
+
+} // namespace blobs
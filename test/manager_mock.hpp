@@ -5,6 +5,8 @@
 #include <blobs-ipmid/blobs.hpp>
 
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
 
 #include <gmock/gmock.h>
@@ -21,20 +23,56 @@ class ManagerMock : public ManagerInterface
                 (override));
     MOCK_METHOD(uint32_t, buildBlobList, (), (override));
     MOCK_METHOD(std::string, getBlobId, (uint32_t), (override));
+    MOCK_METHOD(std::span<const std::string>, getBlobIdRange, (uint32_t),
+                (override));
+    MOCK_METHOD(void, statBlobRange,
+                (uint32_t, std::span<std::optional<BlobMeta>>), (override));
+    MOCK_METHOD(uint32_t, getBlobHandle, (uint32_t), (override));
+    MOCK_METHOD(bool, openHandle, (uint16_t, uint32_t, uint16_t*), (override));
+    MOCK_METHOD(bool, statHandle, (uint32_t, BlobMeta*), (override));
+    MOCK_METHOD(bool, deleteHandle, (uint32_t), (override));
+    MOCK_METHOD(bool, writeAppend,
+                (uint16_t, uint8_t, std::span<const uint8_t>), (override));
+    MOCK_METHOD(bool, writeWindowed,
+                (uint16_t, uint8_t, uint64_t, std::span<const uint8_t>),
+                (override));
+    MOCK_METHOD(std::optional<WriteWindow>, getWriteWindow, (uint16_t),
+                (override));
+    MOCK_METHOD(std::vector<uint8_t>, read64, (uint16_t, uint64_t, uint32_t),
+                (override));
+    MOCK_METHOD(bool, write64, (uint16_t, uint64_t, std::span<const uint8_t>),
+                (override));
+    MOCK_METHOD(bool, writeVectored,
+                (uint16_t, std::span<const WriteSegment>), (override));
+    MOCK_METHOD(bool, fill, (uint16_t, uint64_t, uint64_t, uint8_t),
+                (override));
+    MOCK_METHOD(std::optional<std::vector<uint8_t>>, digest,
+                (uint16_t, DigestAlgorithm, uint64_t, uint64_t), (override));
+    MOCK_METHOD(std::optional<std::vector<bool>>, sourceChunks,
+                (uint16_t, std::span<const ChunkHash>), (override));
+    MOCK_METHOD(std::optional<std::vector<ByteRange>>, getMissingRanges,
+                (uint16_t, uint64_t, uint64_t, size_t), (override));
     MOCK_METHOD(bool, open, (uint16_t, const std::string&, uint16_t*),
                 (override));
     MOCK_METHOD(bool, stat, (const std::string&, BlobMeta*), (override));
     MOCK_METHOD(bool, stat, (uint16_t, BlobMeta*), (override));
+    MOCK_METHOD(uint64_t, getReadSize, (uint16_t, bool), (override));
+    MOCK_METHOD(std::optional<uint16_t>, getSessionFlags, (uint16_t),
+                (override));
+    MOCK_METHOD(bool, bindNoCrcChannel, (uint16_t, uint8_t), (override));
+    MOCK_METHOD(std::optional<uint8_t>, getNoCrcChannel, (uint16_t),
+                (override));
     MOCK_METHOD(bool, commit, (uint16_t, const std::vector<uint8_t>&),
                 (override));
     MOCK_METHOD(bool, close, (uint16_t), (override));
     MOCK_METHOD(std::vector<uint8_t>, read, (uint16_t, uint32_t, uint32_t),
                 (override));
-    MOCK_METHOD(bool, write, (uint16_t, uint32_t, const std::vector<uint8_t>&),
+    MOCK_METHOD(bool, write, (uint16_t, uint32_t, std::span<const uint8_t>),
                 (override));
     MOCK_METHOD(bool, deleteBlob, (const std::string&), (override));
-    MOCK_METHOD(bool, writeMeta,
-                (uint16_t, uint32_t, const std::vector<uint8_t>&), (override));
+    MOCK_METHOD(bool, writeMeta, (uint16_t, uint32_t, std::span<const uint8_t>),
+                (override));
+    MOCK_METHOD(SessionLimits, getSessionLimits, (), (override));
 };
 
 } // namespace blobs
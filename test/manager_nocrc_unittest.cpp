@@ -0,0 +1,312 @@
+#include "blob_mock.hpp"
+#include "digest.hpp"
+#include "manager.hpp"
+#include "wire.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Return;
+
+namespace
+{
+
+constexpr uint16_t noCrcFlags = OpenFlags::write | OpenFlags::noCrc;
+
+/* The CRC32C of "123456789". */
+constexpr uint32_t checkCrc = 0xe3069283;
+
+std::vector<uint8_t> commitData(uint32_t crc, uint64_t length,
+                                const std::vector<uint8_t>& rest)
+{
+    std::vector<uint8_t> data(wireSize<NoCrcCommitHeader>);
+    encode(NoCrcCommitHeader{.crc32c = crc, .length = length}, data);
+    data.insert(data.end(), rest.begin(), rest.end());
+    return data;
+}
+
+} // namespace
+
+TEST(ManagerNoCrcTest, HandlerIsNotPassedTheFlag)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, OpenFlags::write, path))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(noCrcFlags, path, &sess));
+}
+
+TEST(ManagerNoCrcTest, InOrderWritesAreCheckedWithoutReadingBack)
+{
+    // The CRC32C header is stripped before the handler sees the commit data.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> head = {'1', '2', '3', '4'};
+    std::vector<uint8_t> tail = {'5', '6', '7', '8', '9'};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(noCrcFlags, path, &sess));
+    EXPECT_TRUE(mgr.write(sess, 0, head));
+    EXPECT_TRUE(mgr.write(sess, 4, tail));
+
+    EXPECT_CALL(*m1ptr, read(_, _, _)).Times(0);
+    EXPECT_CALL(*m1ptr, commit(sess, std::vector<uint8_t>{0xaa}))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(mgr.commit(sess, commitData(checkCrc, 9, {0xaa})));
+}
+
+TEST(ManagerNoCrcTest, MismatchedCrcFailsCommit)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> head = {'1', '2', '3', '4'};
+    std::vector<uint8_t> tail = {'5', '6', '7', '8', '9'};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(noCrcFlags, path, &sess));
+    EXPECT_TRUE(mgr.write(sess, 0, head));
+    EXPECT_TRUE(mgr.write(sess, 4, tail));
+
+    EXPECT_CALL(*m1ptr, commit(_, _)).Times(0);
+    EXPECT_FALSE(mgr.commit(sess, commitData(checkCrc ^ 1, 9, {})));
+}
+
+TEST(ManagerNoCrcTest, CommitWithoutCrcFails)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(noCrcFlags, path, &sess));
+
+    EXPECT_CALL(*m1ptr, commit(_, _)).Times(0);
+    EXPECT_FALSE(mgr.commit(sess, {0xaa}));
+}
+
+TEST(ManagerNoCrcTest, OutOfOrderWritesAreCheckedWithoutReadingBack)
+{
+    // The session is write-only, so the blob can't be read back.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> head = {'1', '2', '3', '4'};
+    std::vector<uint8_t> tail = {'5', '6', '7', '8', '9'};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(noCrcFlags, path, &sess));
+    EXPECT_TRUE(mgr.write(sess, 4, tail));
+    EXPECT_TRUE(mgr.write(sess, 0, head));
+
+    EXPECT_CALL(*m1ptr, read(_, _, _)).Times(0);
+    EXPECT_CALL(*m1ptr, commit(sess, std::vector<uint8_t>{}))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(mgr.commit(sess, commitData(checkCrc, 9, {})));
+}
+
+TEST(ManagerNoCrcTest, WindowedWritesOutOfOrderAreChecked)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> head = {'1', '2', '3', '4'};
+    std::vector<uint8_t> tail = {'5', '6', '7', '8', '9'};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(noCrcFlags, path, &sess));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 1, 4, tail));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 0, 0, head));
+
+    EXPECT_CALL(*m1ptr, read(_, _, _)).Times(0);
+    EXPECT_CALL(*m1ptr, commit(_, _)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.commit(sess, commitData(checkCrc, 9, {})));
+}
+
+TEST(ManagerNoCrcTest, FillIsChecked)
+{
+    // "1234" followed by five 'x's, with the fill between the writes.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> head = {'1', '2', '3', '4'};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    std::vector<uint8_t> blob = head;
+    blob.insert(blob.end(), 5, 'x');
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(noCrcFlags, path, &sess));
+    EXPECT_TRUE(mgr.fill(sess, 4, 5, 'x'));
+    EXPECT_TRUE(mgr.write(sess, 0, head));
+
+    EXPECT_CALL(*m1ptr, read(_, _, _)).Times(0);
+    EXPECT_CALL(*m1ptr, commit(_, _)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.commit(sess, commitData(crc32c(blob), 9, {})));
+}
+
+TEST(ManagerNoCrcTest, RetriedWriteIsChecked)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> head = {'1', '2', '3', '4'};
+    std::vector<uint8_t> tail = {'5', '6', '7', '8', '9'};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(noCrcFlags, path, &sess));
+    EXPECT_TRUE(mgr.write(sess, 0, head));
+    EXPECT_TRUE(mgr.write(sess, 4, tail));
+    EXPECT_TRUE(mgr.write(sess, 4, tail));
+
+    EXPECT_CALL(*m1ptr, commit(_, _)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.commit(sess, commitData(checkCrc, 9, {})));
+}
+
+TEST(ManagerNoCrcTest, OverwriteOnAWriteOnlySessionFailsCommit)
+{
+    // The CRCs of the runs no longer add up to the blob.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> head = {'1', '2', '3', '4'};
+    std::vector<uint8_t> tail = {'5', '6', '7', '8', '9'};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(noCrcFlags, path, &sess));
+    EXPECT_TRUE(mgr.write(sess, 0, head));
+    EXPECT_TRUE(mgr.write(sess, 4, tail));
+    EXPECT_TRUE(mgr.write(sess, 0, head));
+
+    EXPECT_CALL(*m1ptr, read(_, _, _)).Times(0);
+    EXPECT_CALL(*m1ptr, commit(_, _)).Times(0);
+    EXPECT_FALSE(mgr.commit(sess, commitData(checkCrc, 9, {})));
+}
+
+TEST(ManagerNoCrcTest, OverwriteOnAReadSessionStillFailsCommit)
+{
+    // The blob could be read back, but never is.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> head = {'1', '2', '3', '4'};
+    std::vector<uint8_t> tail = {'5', '6', '7', '8', '9'};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(noCrcFlags | OpenFlags::read, path, &sess));
+    EXPECT_TRUE(mgr.write(sess, 0, head));
+    EXPECT_TRUE(mgr.write(sess, 4, tail));
+    EXPECT_TRUE(mgr.write(sess, 0, head));
+
+    EXPECT_CALL(*m1ptr, read(_, _, _)).Times(0);
+    EXPECT_CALL(*m1ptr, commit(_, _)).Times(0);
+    EXPECT_FALSE(mgr.commit(sess, commitData(checkCrc, 9, {})));
+}
+
+TEST(ManagerNoCrcTest, PlainSessionCommitDataIsPassedThrough)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, write(_, _, _)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, commit(sess, std::vector<uint8_t>{0xaa}))
+        .WillOnce(Return(true));
+    EXPECT_TRUE(mgr.commit(sess, {0xaa}));
+}
+
+} // namespace blobs
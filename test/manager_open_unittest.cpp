@@ -1,6 +1,7 @@
 #include "blob_mock.hpp"
 #include "manager.hpp"
 
+#include <optional>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -82,4 +83,25 @@ TEST(ManagerOpenTest, OpenSucceeds)
     // TODO(venture): Need a way to verify the session is associated with it,
     // maybe just call Read() or SessionStat()
 }
+
+TEST(ManagerOpenTest, CompressedReadIsKeptFromTheHandler)
+{
+    // The handler is opened for reading only, and the session remembers the
+    // flag for the ipmi layer.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    uint16_t flags = OpenFlags::read | OpenFlags::compressedRead, sess;
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillOnce(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, OpenFlags::read, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(flags, path, &sess));
+
+    EXPECT_EQ(flags, mgr.getSessionFlags(sess));
+    EXPECT_EQ(std::nullopt, mgr.getSessionFlags(sess + 1));
+}
 } // namespace blobs
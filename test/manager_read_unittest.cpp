@@ -76,4 +76,31 @@ TEST(ManagerReadTest, ReadFromHandlerReturnsData)
     EXPECT_EQ(result, data);
 }
 
+TEST(ManagerReadTest, ReadTrimsHandlerDataToRequestedSize)
+{
+    // A handler that returns more than was asked for is trimmed, since the
+    // caller sized the request to fit its reply.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    uint16_t sess = 1;
+    uint32_t ofs = 0x54;
+    uint32_t requested = 2;
+    uint16_t flags = OpenFlags::read;
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x12, 0x14, 0x15, 0x16};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillOnce(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, flags, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(flags, path, &sess));
+
+    EXPECT_CALL(*m1ptr, read(sess, ofs, requested)).WillOnce(Return(data));
+
+    std::vector<uint8_t> result = mgr.read(sess, ofs, requested);
+    EXPECT_EQ((std::vector<uint8_t>{0x12, 0x14}), result);
+}
+
 } // namespace blobs
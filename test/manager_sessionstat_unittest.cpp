@@ -7,6 +7,7 @@ namespace blobs
 {
 
 using ::testing::_;
+using ::testing::Invoke;
 using ::testing::Return;
 
 TEST(ManagerSessionStatTest, StatNoSessionReturnsFalse)
@@ -63,4 +64,74 @@ TEST(ManagerSessionStatTest, StatSessionFoundAndHandlerReturnsSuccess)
 
     EXPECT_TRUE(mgr.stat(sess, &meta));
 }
+
+TEST(ManagerSessionStatTest, ReadSizeIsStatOnceAndKept)
+{
+    // The size the read trailer checks against is only stat'd again when
+    // asked to.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    uint16_t flags = OpenFlags::read, sess;
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillOnce(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, flags, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(flags, path, &sess));
+
+    EXPECT_CALL(*m1ptr, stat(sess, _))
+        .WillOnce(Invoke([](uint16_t, BlobMeta* meta) {
+            meta->size = 0x100;
+            return true;
+        }))
+        .WillOnce(Invoke([](uint16_t, BlobMeta* meta) {
+            meta->size = 0x200;
+            return true;
+        }));
+
+    EXPECT_EQ(0x100, mgr.getReadSize(sess, false));
+    EXPECT_EQ(0x100, mgr.getReadSize(sess, false));
+    EXPECT_EQ(0x200, mgr.getReadSize(sess, true));
+    EXPECT_EQ(0x200, mgr.getReadSize(sess, false));
+}
+
+TEST(ManagerSessionStatTest, ReadSizeIsStatAgainAfterAWrite)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    uint16_t flags = OpenFlags::read | OpenFlags::write, sess;
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillOnce(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, flags, path)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.open(flags, path, &sess));
+
+    EXPECT_CALL(*m1ptr, stat(sess, _))
+        .WillOnce(Invoke([](uint16_t, BlobMeta* meta) {
+            meta->size = 0x100;
+            return true;
+        }))
+        .WillOnce(Invoke([](uint16_t, BlobMeta* meta) {
+            meta->size = 0x104;
+            return true;
+        }));
+    EXPECT_EQ(0x100, mgr.getReadSize(sess, false));
+
+    std::vector<uint8_t> data = {1, 2, 3, 4};
+    EXPECT_CALL(*m1ptr, writeBytes64(sess, 0x100, _)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.write(sess, 0x100, data));
+    EXPECT_EQ(0x104, mgr.getReadSize(sess, false));
+}
+
+TEST(ManagerSessionStatTest, ReadSizeOfNoSessionIsZero)
+{
+    BlobManager mgr;
+    EXPECT_EQ(0, mgr.getReadSize(1, false));
+}
 } // namespace blobs
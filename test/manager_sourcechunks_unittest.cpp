@@ -0,0 +1,186 @@
+#include "blob_mock.hpp"
+#include "manager.hpp"
+
+#include <array>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Return;
+
+namespace
+{
+
+constexpr std::array<uint8_t, chunkHashSize> hash = {};
+
+/* Make count consecutive chunks of length bytes, starting at offset. */
+std::vector<ChunkHash> chunks(uint64_t offset, uint32_t length, size_t count)
+{
+    std::vector<ChunkHash> result;
+    for (size_t i = 0; i < count; ++i)
+    {
+        result.push_back(ChunkHash{
+            .offset = offset + i * length, .length = length, .hash = hash});
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(ManagerSourceChunksTest, NoSessionReturnsNothing)
+{
+    BlobManager mgr;
+
+    EXPECT_FALSE(mgr.sourceChunks(1, chunks(0, 0x1000, 1)));
+}
+
+TEST(ManagerSourceChunksTest, ReadOnlySessionReturnsNothing)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+
+    EXPECT_CALL(*m1ptr, sourceChunk(_, _, _, _)).Times(0);
+    EXPECT_FALSE(mgr.sourceChunks(sess, chunks(0, 0x1000, 1)));
+}
+
+TEST(ManagerSourceChunksTest, CompressedSessionReturnsNothing)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write | OpenFlags::compressedWrite, path,
+                         &sess));
+
+    EXPECT_CALL(*m1ptr, sourceChunk(_, _, _, _)).Times(0);
+    EXPECT_FALSE(mgr.sourceChunks(sess, chunks(0, 0x1000, 1)));
+}
+
+TEST(ManagerSourceChunksTest, NoCrcSessionSourcesNothing)
+{
+    // The host sends every chunk, so the blob's CRC32C can be checked.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write | OpenFlags::noCrc, path, &sess));
+
+    EXPECT_CALL(*m1ptr, sourceChunk(_, _, _, _)).Times(0);
+    auto sourced = mgr.sourceChunks(sess, chunks(0, 0x1000, 2));
+    ASSERT_TRUE(sourced);
+    EXPECT_THAT(*sourced, ElementsAre(false, false));
+}
+
+TEST(ManagerSourceChunksTest, OverflowingChunkReturnsNothing)
+{
+    // Nothing is offered when any chunk is out of range.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, sourceChunk(_, _, _, _)).Times(0);
+    EXPECT_FALSE(
+        mgr.sourceChunks(sess, chunks(0xffffffffffffe000, 0x1000, 2)));
+}
+
+TEST(ManagerSourceChunksTest, HandlerWithoutLocalCopyWritesNothing)
+{
+    // The default hook declines every chunk.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(_, _, _)).Times(0);
+    auto sourced = mgr.sourceChunks(sess, chunks(0, 0x1000, 2));
+    ASSERT_TRUE(sourced);
+    EXPECT_THAT(*sourced, ElementsAre(false, false));
+}
+
+TEST(ManagerSourceChunksTest, SourcedChunksAreNoLongerMissing)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, sourceChunk(sess, 0, 0x1000, _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*m1ptr, sourceChunk(sess, 0x1000, 0x1000, _))
+        .WillOnce(Return(false));
+    EXPECT_CALL(*m1ptr, sourceChunk(sess, 0x2000, 0x1000, _))
+        .WillOnce(Return(true));
+
+    auto sourced = mgr.sourceChunks(sess, chunks(0, 0x1000, 3));
+    ASSERT_TRUE(sourced);
+    EXPECT_THAT(*sourced, ElementsAre(true, false, true));
+
+    auto missing = mgr.getMissingRanges(sess, 0, 0x3000, 4);
+    ASSERT_TRUE(missing);
+    ASSERT_EQ(1, missing->size());
+    EXPECT_EQ(0x1000, (*missing)[0].offset);
+    EXPECT_EQ(0x1000, (*missing)[0].length);
+}
+
+} // namespace blobs
@@ -1,11 +1,19 @@
 #include "blob_mock.hpp"
 #include "manager.hpp"
 
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 namespace blobs
 {
 
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Invoke;
 using ::testing::Return;
 
 TEST(ManagerStatTest, StatNoHandler)
@@ -57,4 +65,62 @@ TEST(ManagerStatTest, StatHandlerFoundAndSucceeds)
 
     EXPECT_TRUE(mgr.stat(path, &meta));
 }
+
+TEST(ManagerStatTest, StatBlobRangeAsksEachHandlerOnce)
+{
+    // Each handler is asked for all of its blobIds in the range in one call.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    std::unique_ptr<BlobMock> m2 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    auto m2ptr = m2.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+    EXPECT_TRUE(mgr.registerHandler(std::move(m2)));
+
+    std::vector<std::string> v1 = {"/a/1", "/a/2"};
+    std::vector<std::string> v2 = {"/b/1"};
+    EXPECT_CALL(*m1ptr, getBlobIds()).WillOnce(Return(v1));
+    EXPECT_CALL(*m2ptr, getBlobIds()).WillOnce(Return(v2));
+    EXPECT_EQ(3, mgr.buildBlobList());
+
+    EXPECT_CALL(*m1ptr, statBlobs(ElementsAre("/a/2"), _))
+        .WillOnce(Invoke([](std::span<const std::string>,
+                            std::span<std::optional<BlobMeta>> metas) {
+            metas[0] = BlobMeta{.blobState = 1, .size = 2, .metadata = {}};
+        }));
+    EXPECT_CALL(*m2ptr, statBlobs(ElementsAre("/b/1"), _))
+        .WillOnce(Invoke([](std::span<const std::string>,
+                            std::span<std::optional<BlobMeta>> metas) {
+            metas[0].reset();
+        }));
+
+    std::vector<std::optional<BlobMeta>> metas(3);
+    mgr.statBlobRange(1, metas);
+    ASSERT_TRUE(metas[0].has_value());
+    EXPECT_EQ(2, metas[0]->size);
+    EXPECT_FALSE(metas[1].has_value());
+    EXPECT_FALSE(metas[2].has_value());
+}
+
+TEST(ManagerStatTest, DefaultStatBlobsStatsEachPath)
+{
+    // A handler that doesn't override statBlobs is asked one path at a time.
+
+    BlobMock handler;
+    std::vector<std::string> paths = {"/a/1", "/a/2"};
+    std::vector<std::optional<BlobMeta>> metas(2);
+
+    EXPECT_CALL(handler, stat(paths[0], _))
+        .WillOnce(Invoke([](const std::string&, BlobMeta* meta) {
+            meta->size = 7;
+            return true;
+        }));
+    EXPECT_CALL(handler, stat(paths[1], _)).WillOnce(Return(false));
+
+    handler.GenericBlobInterface::statBlobs(paths, metas);
+    ASSERT_TRUE(metas[0].has_value());
+    EXPECT_EQ(7, metas[0]->size);
+    EXPECT_FALSE(metas[1].has_value());
+}
 } // namespace blobs
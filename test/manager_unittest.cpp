@@ -169,4 +169,23 @@ TEST(BlobTest, EnumerateBlobInvalidEntry)
     // Grabs the third entry which isn't valid.
     EXPECT_STREQ("", mgr.getBlobId(2).c_str());
 }
+
+TEST(BlobTest, EnumerateBlobRangeViewsTheCache)
+{
+    // The range is a view of the cached ids from the index onward.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    std::vector<std::string> v1 = {"asdf", "ghjk", "qwer"};
+
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+    EXPECT_CALL(*m1ptr, getBlobIds()).WillOnce(Return(v1));
+    EXPECT_EQ(3, mgr.buildBlobList());
+
+    auto range = mgr.getBlobIdRange(1);
+    EXPECT_EQ(std::vector<std::string>(range.begin(), range.end()),
+              (std::vector<std::string>{"ghjk", "qwer"}));
+    EXPECT_TRUE(mgr.getBlobIdRange(3).empty());
+}
 } // namespace blobs
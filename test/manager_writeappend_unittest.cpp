@@ -0,0 +1,185 @@
+#include "blob_mock.hpp"
+#include "manager.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Return;
+
+TEST(ManagerWriteAppendTest, NoSessionReturnsFalse)
+{
+    BlobManager mgr;
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_FALSE(mgr.writeAppend(1, 0, data));
+}
+
+TEST(ManagerWriteAppendTest, ReadOnlySessionReturnsFalse)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(_, _, _)).Times(0);
+    EXPECT_FALSE(mgr.writeAppend(sess, 0, data));
+}
+
+TEST(ManagerWriteAppendTest, EachWriteLandsWhereTheLastEnded)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, 0, data)).WillOnce(Return(true));
+    EXPECT_CALL(*m1ptr, write(sess, 3, data)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.writeAppend(sess, 0, data));
+    EXPECT_TRUE(mgr.writeAppend(sess, 1, data));
+}
+
+TEST(ManagerWriteAppendTest, RepeatedSequenceIsNotWrittenAgain)
+{
+    // A retry of the last write succeeds without reaching the handler.
+
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, 0, data)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.writeAppend(sess, 0, data));
+    EXPECT_TRUE(mgr.writeAppend(sess, 0, data));
+
+    EXPECT_CALL(*m1ptr, write(sess, 3, data)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.writeAppend(sess, 1, data));
+}
+
+TEST(ManagerWriteAppendTest, OutOfOrderSequenceIsRejected)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(_, _, _)).Times(0);
+    EXPECT_FALSE(mgr.writeAppend(sess, 1, data));
+    // Before anything is written, 0xff is not a retry.
+    EXPECT_FALSE(mgr.writeAppend(sess, 0xff, data));
+}
+
+TEST(ManagerWriteAppendTest, FailedWriteDoesNotMoveTheCursor)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, 0, data))
+        .WillOnce(Return(false))
+        .WillOnce(Return(true));
+    EXPECT_FALSE(mgr.writeAppend(sess, 0, data));
+    EXPECT_TRUE(mgr.writeAppend(sess, 0, data));
+}
+
+TEST(ManagerWriteAppendTest, SequenceWrapsAfter255)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, _, data)).WillRepeatedly(Return(true));
+    for (int i = 0; i < 256; ++i)
+    {
+        EXPECT_TRUE(mgr.writeAppend(sess, static_cast<uint8_t>(i), data));
+    }
+
+    EXPECT_CALL(*m1ptr, write(sess, 256 * 3, data)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.writeAppend(sess, 0, data));
+}
+
+TEST(ManagerWriteAppendTest, EachSessionHasItsOwnCursor)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22, 0x33};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t first, second;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &first));
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &second));
+
+    EXPECT_CALL(*m1ptr, write(first, 0, data)).WillOnce(Return(true));
+    EXPECT_CALL(*m1ptr, write(second, 0, data)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.writeAppend(first, 0, data));
+    EXPECT_TRUE(mgr.writeAppend(second, 0, data));
+}
+} // namespace blobs
@@ -0,0 +1,183 @@
+#include "blob_mock.hpp"
+#include "manager.hpp"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::InSequence;
+using ::testing::Return;
+
+TEST(ManagerWriteVectoredTest, NoSessionReturnsFalse)
+{
+    BlobManager mgr;
+    std::vector<uint8_t> first = {0x11, 0x22};
+    std::vector<uint8_t> second = {0x33, 0x44, 0x55};
+    std::array<WriteSegment, 2> segments = {
+        WriteSegment{.offset = 0x10, .data = first},
+        WriteSegment{.offset = 0x20, .data = second},
+    };
+
+    EXPECT_FALSE(mgr.writeVectored(1, segments));
+}
+
+TEST(ManagerWriteVectoredTest, ReadOnlySessionReturnsFalse)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> first = {0x11, 0x22};
+    std::vector<uint8_t> second = {0x33, 0x44, 0x55};
+    std::array<WriteSegment, 2> segments = {
+        WriteSegment{.offset = 0x10, .data = first},
+        WriteSegment{.offset = 0x20, .data = second},
+    };
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+
+    EXPECT_CALL(*m1ptr, writeVectored(_, _)).Times(0);
+    EXPECT_FALSE(mgr.writeVectored(sess, segments));
+}
+
+TEST(ManagerWriteVectoredTest, HandlerGetsEverySegmentInOneCall)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> first = {0x11, 0x22};
+    std::vector<uint8_t> second = {0x33, 0x44, 0x55};
+    std::array<WriteSegment, 2> segments = {
+        WriteSegment{.offset = 0x10, .data = first},
+        WriteSegment{.offset = 0x20, .data = second},
+    };
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, writeVectored(sess, _))
+        .WillOnce([&](uint16_t, std::span<const WriteSegment> s) {
+            EXPECT_EQ(segments.size(), s.size());
+            EXPECT_EQ(segments.data(), s.data());
+            return true;
+        });
+    EXPECT_TRUE(mgr.writeVectored(sess, segments));
+
+    // Only the bytes between and after the segments are missing.
+    auto missing = mgr.getMissingRanges(sess, 0x10, 0x20, 4);
+    ASSERT_TRUE(missing);
+    ASSERT_EQ(2, missing->size());
+    EXPECT_EQ(0x12, (*missing)[0].offset);
+    EXPECT_EQ(0x0e, (*missing)[0].length);
+    EXPECT_EQ(0x23, (*missing)[1].offset);
+}
+
+TEST(ManagerWriteVectoredTest, FailedWriteIsNotCountedAsWritten)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> first = {0x11, 0x22};
+    std::vector<uint8_t> second = {0x33, 0x44, 0x55};
+    std::array<WriteSegment, 2> segments = {
+        WriteSegment{.offset = 0x10, .data = first},
+        WriteSegment{.offset = 0x20, .data = second},
+    };
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, writeVectored(sess, _)).WillOnce(Return(false));
+    EXPECT_FALSE(mgr.writeVectored(sess, segments));
+
+    auto missing = mgr.getMissingRanges(sess, 0x10, 0x20, 4);
+    ASSERT_TRUE(missing);
+    EXPECT_EQ(1, missing->size());
+}
+
+TEST(ManagerWriteVectoredTest, CompressedSessionIsRejected)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> first = {0x11, 0x22};
+    std::vector<uint8_t> second = {0x33, 0x44, 0x55};
+    std::array<WriteSegment, 2> segments = {
+        WriteSegment{.offset = 0x10, .data = first},
+        WriteSegment{.offset = 0x20, .data = second},
+    };
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write | OpenFlags::compressedWrite, path,
+                         &sess));
+
+    EXPECT_CALL(*m1ptr, writeVectored(_, _)).Times(0);
+    EXPECT_FALSE(mgr.writeVectored(sess, segments));
+}
+
+TEST(ManagerWriteVectoredFallbackTest, DefaultWritesEachSegment)
+{
+    // A handler without its own writeVectored() gets one write() per
+    // segment, and the first failure stops the rest.
+    BlobManager mgr;
+    auto m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillOnce(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    std::vector<uint8_t> first = {0x11, 0x22};
+    std::vector<uint8_t> second = {0x33};
+    std::vector<uint8_t> third = {0x44};
+    std::array<WriteSegment, 3> segments = {
+        WriteSegment{.offset = 0x10, .data = first},
+        WriteSegment{.offset = 0x4, .data = second},
+        WriteSegment{.offset = 0x8, .data = third},
+    };
+
+    {
+        InSequence seq;
+        EXPECT_CALL(*m1ptr, write(sess, 0x10, first)).WillOnce(Return(true));
+        EXPECT_CALL(*m1ptr, write(sess, 0x4, second)).WillOnce(Return(false));
+    }
+    EXPECT_FALSE(mgr.writeVectored(sess, segments));
+}
+
+} // namespace blobs
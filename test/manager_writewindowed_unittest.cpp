@@ -0,0 +1,203 @@
+#include "blob_mock.hpp"
+#include "manager.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::_;
+using ::testing::Return;
+
+TEST(ManagerWriteWindowedTest, NoSessionReturnsFalse)
+{
+    BlobManager mgr;
+    std::vector<uint8_t> data = {0x11, 0x22};
+
+    EXPECT_FALSE(mgr.writeWindowed(1, 0, 0, data));
+    EXPECT_FALSE(mgr.getWriteWindow(1));
+}
+
+TEST(ManagerWriteWindowedTest, ReadOnlySessionReturnsFalse)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::read, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(_, _, _)).Times(0);
+    EXPECT_FALSE(mgr.writeWindowed(sess, 0, 0, data));
+    EXPECT_FALSE(mgr.getWriteWindow(sess));
+}
+
+TEST(ManagerWriteWindowedTest, OutOfOrderWritesLandAtTheirOffsets)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, 4, data)).WillOnce(Return(true));
+    EXPECT_CALL(*m1ptr, write(sess, 8, data)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 2, 4, data));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 4, 8, data));
+
+    auto window = mgr.getWriteWindow(sess);
+    ASSERT_TRUE(window);
+    EXPECT_EQ(0, window->base);
+    EXPECT_EQ(0b10100u, window->received);
+}
+
+TEST(ManagerWriteWindowedTest, WindowMovesPastWhatHasLanded)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, _, data)).WillRepeatedly(Return(true));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 1, 2, data));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 3, 6, data));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 0, 0, data));
+
+    // 0 and 1 have landed, so the window now starts at the missing 2.
+    auto window = mgr.getWriteWindow(sess);
+    ASSERT_TRUE(window);
+    EXPECT_EQ(2, window->base);
+    EXPECT_EQ(0b10u, window->received);
+}
+
+TEST(ManagerWriteWindowedTest, LandedWritesAreNotWrittenAgain)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, 0, data)).WillOnce(Return(true));
+    EXPECT_CALL(*m1ptr, write(sess, 4, data)).WillOnce(Return(true));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 0, 0, data));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 2, 4, data));
+
+    // 0 is behind the window and 2 is inside it, both are retries.
+    EXPECT_TRUE(mgr.writeWindowed(sess, 0, 0, data));
+    EXPECT_TRUE(mgr.writeWindowed(sess, 2, 4, data));
+}
+
+TEST(ManagerWriteWindowedTest, WritesPastTheWindowAreRejected)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(_, _, _)).Times(0);
+    EXPECT_FALSE(mgr.writeWindowed(sess, writeWindowSize, 0, data));
+    // Nothing has landed yet, so this isn't behind the window either.
+    EXPECT_FALSE(mgr.writeWindowed(sess, 0xff, 0, data));
+}
+
+TEST(ManagerWriteWindowedTest, FailedWriteIsNotMarked)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, 0, data)).WillOnce(Return(false));
+    EXPECT_FALSE(mgr.writeWindowed(sess, 0, 0, data));
+
+    auto window = mgr.getWriteWindow(sess);
+    ASSERT_TRUE(window);
+    EXPECT_EQ(0, window->base);
+    EXPECT_EQ(0u, window->received);
+}
+
+TEST(ManagerWriteWindowedTest, SequenceWrapsAfter255)
+{
+    BlobManager mgr;
+    std::unique_ptr<BlobMock> m1 = std::make_unique<BlobMock>();
+    auto m1ptr = m1.get();
+    EXPECT_TRUE(mgr.registerHandler(std::move(m1)));
+
+    std::string path = "/asdf/asdf";
+    std::vector<uint8_t> data = {0x11, 0x22};
+
+    EXPECT_CALL(*m1ptr, canHandleBlob(path)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*m1ptr, open(_, _, path)).WillRepeatedly(Return(true));
+
+    uint16_t sess;
+    EXPECT_TRUE(mgr.open(OpenFlags::write, path, &sess));
+
+    EXPECT_CALL(*m1ptr, write(sess, _, data)).WillRepeatedly(Return(true));
+    for (int i = 0; i < 255; ++i)
+    {
+        EXPECT_TRUE(mgr.writeWindowed(sess, static_cast<uint8_t>(i), 0, data));
+    }
+
+    // 255 is missing, but 0 and 1 of the next lap fit in the window.
+    EXPECT_TRUE(mgr.writeWindowed(sess, 1, 0, data));
+    auto window = mgr.getWriteWindow(sess);
+    ASSERT_TRUE(window);
+    EXPECT_EQ(255, window->base);
+    EXPECT_EQ(0b100u, window->received);
+}
+} // namespace blobs
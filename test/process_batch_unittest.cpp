@@ -0,0 +1,201 @@
+#include "ipmi.hpp"
+#include "manager_mock.hpp"
+#include "process.hpp"
+
+#include <array>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+// ipmid.hpp isn't installed where we can grab it and this value is per BMC
+// SoC.
+#define MAX_IPMI_BUFFER 64
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::Invoke;
+using ::testing::Matcher;
+using ::testing::NotNull;
+using ::testing::Return;
+using ::testing::StrictMock;
+
+namespace blobs
+{
+
+namespace
+{
+
+/* Append a sub-command to a batch request, with its body less the crc. */
+template <typename T>
+void addEntry(std::vector<uint8_t>& request, const T& tx,
+              std::span<const uint8_t> trailer = {})
+{
+    std::vector<uint8_t> body(sizeof(tx));
+    std::memcpy(body.data(), &tx, sizeof(tx));
+    body.erase(body.begin(), body.begin() + sizeof(uint16_t));
+    body.insert(body.end(), trailer.begin(), trailer.end());
+
+    request.push_back(static_cast<uint8_t>(T::command));
+    request.push_back(static_cast<uint8_t>(body.size()));
+    request.insert(request.end(), body.begin(), body.end());
+    request[offsetof(BmcBlobBatchTx, count)]++;
+}
+
+std::vector<uint8_t> batchRequest()
+{
+    return std::vector<uint8_t>(sizeof(BmcBlobBatchTx), 0);
+}
+
+} // namespace
+
+TEST(BlobBatchTest, WritesAndSessionStatReturnOneResultEach)
+{
+    // A write+write+sessionStat batch runs all three and returns their
+    // results, without their crcs, in one reply.
+    StrictMock<ManagerMock> mgr;
+    std::vector<uint8_t> request = batchRequest();
+    std::array<uint8_t, 2> first = {0x11, 0x22};
+    std::array<uint8_t, 3> second = {0x33, 0x44, 0x55};
+
+    addEntry(request, BmcBlobWriteTx{.crc = 0, .sessionId = 7, .offset = 0},
+             first);
+    addEntry(request, BmcBlobWriteTx{.crc = 0, .sessionId = 7, .offset = 2},
+             second);
+    addEntry(request, BmcBlobSessionStatTx{.crc = 0, .sessionId = 7});
+
+    EXPECT_CALL(mgr, write(7, 0, ElementsAreArray(first)))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mgr, write(7, 2, ElementsAreArray(second)))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mgr, stat(Matcher<uint16_t>(7), Matcher<BlobMeta*>(NotNull())))
+        .WillOnce(Invoke([](uint16_t, BlobMeta* meta) {
+            meta->blobState = StateFlags::open_write;
+            meta->size = 5;
+            return true;
+        }));
+
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    ResponseWriter reply(response);
+    EXPECT_EQ(ipmi::ccSuccess, batchBlob(&mgr, request, reply));
+
+    EXPECT_THAT(reply.data(),
+                ElementsAre(0, 0, 3,                   // crc, count
+                            ipmi::ccSuccess, 0,        // write
+                            ipmi::ccSuccess, 0,        // write
+                            ipmi::ccSuccess, 7,        // sessionStat
+                            StateFlags::open_write, 0, // blobState
+                            5, 0, 0, 0,                // size
+                            0));                       // metadataLen
+}
+
+TEST(BlobBatchTest, StopsAtFirstFailure)
+{
+    // A failed sub-command ends the batch, so the ones after it never run.
+    StrictMock<ManagerMock> mgr;
+    std::vector<uint8_t> request = batchRequest();
+    std::array<uint8_t, 1> bytes = {0x11};
+
+    addEntry(request, BmcBlobWriteTx{.crc = 0, .sessionId = 7, .offset = 0},
+             bytes);
+    addEntry(request, BmcBlobCloseTx{.crc = 0, .sessionId = 7});
+
+    EXPECT_CALL(mgr, write(7, 0, _)).WillOnce(Return(false));
+
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    ResponseWriter reply(response);
+    EXPECT_EQ(ipmi::ccSuccess, batchBlob(&mgr, request, reply));
+
+    EXPECT_THAT(reply.data(), ElementsAre(0, 0, 1, ipmi::ccUnspecifiedError, 0));
+}
+
+TEST(BlobBatchTest, CommandWithoutBodyRuns)
+{
+    // Sub-commands with an empty body, like getCount, take a zero length.
+    StrictMock<ManagerMock> mgr;
+    std::vector<uint8_t> request = batchRequest();
+    request.push_back(static_cast<uint8_t>(BlobOEMCommands::bmcBlobGetCount));
+    request.push_back(0);
+    request[offsetof(BmcBlobBatchTx, count)] = 1;
+
+    EXPECT_CALL(mgr, buildBlobList()).WillOnce(Return(4));
+
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    ResponseWriter reply(response);
+    EXPECT_EQ(ipmi::ccSuccess, batchBlob(&mgr, request, reply));
+
+    EXPECT_THAT(reply.data(),
+                ElementsAre(0, 0, 1, ipmi::ccSuccess, 4, 4, 0, 0, 0));
+}
+
+TEST(BlobBatchTest, NestedBatchIsRejected)
+{
+    StrictMock<ManagerMock> mgr;
+    std::vector<uint8_t> request = batchRequest();
+    std::array<uint8_t, 1> inner = {0};
+    addEntry(request, BmcBlobBatchTx{.crc = 0, .count = 0}, inner);
+
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    ResponseWriter reply(response);
+    EXPECT_EQ(ipmi::ccSuccess, batchBlob(&mgr, request, reply));
+
+    EXPECT_THAT(reply.data(),
+                ElementsAre(0, 0, 1, ipmi::ccInvalidFieldRequest, 0));
+}
+
+TEST(BlobBatchTest, GetCapsIsRejected)
+{
+    // GetCaps reports the channel's limits, which a sub-reply doesn't have.
+    StrictMock<ManagerMock> mgr;
+    std::vector<uint8_t> request = batchRequest();
+    request.push_back(static_cast<uint8_t>(BlobOEMCommands::bmcBlobGetCaps));
+    request.push_back(0);
+    request[offsetof(BmcBlobBatchTx, count)] = 1;
+
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    ResponseWriter reply(response);
+    EXPECT_EQ(ipmi::ccSuccess, batchBlob(&mgr, request, reply));
+
+    EXPECT_THAT(reply.data(),
+                ElementsAre(0, 0, 1, ipmi::ccInvalidFieldRequest, 0));
+}
+
+TEST(BlobBatchTest, MalformedEntriesRunNothing)
+{
+    // An entry that runs past the end of the request fails the whole batch
+    // before any sub-command runs.
+    StrictMock<ManagerMock> mgr;
+    std::vector<uint8_t> request = batchRequest();
+    std::array<uint8_t, 1> bytes = {0x11};
+
+    addEntry(request, BmcBlobWriteTx{.crc = 0, .sessionId = 7, .offset = 0},
+             bytes);
+    addEntry(request, BmcBlobCloseTx{.crc = 0, .sessionId = 7});
+    request.pop_back();
+
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    ResponseWriter reply(response);
+    EXPECT_EQ(ipmi::ccReqDataLenInvalid, batchBlob(&mgr, request, reply));
+}
+
+TEST(BlobBatchTest, StopsWhenReplyIsFull)
+{
+    // Once the reply can't hold another result, the rest don't run.
+    StrictMock<ManagerMock> mgr;
+    std::vector<uint8_t> request = batchRequest();
+    addEntry(request, BmcBlobCloseTx{.crc = 0, .sessionId = 7});
+    addEntry(request, BmcBlobCloseTx{.crc = 0, .sessionId = 8});
+
+    EXPECT_CALL(mgr, close(7)).WillOnce(Return(true));
+
+    std::vector<uint8_t> response(sizeof(BmcBlobBatchRx) +
+                                  sizeof(BmcBlobBatchResult) + 1);
+    ResponseWriter reply(response);
+    EXPECT_EQ(ipmi::ccSuccess, batchBlob(&mgr, request, reply));
+
+    EXPECT_THAT(reply.data(), ElementsAre(0, 0, 1, ipmi::ccSuccess, 0));
+}
+} // namespace blobs
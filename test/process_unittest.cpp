@@ -1,12 +1,17 @@
+#include "crc.hpp"
 #include "helper.hpp"
 #include "ipmi.hpp"
+#include "manager.hpp"
 #include "manager_mock.hpp"
 #include "process.hpp"
 
-#include <ipmiblob/test/crc_mock.hpp>
-
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <memory>
 #include <span>
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -14,76 +19,34 @@
 // SoC.
 #define MAX_IPMI_BUFFER 64
 
-using ::testing::_;
 using ::testing::ElementsAre;
-using ::testing::Eq;
-using ::testing::Return;
 using ::testing::StrictMock;
 
-namespace ipmiblob
-{
-CrcInterface* crcIntf = nullptr;
-
-std::uint16_t generateCrc(const std::vector<std::uint8_t>& data)
-{
-    return (crcIntf) ? crcIntf->generateCrc(data) : 0x00;
-}
-} // namespace ipmiblob
-
 namespace blobs
 {
-namespace
-{
-
-void EqualFunctions(IpmiBlobHandler lhs, IpmiBlobHandler rhs)
-{
-    EXPECT_FALSE(lhs == nullptr);
-    EXPECT_FALSE(rhs == nullptr);
-
-    Resp (*const* lPtr)(ManagerInterface*, std::span<const uint8_t>) =
-        lhs.target<Resp (*)(ManagerInterface*, std::span<const uint8_t>)>();
-
-    Resp (*const* rPtr)(ManagerInterface*, std::span<const uint8_t>) =
-        rhs.target<Resp (*)(ManagerInterface*, std::span<const uint8_t>)>();
-
-    EXPECT_TRUE(lPtr);
-    EXPECT_TRUE(rPtr);
-    EXPECT_EQ(*lPtr, *rPtr);
-}
-
-} // namespace
-
-class ValidateBlobCommandTest : public ::testing::Test
-{
-  protected:
-    void SetUp() override
-    {
-        ipmiblob::crcIntf = &crcMock;
-    }
-
-    ipmiblob::CrcMock crcMock;
-};
-
-TEST_F(ValidateBlobCommandTest, InvalidCommandReturnsFailure)
+TEST(ValidateBlobCommandTest, InvalidCommandReturnsFailure)
 {
     // Verify we handle an invalid command.
     std::vector<uint8_t> request(MAX_IPMI_BUFFER - 1);
+    stampCrc(request);
     // There is no command 0xff.
-    IpmiBlobHandler handler = validateBlobCommand(0xff, request);
-    EXPECT_EQ(ipmi::responseInvalidFieldRequest(), handler(nullptr, {}));
+    auto [cc, handler] = validateBlobCommand(0xff, request);
+    EXPECT_EQ(ipmi::ccInvalidFieldRequest, cc);
+    EXPECT_EQ(nullptr, handler);
 }
 
-TEST_F(ValidateBlobCommandTest, ValidCommandWithoutPayload)
+TEST(ValidateBlobCommandTest, ValidCommandWithoutPayload)
 {
     // Verify we handle a valid command that doesn't have a payload.
     std::vector<uint8_t> request(MAX_IPMI_BUFFER - 1);
-    IpmiBlobHandler handler = validateBlobCommand(
+    stampCrc(request);
+    auto [cc, handler] = validateBlobCommand(
         static_cast<std::uint8_t>(BlobOEMCommands::bmcBlobGetCount), request);
-    EXPECT_FALSE(handler == nullptr);
-    EqualFunctions(getBlobCount, handler);
+    EXPECT_EQ(ipmi::ccSuccess, cc);
+    EXPECT_EQ(getBlobCount, handler);
 }
 
-TEST_F(ValidateBlobCommandTest, WithPayloadMinimumLengthIs3VerifyChecks)
+TEST(ValidateBlobCommandTest, WithPayloadMinimumLengthIs3VerifyChecks)
 {
     // Verify that if there's a payload, it's at least one command byte and
     // two bytes for the crc16 and then one data byte.
@@ -91,17 +54,18 @@ TEST_F(ValidateBlobCommandTest, WithPayloadMinimumLengthIs3VerifyChecks)
     std::vector<uint8_t> request(sizeof(uint16_t));
     // There is a payload, but there are insufficient bytes.
 
-    IpmiBlobHandler handler = validateBlobCommand(
+    auto [cc, handler] = validateBlobCommand(
         static_cast<std::uint8_t>(BlobOEMCommands::bmcBlobGetCount), request);
-    EXPECT_EQ(ipmi::responseReqDataLenInvalid(), handler(nullptr, {}));
+    EXPECT_EQ(ipmi::ccReqDataLenInvalid, cc);
+    EXPECT_EQ(nullptr, handler);
 }
 
-TEST_F(ValidateBlobCommandTest, WithPayloadAndInvalidCrc)
+TEST(ValidateBlobCommandTest, WithPayloadAndInvalidCrc)
 {
     // Verify that the CRC is checked, and failure is reported.
     std::vector<uint8_t> request;
     BmcBlobWriteTx req;
-    req.crc = 0x34;
+    req.crc = 0;
     req.sessionId = 0x54;
     req.offset = 0x100;
 
@@ -110,22 +74,24 @@ TEST_F(ValidateBlobCommandTest, WithPayloadAndInvalidCrc)
     std::memcpy(request.data(), &req, sizeof(struct BmcBlobWriteTx));
     request.insert(request.end(), expectedBytes.begin(), expectedBytes.end());
 
-    // skip over cmd and crc.
-    std::vector<uint8_t> bytes(request.begin() + sizeof(req.crc),
-                               request.end());
-    EXPECT_CALL(crcMock, generateCrc(Eq(bytes))).WillOnce(Return(0x1234));
+    // skip over cmd and crc, then store a crc that doesn't match.
+    uint16_t crc = generateCrc(
+        std::span<const uint8_t>(request).subspan(sizeof(req.crc)));
+    crc ^= 0x1234;
+    std::memcpy(request.data(), &crc, sizeof(crc));
 
-    IpmiBlobHandler handler = validateBlobCommand(
+    auto [cc, handler] = validateBlobCommand(
         static_cast<std::uint8_t>(BlobOEMCommands::bmcBlobWrite), request);
-    EXPECT_EQ(ipmi::responseUnspecifiedError(), handler(nullptr, {}));
+    EXPECT_EQ(ipmi::ccUnspecifiedError, cc);
+    EXPECT_EQ(nullptr, handler);
 }
 
-TEST_F(ValidateBlobCommandTest, WithPayloadAndValidCrc)
+TEST(ValidateBlobCommandTest, WithPayloadAndValidCrc)
 {
     // Verify the CRC is checked and if it matches, return the handler.
     std::vector<uint8_t> request;
     BmcBlobWriteTx req;
-    req.crc = 0x3412;
+    req.crc = 0;
     req.sessionId = 0x54;
     req.offset = 0x100;
 
@@ -135,118 +101,398 @@ TEST_F(ValidateBlobCommandTest, WithPayloadAndValidCrc)
     request.insert(request.end(), expectedBytes.begin(), expectedBytes.end());
 
     // skip over cmd and crc.
-    std::vector<uint8_t> bytes(request.begin() + sizeof(req.crc),
-                               request.end());
-    EXPECT_CALL(crcMock, generateCrc(Eq(bytes))).WillOnce(Return(0x3412));
+    uint16_t crc = generateCrc(
+        std::span<const uint8_t>(request).subspan(sizeof(req.crc)));
+    std::memcpy(request.data(), &crc, sizeof(crc));
 
-    IpmiBlobHandler handler = validateBlobCommand(
+    auto [cc, handler] = validateBlobCommand(
         static_cast<std::uint8_t>(BlobOEMCommands::bmcBlobWrite), request);
-    EXPECT_FALSE(handler == nullptr);
-    EqualFunctions(writeBlob, handler);
+    EXPECT_EQ(ipmi::ccSuccess, cc);
+    EXPECT_EQ(writeBlob, handler);
 }
 
-class ProcessBlobCommandTest : public ::testing::Test
-{
-  protected:
-    void SetUp() override
-    {
-        ipmiblob::crcIntf = &crcMock;
-    }
-
-    ipmiblob::CrcMock crcMock;
-};
-
-TEST_F(ProcessBlobCommandTest, CommandReturnsNotOk)
+TEST(ProcessBlobCommandTest, CommandReturnsNotOk)
 {
     // Verify that if the IPMI command handler returns not OK that this is
     // noticed and returned.
 
     StrictMock<ManagerMock> manager;
     std::vector<uint8_t> request(MAX_IPMI_BUFFER - 1);
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
 
-    IpmiBlobHandler h = [](ManagerInterface*, std::span<const uint8_t>) {
-        return ipmi::responseInvalidCommand();
-    };
+    IpmiBlobHandler h = [](ManagerInterface*, RequestBody,
+                           ResponseWriter&) { return ipmi::ccInvalidCommand; };
 
-    EXPECT_EQ(ipmi::responseInvalidCommand(),
-              processBlobCommand(h, &manager, request, MAX_IPMI_BUFFER));
+    auto result = processBlobCommand(h, &manager, request, response);
+    EXPECT_EQ(ipmi::ccInvalidCommand, std::get<0>(result));
+    EXPECT_FALSE(std::get<1>(result).has_value());
 }
 
-TEST_F(ProcessBlobCommandTest, CommandReturnsOkWithNoPayload)
+TEST(ProcessBlobCommandTest, CommandReturnsOkWithNoPayload)
 {
     // Verify that if the IPMI command handler returns OK but without a payload
     // it doesn't try to compute a CRC.
 
     StrictMock<ManagerMock> manager;
     std::vector<uint8_t> request(MAX_IPMI_BUFFER - 1);
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
 
-    IpmiBlobHandler h = [](ManagerInterface*, std::span<const uint8_t>) {
-        return ipmi::responseSuccess(std::vector<uint8_t>());
-    };
+    IpmiBlobHandler h = [](ManagerInterface*, RequestBody,
+                           ResponseWriter&) { return ipmi::ccSuccess; };
 
-    EXPECT_EQ(ipmi::responseSuccess(std::vector<uint8_t>()),
-              processBlobCommand(h, &manager, request, MAX_IPMI_BUFFER));
+    validateReply(processBlobCommand(h, &manager, request, response), false);
 }
 
-TEST_F(ProcessBlobCommandTest, CommandReturnsOkWithInvalidPayloadLength)
+TEST(ProcessBlobCommandTest, CommandReturnsOkWithInvalidPayloadLength)
 {
     // There is a minimum payload length of 2 bytes (the CRC only, no data, for
     // read), this returns 1.
 
     StrictMock<ManagerMock> manager;
     std::vector<uint8_t> request(MAX_IPMI_BUFFER - 1);
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
 
-    IpmiBlobHandler h = [](ManagerInterface*, std::span<const uint8_t>) {
-        return ipmi::responseSuccess(std::vector<uint8_t>(1));
+    IpmiBlobHandler h = [](ManagerInterface*, RequestBody,
+                           ResponseWriter& reply) {
+        reply.reserve(1);
+        return ipmi::ccSuccess;
     };
 
-    EXPECT_EQ(ipmi::responseUnspecifiedError(),
-              processBlobCommand(h, &manager, request, MAX_IPMI_BUFFER));
+    auto result = processBlobCommand(h, &manager, request, response);
+    EXPECT_EQ(ipmi::ccUnspecifiedError, std::get<0>(result));
 }
 
-TEST_F(ProcessBlobCommandTest, CommandReturnsOkWithValidPayloadLength)
+TEST(ProcessBlobCommandTest, CommandReturnsOkWithValidPayloadLength)
 {
     // There is a minimum payload length of 3 bytes, this command returns a
     // payload of 3 bytes and the crc code is called to process the payload.
 
     StrictMock<ManagerMock> manager;
     std::vector<uint8_t> request(MAX_IPMI_BUFFER - 1);
-    uint32_t payloadLen = sizeof(uint16_t) + sizeof(uint8_t);
-
-    IpmiBlobHandler h =
-        [payloadLen](ManagerInterface*, std::span<const uint8_t>) {
-            std::vector<uint8_t> output(payloadLen, 0);
-            output[2] = 0x56;
-            return ipmi::responseSuccess(output);
-        };
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    constexpr uint32_t payloadLen = sizeof(uint16_t) + sizeof(uint8_t);
+
+    IpmiBlobHandler h = [](ManagerInterface*, RequestBody,
+                           ResponseWriter& reply) {
+        std::array<uint8_t, payloadLen> output = {0, 0, 0x56};
+        reply.append(output);
+        return ipmi::ccSuccess;
+    };
 
-    EXPECT_CALL(crcMock, generateCrc(_)).WillOnce(Return(0x3412));
+    uint16_t crc = generateCrc(std::vector<uint8_t>{0x56});
 
-    auto result = validateReply(
-        processBlobCommand(h, &manager, request, MAX_IPMI_BUFFER));
+    auto result =
+        validateReply(processBlobCommand(h, &manager, request, response));
 
     EXPECT_EQ(result.size(), payloadLen);
-    EXPECT_THAT(result, ElementsAre(0x12, 0x34, 0x56));
+    EXPECT_THAT(result, ElementsAre(crc & 0xff, crc >> 8, 0x56));
 }
 
-TEST_F(ProcessBlobCommandTest,
-       CommandReturnsErrorWithReplyExceededMaxTransferSize)
+TEST(ProcessBlobCommandTest, ReplyCrcIsDroppedWhenTheRequestHasNone)
+{
+    StrictMock<ManagerMock> manager;
+    std::vector<uint8_t> request(MAX_IPMI_BUFFER - 1);
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+
+    IpmiBlobHandler h = [](ManagerInterface*, RequestBody,
+                           ResponseWriter& reply) {
+        std::array<uint8_t, 3> output = {0, 0, 0x56};
+        reply.append(output);
+        return ipmi::ccSuccess;
+    };
+
+    auto result = validateReply(processBlobCommand(
+        h, &manager, RequestBody(request, false), response));
+    EXPECT_THAT(result, ElementsAre(0x56));
+}
+
+TEST(ProcessBlobCommandTest, ReplyIsBuiltInPlace)
+{
+    // The reply handed back to ipmid is a view of the response buffer, not a
+    // copy of it.
+
+    StrictMock<ManagerMock> manager;
+    std::vector<uint8_t> request(MAX_IPMI_BUFFER - 1);
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+
+    IpmiBlobHandler h = [](ManagerInterface*, RequestBody,
+                           ResponseWriter& reply) {
+        reply.reserve(sizeof(uint16_t) + 1);
+        return ipmi::ccSuccess;
+    };
+
+    auto result = processBlobCommand(h, &manager, request, response);
+    ASSERT_TRUE(std::get<1>(result).has_value());
+    EXPECT_EQ(response.data(), std::get<0>(*std::get<1>(result)).data());
+}
+
+TEST(ProcessBlobCommandTest,
+     CommandReturnsErrorWithReplyExceededMaxTransferSize)
 {
     // There is a minimum payload length of 3 bytes, this command returns a
     // payload of 3 bytes and the crc code is called to process the payload.
 
     StrictMock<ManagerMock> manager;
     std::vector<uint8_t> request(MAX_IPMI_BUFFER - 1);
-    uint32_t payloadLen = sizeof(uint16_t) + sizeof(uint8_t);
+    std::vector<uint8_t> response;
+    constexpr uint32_t payloadLen = sizeof(uint16_t) + sizeof(uint8_t);
+
+    IpmiBlobHandler h = [](ManagerInterface*, RequestBody,
+                           ResponseWriter& reply) {
+        std::array<uint8_t, payloadLen> output = {0, 0, 0x56};
+        reply.append(output);
+        return ipmi::ccSuccess;
+    };
 
-    IpmiBlobHandler h =
-        [payloadLen](ManagerInterface*, std::span<const uint8_t>) {
-            std::vector<uint8_t> output(payloadLen, 0);
-            output[2] = 0x56;
-            return ipmi::responseSuccess(output);
-        };
+    auto result = processBlobCommand(h, &manager, request, response);
+    EXPECT_EQ(ipmi::ccResponseError, std::get<0>(result));
+}
 
-    EXPECT_EQ(ipmi::responseResponseError(),
-              processBlobCommand(h, &manager, request, 0));
+namespace
+{
+
+/* A handler whose session stat always succeeds.  It is registered with the
+ * process-wide manager, which outlives any mock, so it counts its own calls.
+ */
+class StatBlob : public GenericBlobInterface
+{
+  public:
+    explicit StatBlob(const std::string& path) : path(path) {}
+
+    bool canHandleBlob(const std::string& blobId) override
+    {
+        return blobId == path;
+    }
+    std::vector<std::string> getBlobIds() override
+    {
+        return {path};
+    }
+    bool deleteBlob(const std::string&) override
+    {
+        return false;
+    }
+    bool stat(const std::string&, BlobMeta*) override
+    {
+        return false;
+    }
+    bool open(uint16_t, uint16_t, const std::string&) override
+    {
+        return true;
+    }
+    std::vector<uint8_t> read(uint16_t, uint32_t, uint32_t) override
+    {
+        return {};
+    }
+    bool write(uint16_t, uint32_t, const std::vector<uint8_t>&) override
+    {
+        return false;
+    }
+    bool writeMeta(uint16_t, uint32_t, const std::vector<uint8_t>&) override
+    {
+        return false;
+    }
+    bool commit(uint16_t, const std::vector<uint8_t>&) override
+    {
+        return false;
+    }
+    bool close(uint16_t) override
+    {
+        return true;
+    }
+    bool stat(uint16_t, BlobMeta*) override
+    {
+        ++stats;
+        return true;
+    }
+    bool expire(uint16_t) override
+    {
+        return true;
+    }
+
+    size_t stats = 0;
+
+  private:
+    std::string path;
+};
+
+/* Open path through handleBlobCommand on channel, as the host would, and
+ * return the session.
+ */
+uint16_t openThroughRouter(uint8_t channel, uint16_t flags,
+                           const std::string& path)
+{
+    BmcBlobOpenTx req;
+    req.crc = 0;
+    req.flags = flags;
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    request.insert(request.end(), path.begin(), path.end());
+    request.push_back('\0');
+    stampCrc(request);
+
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    auto reply = validateReply(handleBlobCommand(
+        channel, true, static_cast<uint8_t>(BlobOEMCommands::bmcBlobOpen),
+        request, response));
+    BmcBlobOpenRx resp{};
+    EXPECT_EQ(sizeof(resp), reply.size());
+    std::memcpy(&resp, reply.data(), std::min(sizeof(resp), reply.size()));
+    return resp.sessionId;
+}
+
+} // namespace
+
+TEST(HandleBlobCommandTest, NoCrcRequestRunsWithoutCrcOnItsChannel)
+{
+    // The request carries just the session id, and the reply leaves out its
+    // crc too.
+    std::string path = "/process/nocrc";
+    auto blob = std::make_unique<StatBlob>(path);
+    StatBlob* blobPtr = blob.get();
+    getBlobManager()->registerHandler(std::move(blob));
+    uint16_t session =
+        openThroughRouter(1, OpenFlags::write | OpenFlags::noCrc, path);
+
+    std::vector<uint8_t> request = {static_cast<uint8_t>(session),
+                                    static_cast<uint8_t>(session >> 8)};
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    auto cmd = static_cast<uint8_t>(BlobOEMCommands::bmcBlobSessionStat) |
+               noCrcCommand;
+
+    auto reply =
+        validateReply(handleBlobCommand(1, true, cmd, request, response));
+    EXPECT_EQ(1u, blobPtr->stats);
+    EXPECT_EQ(wireSize<BmcBlobStatRx> - sizeof(uint16_t), reply.size());
+}
+
+TEST(HandleBlobCommandTest, NoCrcOpenIsRefusedWithoutChannelIntegrity)
+{
+    std::string path = "/process/nocrc/nointegrity";
+    getBlobManager()->registerHandler(std::make_unique<StatBlob>(path));
+
+    BmcBlobOpenTx req;
+    req.crc = 0;
+    req.flags = OpenFlags::write | OpenFlags::noCrc;
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    request.insert(request.end(), path.begin(), path.end());
+    request.push_back('\0');
+    stampCrc(request);
+
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    EXPECT_EQ(ipmi::ccInvalidFieldRequest,
+              std::get<0>(handleBlobCommand(
+                  1, false, static_cast<uint8_t>(BlobOEMCommands::bmcBlobOpen),
+                  request, response)));
+}
+
+TEST(HandleBlobCommandTest, NoCrcRequestIsRejectedFromAnotherChannel)
+{
+    // The session id isn't checked by a crc, so it only counts on the
+    // channel the session was opened on.
+    std::string path = "/process/nocrc/otherchannel";
+    auto blob = std::make_unique<StatBlob>(path);
+    StatBlob* blobPtr = blob.get();
+    getBlobManager()->registerHandler(std::move(blob));
+    uint16_t session =
+        openThroughRouter(1, OpenFlags::write | OpenFlags::noCrc, path);
+
+    std::vector<uint8_t> request = {static_cast<uint8_t>(session),
+                                    static_cast<uint8_t>(session >> 8)};
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    auto cmd = static_cast<uint8_t>(BlobOEMCommands::bmcBlobSessionStat) |
+               noCrcCommand;
+
+    EXPECT_EQ(ipmi::ccUnspecifiedError,
+              std::get<0>(handleBlobCommand(2, true, cmd, request, response)));
+    EXPECT_EQ(0u, blobPtr->stats);
+}
+
+TEST(HandleBlobCommandTest, NoCrcRequestIsRejectedOnACheckedSession)
+{
+    std::string path = "/process/nocrc/checked";
+    auto blob = std::make_unique<StatBlob>(path);
+    StatBlob* blobPtr = blob.get();
+    getBlobManager()->registerHandler(std::move(blob));
+    uint16_t session = openThroughRouter(1, OpenFlags::write, path);
+
+    std::vector<uint8_t> request = {static_cast<uint8_t>(session),
+                                    static_cast<uint8_t>(session >> 8)};
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    auto cmd = static_cast<uint8_t>(BlobOEMCommands::bmcBlobSessionStat) |
+               noCrcCommand;
+
+    EXPECT_EQ(ipmi::ccUnspecifiedError,
+              std::get<0>(handleBlobCommand(1, true, cmd, request, response)));
+    EXPECT_EQ(0u, blobPtr->stats);
+}
+
+TEST(HandleBlobCommandTest, NoCrcSessionOpenedInABatchIsBound)
+{
+    // A batch's entries are run without a channel, but a session one of them
+    // opens is still bound to the channel the batch arrived on.
+    std::string path = "/process/nocrc/batch";
+    auto blob = std::make_unique<StatBlob>(path);
+    StatBlob* blobPtr = blob.get();
+    getBlobManager()->registerHandler(std::move(blob));
+
+    // One open entry, whose body is the open request less its crc.
+    uint16_t flags = OpenFlags::write | OpenFlags::noCrc;
+    std::vector<uint8_t> batch = {0, 0, 1};
+    batch.push_back(static_cast<uint8_t>(BlobOEMCommands::bmcBlobOpen));
+    batch.push_back(static_cast<uint8_t>(sizeof(flags) + path.size() + 1));
+    batch.push_back(static_cast<uint8_t>(flags));
+    batch.push_back(static_cast<uint8_t>(flags >> 8));
+    batch.insert(batch.end(), path.begin(), path.end());
+    batch.push_back('\0');
+    stampCrc(batch);
+
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    auto reply = validateReply(handleBlobCommand(
+        3, true, static_cast<uint8_t>(BlobOEMCommands::bmcBlobBatch), batch,
+        response));
+    ASSERT_EQ(wireSize<BmcBlobBatchRx> + wireSize<BmcBlobOpenRx>,
+              reply.size());
+    uint16_t session = decode<BmcBlobOpenRx>(
+                           std::span(reply).subspan(wireSize<BmcBlobBatchRx>))
+                           .sessionId;
+
+    std::vector<uint8_t> request = {static_cast<uint8_t>(session),
+                                    static_cast<uint8_t>(session >> 8)};
+    auto cmd = static_cast<uint8_t>(BlobOEMCommands::bmcBlobSessionStat) |
+               noCrcCommand;
+    EXPECT_EQ(ipmi::ccUnspecifiedError,
+              std::get<0>(handleBlobCommand(1, true, cmd, request, response)));
+    validateReply(handleBlobCommand(3, true, cmd, request, response));
+    EXPECT_EQ(1u, blobPtr->stats);
+}
+
+TEST(HandleBlobCommandTest, NoCrcSessionStillTakesCheckedRequests)
+{
+    // A request that carries its crc is checked and answered as usual.
+    std::string path = "/process/nocrc/withcrc";
+    auto blob = std::make_unique<StatBlob>(path);
+    StatBlob* blobPtr = blob.get();
+    getBlobManager()->registerHandler(std::move(blob));
+    uint16_t session =
+        openThroughRouter(1, OpenFlags::write | OpenFlags::noCrc, path);
+
+    BmcBlobSessionStatTx req;
+    req.crc = 0;
+    req.sessionId = session;
+    std::vector<uint8_t> request(sizeof(req));
+    std::memcpy(request.data(), &req, sizeof(req));
+    std::vector<uint8_t> response(MAX_IPMI_BUFFER);
+    auto cmd = static_cast<uint8_t>(BlobOEMCommands::bmcBlobSessionStat);
+
+    EXPECT_EQ(ipmi::ccUnspecifiedError,
+              std::get<0>(handleBlobCommand(1, true, cmd, request, response)));
+    EXPECT_EQ(0u, blobPtr->stats);
+
+    stampCrc(request);
+    auto reply =
+        validateReply(handleBlobCommand(1, true, cmd, request, response));
+    EXPECT_EQ(1u, blobPtr->stats);
+    EXPECT_EQ(wireSize<BmcBlobStatRx>, reply.size());
 }
 } // namespace blobs
@@ -0,0 +1,272 @@
+#include "crc.hpp"
+#include "ipmi.hpp"
+#include "manager.hpp"
+#include "process.hpp"
+#include "response.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// Count every heap allocation made by this test binary, so a test can tell
+// how many a single command costs.  The replacements are kept out of line so
+// the compiler doesn't pair an inlined free() with a new expression.
+static size_t allocations = 0;
+
+__attribute__((noinline)) void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr,
+                                                std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace blobs
+{
+
+namespace
+{
+
+// ipmid.hpp isn't installed where we can grab it and this value is per BMC
+// SoC.
+constexpr size_t maxIpmiBuffer = 64;
+
+/* A handler that owns a fixed buffer, and either takes the bytes straight
+ * from the request or relies on the default vector copy.
+ */
+class StorageBlob : public GenericBlobInterface
+{
+  public:
+    StorageBlob(const std::string& path, bool takeSpan) :
+        path(path), takeSpan(takeSpan)
+    {}
+
+    bool canHandleBlob(const std::string& blobId) override
+    {
+        return blobId == path;
+    }
+    std::vector<std::string> getBlobIds() override
+    {
+        return {path};
+    }
+    bool deleteBlob(const std::string&) override
+    {
+        return false;
+    }
+    bool stat(const std::string&, BlobMeta*) override
+    {
+        return false;
+    }
+    bool open(uint16_t, uint16_t, const std::string&) override
+    {
+        return true;
+    }
+    std::vector<uint8_t> read(uint16_t, uint32_t, uint32_t) override
+    {
+        return {};
+    }
+    bool write(uint16_t, uint32_t offset,
+               const std::vector<uint8_t>& data) override
+    {
+        return store(offset, data);
+    }
+    bool writeBytes(uint16_t session, uint32_t offset,
+                    std::span<const uint8_t> data) override
+    {
+        if (!takeSpan)
+        {
+            return GenericBlobInterface::writeBytes(session, offset, data);
+        }
+        taken = data.data();
+        return store(offset, data);
+    }
+    bool writeMeta(uint16_t, uint32_t offset,
+                   const std::vector<uint8_t>& data) override
+    {
+        return store(offset, data);
+    }
+    bool writeMetaBytes(uint16_t session, uint32_t offset,
+                        std::span<const uint8_t> data) override
+    {
+        if (!takeSpan)
+        {
+            return GenericBlobInterface::writeMetaBytes(session, offset, data);
+        }
+        return store(offset, data);
+    }
+    bool commit(uint16_t, const std::vector<uint8_t>&) override
+    {
+        return true;
+    }
+    bool close(uint16_t) override
+    {
+        return true;
+    }
+    bool stat(uint16_t, BlobMeta*) override
+    {
+        return false;
+    }
+    bool expire(uint16_t) override
+    {
+        return true;
+    }
+
+    std::array<uint8_t, maxIpmiBuffer> storage{};
+    /* Where the last write taken as a span was read from. */
+    const uint8_t* taken = nullptr;
+
+  private:
+    bool store(uint32_t offset, std::span<const uint8_t> data)
+    {
+        if (offset > storage.size() || data.size() > storage.size() - offset)
+        {
+            return false;
+        }
+        std::memcpy(&storage[offset], data.data(), data.size());
+        return true;
+    }
+
+    std::string path;
+    bool takeSpan;
+};
+
+/* Build a write request, as ipmid hands it to the OEM router, with a valid
+ * crc.
+ */
+template <typename Request>
+std::vector<uint8_t> buildWriteRequest(uint16_t session,
+                                       std::span<const uint8_t> bytes)
+{
+    std::vector<uint8_t> request(sizeof(Request));
+    Request req;
+    req.crc = 0;
+    req.sessionId = session;
+    req.offset = 0;
+    std::memcpy(request.data(), &req, sizeof(req));
+    request.insert(request.end(), bytes.begin(), bytes.end());
+    stampCrc(request);
+    return request;
+}
+
+/* The handlers are registered with the process-wide manager that the OEM
+ * router dispatches to, so each test gives its own a new path.
+ */
+struct Fixture
+{
+    Fixture(const std::string& path, bool takeSpan,
+            uint16_t flags = OpenFlags::write)
+    {
+        auto blob = std::make_unique<StorageBlob>(path, takeSpan);
+        handler = blob.get();
+        getBlobManager()->registerHandler(std::move(blob));
+        getBlobManager()->open(flags, path, &session);
+        getBlobManager()->bindNoCrcChannel(session, 0);
+    }
+
+    StorageBlob* handler = nullptr;
+    uint16_t session = 0;
+};
+
+/* Send a request through the OEM router's entry point, into the channel's
+ * reply buffer as ipmid would, and return the number of allocations it took.
+ */
+size_t countAllocations(BlobOEMCommands command,
+                        std::span<const uint8_t> request, bool withCrc = true)
+{
+    auto cmd = static_cast<uint8_t>(command);
+    if (!withCrc)
+    {
+        cmd |= noCrcCommand;
+    }
+
+    /* Size the channel's buffer and pick the crc kernel before counting. */
+    handleBlobCommand(0, true, cmd, request,
+                      getChannelResponseBuffer(0, maxIpmiBuffer));
+
+    size_t before = allocations;
+    auto [cc, reply] = handleBlobCommand(
+        0, true, cmd, request, getChannelResponseBuffer(0, maxIpmiBuffer));
+    EXPECT_EQ(ipmi::ccSuccess, cc);
+    return allocations - before;
+}
+
+} // namespace
+
+TEST(ZeroCopyWriteTest, WriteIntoHandlerStorageDoesNotAllocate)
+{
+    // The request bytes are carried as a view down to the handler, which
+    // copies them once into its own storage.
+    Fixture f("/zerocopy/write", true);
+    std::array<uint8_t, 4> bytes = {0x10, 0x20, 0x30, 0x40};
+    auto request = buildWriteRequest<BmcBlobWriteTx>(f.session, bytes);
+
+    EXPECT_EQ(0u, countAllocations(BlobOEMCommands::bmcBlobWrite, request));
+    EXPECT_EQ(0, std::memcmp(f.handler->storage.data(), bytes.data(),
+                             bytes.size()));
+}
+
+TEST(ZeroCopyWriteTest, WriteMetaIntoHandlerStorageDoesNotAllocate)
+{
+    Fixture f("/zerocopy/writemeta", true);
+    std::array<uint8_t, 3> bytes = {0x01, 0x02, 0x03};
+    auto request = buildWriteRequest<BmcBlobWriteMetaTx>(f.session, bytes);
+
+    EXPECT_EQ(0u,
+              countAllocations(BlobOEMCommands::bmcBlobWriteMeta, request));
+    EXPECT_EQ(0, std::memcmp(f.handler->storage.data(), bytes.data(),
+                             bytes.size()));
+}
+
+TEST(ZeroCopyWriteTest, WriteWithoutCrcDoesNotAllocate)
+{
+    // A request that leaves out its crc is decoded where it lies rather than
+    // copied behind one.
+    Fixture f("/zerocopy/nocrc", true, OpenFlags::write | OpenFlags::noCrc);
+    std::array<uint8_t, 4> bytes = {0x10, 0x20, 0x30, 0x40};
+    auto request = buildWriteRequest<BmcBlobWriteTx>(f.session, bytes);
+    std::span<const uint8_t> withoutCrc =
+        std::span<const uint8_t>(request).subspan(sizeof(uint16_t));
+
+    EXPECT_EQ(0u,
+              countAllocations(BlobOEMCommands::bmcBlobWrite, withoutCrc,
+                               false));
+    EXPECT_EQ(withoutCrc.data() + withoutCrc.size() - bytes.size(),
+              f.handler->taken);
+    EXPECT_EQ(0, std::memcmp(f.handler->storage.data(), bytes.data(),
+                             bytes.size()));
+}
+
+TEST(ZeroCopyWriteTest, VectorHandlerCopiesTheWriteOnce)
+{
+    // A handler that only implements the vector write gets exactly one copy,
+    // made by the default writeBytes.
+    Fixture f("/zerocopy/vector", false);
+    std::array<uint8_t, 4> bytes = {0x10, 0x20, 0x30, 0x40};
+    auto request = buildWriteRequest<BmcBlobWriteTx>(f.session, bytes);
+
+    EXPECT_EQ(1u, countAllocations(BlobOEMCommands::bmcBlobWrite, request));
+    EXPECT_EQ(0, std::memcmp(f.handler->storage.data(), bytes.data(),
+                             bytes.size()));
+}
+
+} // namespace blobs
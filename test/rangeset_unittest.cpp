@@ -0,0 +1,131 @@
+#include "rangeset.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+namespace
+{
+
+std::vector<std::pair<uint64_t, uint64_t>> allGaps(const RangeSet& set,
+                                                   uint64_t offset,
+                                                   uint64_t length)
+{
+    std::vector<std::pair<uint64_t, uint64_t>> result;
+    for (const ByteRange& gap : set.gaps(offset, length, 100))
+    {
+        result.emplace_back(gap.offset, gap.length);
+    }
+    return result;
+}
+
+using Gaps = std::vector<std::pair<uint64_t, uint64_t>>;
+
+} // namespace
+
+TEST(RangeSetTest, EmptySetIsOneGap)
+{
+    RangeSet set;
+    EXPECT_EQ(Gaps({{10, 90}}), allGaps(set, 10, 90));
+    EXPECT_EQ(Gaps(), allGaps(set, 10, 0));
+}
+
+TEST(RangeSetTest, SequentialWritesStayOneRange)
+{
+    RangeSet set;
+    for (uint32_t offset = 0; offset < 1000; offset += 10)
+    {
+        set.insert(offset, 10);
+    }
+    EXPECT_EQ(1, set.size());
+    EXPECT_EQ(Gaps(), allGaps(set, 0, 1000));
+    EXPECT_EQ(Gaps({{1000, 24}}), allGaps(set, 0, 1024));
+}
+
+TEST(RangeSetTest, GapsBetweenRangesAreListedInOrder)
+{
+    RangeSet set;
+    set.insert(40, 10);
+    set.insert(10, 10);
+    EXPECT_EQ(2, set.size());
+    EXPECT_EQ(Gaps({{0, 10}, {20, 20}, {50, 50}}), allGaps(set, 0, 100));
+    // Looking from inside a range or a gap clips to the span asked about.
+    EXPECT_EQ(Gaps({{20, 20}}), allGaps(set, 15, 30));
+    EXPECT_EQ(Gaps({{25, 15}}), allGaps(set, 25, 20));
+}
+
+TEST(RangeSetTest, OverlappingInsertMergesEverythingItTouches)
+{
+    RangeSet set;
+    set.insert(10, 10);
+    set.insert(30, 10);
+    set.insert(50, 10);
+    set.insert(15, 40);
+    EXPECT_EQ(1, set.size());
+    EXPECT_EQ(Gaps({{0, 10}, {60, 40}}), allGaps(set, 0, 100));
+}
+
+TEST(RangeSetTest, EmptyInsertIsIgnored)
+{
+    RangeSet set;
+    set.insert(10, 0);
+    EXPECT_EQ(0, set.size());
+}
+
+TEST(RangeSetTest, RangeMayEndAtTheTopOfTheOffsetSpace)
+{
+    RangeSet set;
+    set.insert(0xffffffffffffffef, 0x10);
+    EXPECT_EQ(Gaps({{0xffffffffffffffdf, 0x10}}),
+              allGaps(set, 0xffffffffffffffdf, 0x20));
+}
+
+TEST(RangeSetTest, GapsReachPast4GiB)
+{
+    RangeSet set;
+    set.insert(0xfffffff0, 0x20);
+    EXPECT_EQ(Gaps({{0xffffff00, 0xf0}, {0x100000010, 0x100000000}}),
+              allGaps(set, 0xffffff00, 0x100000110));
+}
+
+TEST(RangeSetTest, GapsStopAtMaxRanges)
+{
+    RangeSet set;
+    set.insert(10, 10);
+    set.insert(30, 10);
+    auto gaps = set.gaps(0, 100, 2);
+    ASSERT_EQ(2, gaps.size());
+    EXPECT_EQ(20, gaps[1].offset);
+}
+
+TEST(RangeSetTest, MergesOnlyWhenTouchingARange)
+{
+    RangeSet set;
+    EXPECT_FALSE(set.merges(0, 10));
+    EXPECT_TRUE(set.merges(0, 0));
+
+    set.insert(10, 10);
+    EXPECT_TRUE(set.merges(0, 10));
+    EXPECT_TRUE(set.merges(20, 5));
+    EXPECT_TRUE(set.merges(15, 1));
+    EXPECT_FALSE(set.merges(0, 9));
+    EXPECT_FALSE(set.merges(21, 5));
+}
+
+TEST(RangeSetTest, ClearEmptiesTheSet)
+{
+    RangeSet set;
+    set.insert(10, 10);
+    set.insert(30, 10);
+    set.clear();
+    EXPECT_EQ(0, set.size());
+    EXPECT_EQ(Gaps({{0, 100}}), allGaps(set, 0, 100));
+
+    set.insert(50, 10);
+    EXPECT_EQ(1, set.size());
+}
+} // namespace blobs
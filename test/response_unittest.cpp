@@ -0,0 +1,87 @@
+#include "ipmi.hpp"
+#include "response.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::ElementsAre;
+
+TEST(ResponseWriterTest, PutEncodesLittleEndian)
+{
+    std::array<uint8_t, 8> buffer{};
+    ResponseWriter reply(buffer);
+
+    struct BmcBlobCountRx rep;
+    rep.crc = 0;
+    rep.blobCount = 0x01020304;
+
+    EXPECT_TRUE(reply.put(rep));
+    EXPECT_FALSE(reply.overflowed());
+    EXPECT_EQ(sizeof(rep), reply.size());
+    EXPECT_EQ(buffer.size() - sizeof(rep), reply.remaining());
+    EXPECT_THAT(reply.data(), ElementsAre(0, 0, 0x04, 0x03, 0x02, 0x01));
+}
+
+TEST(ResponseWriterTest, AppendPastTheEndIsDroppedAndMarksOverflow)
+{
+    std::array<uint8_t, 4> buffer{};
+    ResponseWriter reply(buffer);
+    std::vector<uint8_t> bytes = {1, 2, 3};
+
+    EXPECT_TRUE(reply.append(bytes));
+    EXPECT_FALSE(reply.append(bytes));
+    EXPECT_TRUE(reply.overflowed());
+
+    // The write that didn't fit left the reply untouched.
+    EXPECT_THAT(reply.data(), ElementsAre(1, 2, 3));
+}
+
+TEST(ResponseWriterTest, ReserveClaimsBytesInPlace)
+{
+    std::array<uint8_t, 4> buffer{};
+    ResponseWriter reply(buffer);
+
+    auto out = reply.reserve(2);
+    ASSERT_EQ(2, out.size());
+    EXPECT_EQ(buffer.data(), out.data());
+    out[1] = 0x56;
+
+    EXPECT_TRUE(reply.reserve(3).empty());
+    EXPECT_TRUE(reply.overflowed());
+    EXPECT_THAT(reply.data(), ElementsAre(0, 0x56));
+}
+
+TEST(ChannelResponseBufferTest, BufferIsReusedAcrossCommands)
+{
+    // The same channel gets the same storage back, so a steady stream of
+    // commands doesn't allocate.
+    auto first = getChannelResponseBuffer(1, 64);
+    auto second = getChannelResponseBuffer(1, 64);
+
+    EXPECT_EQ(64, first.size());
+    EXPECT_EQ(first.data(), second.data());
+}
+
+TEST(ChannelResponseBufferTest, ChannelsHaveSeparateBuffers)
+{
+    auto first = getChannelResponseBuffer(2, 64);
+    auto second = getChannelResponseBuffer(3, 64);
+
+    EXPECT_NE(first.data(), second.data());
+}
+
+TEST(ChannelResponseBufferTest, BufferIsSizedToTheRequest)
+{
+    EXPECT_EQ(32, getChannelResponseBuffer(4, 32).size());
+    EXPECT_EQ(128, getChannelResponseBuffer(4, 128).size());
+    EXPECT_EQ(32, getChannelResponseBuffer(4, 32).size());
+}
+
+} // namespace blobs
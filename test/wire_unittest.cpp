@@ -0,0 +1,103 @@
+#include "ipmi.hpp"
+#include "wire.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+using ::testing::ElementsAre;
+
+static_assert(wireSize<BmcBlobReadTx> == sizeof(BmcBlobReadTx));
+static_assert(wireSize<BmcBlobStatRx> == sizeof(BmcBlobStatRx));
+static_assert(minimumRequestLength<BmcBlobOpenTx> ==
+              sizeof(BmcBlobOpenTx) + 2);
+static_assert(minimumRequestLength<BmcBlobWriteTx> ==
+              sizeof(BmcBlobWriteTx) + 1);
+static_assert(minimumRequestLength<BmcBlobCommitTx> ==
+              sizeof(BmcBlobCommitTx));
+
+TEST(WireCodecTest, DecodeIsLittleEndian)
+{
+    std::vector<uint8_t> data = {0x34, 0x12, 0x54, 0x00, 0x00, 0x01,
+                                 0x00, 0x00, 0x10, 0x20, 0x00, 0x00};
+
+    auto req = decode<BmcBlobReadTx>(data);
+    EXPECT_EQ(0x1234, req.crc);
+    EXPECT_EQ(0x54, req.sessionId);
+    EXPECT_EQ(0x100u, req.offset);
+    EXPECT_EQ(0x2010u, req.requestedSize);
+}
+
+TEST(WireCodecTest, EncodeIsLittleEndian)
+{
+    BmcBlobStatRx reply;
+    reply.crc = 0;
+    reply.blobState = 0x0102;
+    reply.size = 0x03040506;
+    reply.metadataLen = 7;
+
+    std::vector<uint8_t> out(wireSize<BmcBlobStatRx>);
+    encode(reply, out);
+    EXPECT_THAT(out, ElementsAre(0x00, 0x00, 0x02, 0x01, 0x06, 0x05, 0x04,
+                                 0x03, 0x07));
+}
+
+TEST(WireCodecTest, RequestShorterThanMinimumIsRejected)
+{
+    std::vector<uint8_t> data(sizeof(BmcBlobReadTx) - 1);
+
+    EXPECT_FALSE(decodeRequest<BmcBlobReadTx>(data));
+}
+
+TEST(WireCodecTest, PayloadTrailerFollowsFixedFields)
+{
+    std::vector<uint8_t> data = {0x00, 0x00, 0x54, 0x00, 0x00,
+                                 0x00, 0x00, 0x00, 0x66, 0x67};
+
+    auto req = decodeRequest<BmcBlobWriteTx>(data);
+    ASSERT_TRUE(req);
+    EXPECT_EQ(0x54, req->header.sessionId);
+    EXPECT_THAT(req->trailer, ElementsAre(0x66, 0x67));
+}
+
+TEST(WireCodecTest, StringTrailerRequiresNulTerminator)
+{
+    std::vector<uint8_t> data = {0x00, 0x00, 'a', 'b'};
+
+    EXPECT_FALSE(decodeRequest<BmcBlobStatTx>(data));
+
+    data.push_back('\0');
+    auto req = decodeRequest<BmcBlobStatTx>(data);
+    ASSERT_TRUE(req);
+    EXPECT_EQ("ab", req->blobId());
+}
+
+TEST(WireCodecTest, BodyWithoutCrcStartsAtTheNextField)
+{
+    std::vector<uint8_t> data = {0x54, 0x00, 0x00, 0x00,
+                                 0x00, 0x00, 0x66, 0x67};
+
+    auto req = decodeRequest<BmcBlobWriteTx>(RequestBody(data, false));
+    ASSERT_TRUE(req);
+    EXPECT_EQ(0, req->header.crc);
+    EXPECT_EQ(0x54, req->header.sessionId);
+    EXPECT_THAT(req->trailer, ElementsAre(0x66, 0x67));
+}
+
+TEST(WireCodecTest, BodyWithoutCrcIsMeasuredAsIfItHadOne)
+{
+    std::vector<uint8_t> data(sizeof(BmcBlobReadTx) - sizeof(uint16_t));
+
+    EXPECT_TRUE(decodeRequest<BmcBlobReadTx>(RequestBody(data, false)));
+
+    data.pop_back();
+    EXPECT_FALSE(decodeRequest<BmcBlobReadTx>(RequestBody(data, false)));
+}
+
+} // namespace blobs
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <blobs-ipmid/blobs.hpp>
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace blobs
+{
+
+/* What may follow the fixed fields of a request. */
+enum class Trailer
+{
+    none,         /* Nothing is required after the fixed fields. */
+    string,       /* A nul-terminated blob id of at least one character. */
+    data,         /* At least one byte of payload. */
+    optionalData, /* Zero or more bytes of payload. */
+};
+
+/**
+ * A packed struct that lists its members, in wire order, as a tuple of member
+ * pointers named fields.  The codec walks that list, so the struct
+ * declaration is the only place a layout is spelled out.
+ */
+template <typename T>
+concept WireStruct =
+    requires { std::tuple_size<std::remove_cv_t<decltype(T::fields)>>::value; };
+
+/**
+ * A request layout additionally names its command and trailer.
+ */
+template <typename T>
+concept WireRequest = WireStruct<T> && requires {
+    { T::command } -> std::convertible_to<BlobOEMCommands>;
+    { T::trailer } -> std::convertible_to<Trailer>;
+};
+
+namespace internal
+{
+
+template <typename T, typename Field>
+using FieldType = std::remove_cvref_t<decltype(std::declval<T&>().*
+                                               std::declval<Field>())>;
+
+template <std::integral I>
+constexpr I toLittleEndian(I value)
+{
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        return std::byteswap(value);
+    }
+    return value;
+}
+
+template <std::integral I>
+I loadLittleEndian(const uint8_t* p)
+{
+    I value;
+    std::memcpy(&value, p, sizeof(value));
+    return toLittleEndian(value);
+}
+
+template <std::integral I>
+void storeLittleEndian(uint8_t* p, I value)
+{
+    value = toLittleEndian(value);
+    std::memcpy(p, &value, sizeof(value));
+}
+
+/* Load the given fields of value, in order, starting at p. */
+template <typename T, typename... Fields>
+void loadFields(T& value, const uint8_t* p, Fields... field)
+{
+    ((value.*field = loadLittleEndian<FieldType<T, Fields>>(p),
+      p += sizeof(FieldType<T, Fields>)),
+     ...);
+}
+
+constexpr size_t trailerMinimum(Trailer trailer)
+{
+    switch (trailer)
+    {
+        case Trailer::string:
+            /* The smallest string is one letter and the nul-terminator. */
+            return 2;
+        case Trailer::data:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+} // namespace internal
+
+/* Number of bytes the fixed fields of T occupy on the wire. */
+template <WireStruct T>
+constexpr size_t wireSize = std::apply(
+    [](auto... field) {
+        return (sizeof(internal::FieldType<T, decltype(field)>) + ... + 0);
+    },
+    T::fields);
+
+/* Shortest request body, including the trailer, that can be decoded as T. */
+template <WireRequest T>
+constexpr size_t minimumRequestLength =
+    wireSize<T> + internal::trailerMinimum(T::trailer);
+
+/**
+ * Decode the fixed fields of T from the front of data.
+ *
+ * @param[in] data - at least wireSize<T> bytes.
+ * @return the decoded struct.
+ */
+template <WireStruct T>
+T decode(std::span<const uint8_t> data)
+{
+    static_assert(wireSize<T> == sizeof(T), "fields must cover the struct");
+
+    T value{};
+    std::apply(
+        [&](auto... field) {
+            internal::loadFields(value, data.data(), field...);
+        },
+        T::fields);
+    return value;
+}
+
+/**
+ * Encode the fixed fields of T to the front of out.
+ *
+ * @param[in] value - the struct to encode.
+ * @param[out] out - at least wireSize<T> bytes.
+ */
+template <WireStruct T>
+void encode(const T& value, std::span<uint8_t> out)
+{
+    static_assert(wireSize<T> == sizeof(T), "fields must cover the struct");
+
+    uint8_t* p = out.data();
+    std::apply(
+        [&](auto... field) {
+            ((internal::storeLittleEndian(p, value.*field),
+              p += sizeof(internal::FieldType<T, decltype(field)>)),
+             ...);
+        },
+        T::fields);
+}
+
+/* A request split into its fixed fields and whatever follows them. */
+template <WireRequest T>
+struct Request
+{
+    T header;
+    /* For string trailers, the blob id without its nul-terminator. */
+    std::span<const uint8_t> trailer;
+
+    std::string blobId() const
+    {
+        return std::string(trailer.begin(), trailer.end());
+    }
+};
+
+/**
+ * The body of a request, everything after its command byte.  A request sent
+ * with noCrcCommand leaves out its crc, so its fields start two bytes
+ * earlier.  channelIntegrity is whether the channel it arrived on already
+ * guarantees its bytes, which only then may open a NO_CRC session.
+ */
+struct RequestBody
+{
+    template <typename Bytes>
+        requires std::convertible_to<Bytes&&, std::span<const uint8_t>>
+    RequestBody(Bytes&& bytes, bool withCrc = true,
+                bool channelIntegrity = false) :
+        bytes(std::forward<Bytes>(bytes)), withCrc(withCrc),
+        channelIntegrity(channelIntegrity)
+    {}
+
+    /* The length the body has, or would have, with its crc. */
+    size_t length() const
+    {
+        return bytes.size() + (withCrc ? 0 : sizeof(uint16_t));
+    }
+
+    std::span<const uint8_t> bytes;
+    bool withCrc;
+    bool channelIntegrity;
+};
+
+/**
+ * Decode a request body laid out as T, checking the minimum length and, for
+ * string trailers, the nul-terminator.  A body without its crc decodes with
+ * a crc of zero.
+ *
+ * @param[in] data - the request body.
+ * @return the request, or nullopt if the body is malformed.
+ */
+template <WireRequest T>
+std::optional<Request<T>> decodeRequest(RequestBody data)
+{
+    static_assert(std::get<0>(T::fields) == &T::crc,
+                  "requests lead with their crc");
+
+    if (data.length() < minimumRequestLength<T>)
+    {
+        return std::nullopt;
+    }
+
+    Request<T> request{};
+    size_t fixedLength = wireSize<T>;
+    if (data.withCrc)
+    {
+        request.header = decode<T>(data.bytes);
+    }
+    else
+    {
+        std::apply(
+            [&](auto, auto... field) {
+                internal::loadFields(request.header, data.bytes.data(),
+                                     field...);
+            },
+            T::fields);
+        fixedLength -= sizeof(uint16_t);
+    }
+
+    request.trailer = data.bytes.subspan(fixedLength);
+    if constexpr (T::trailer == Trailer::string)
+    {
+        if (request.trailer.back() != '\0')
+        {
+            return std::nullopt;
+        }
+        request.trailer = request.trailer.first(request.trailer.size() - 1);
+    }
+    return request;
+}
+
+} // namespace blobs